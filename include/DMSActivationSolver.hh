@@ -0,0 +1,139 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSActivationSolver.hh
+/// \brief Definition of the DMSActivationSolver class
+
+#ifndef DMSActivationSolver_h
+#define DMSActivationSolver_h 1
+
+#include "globals.hh"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+class DMSNuclideInventory;
+class DMSActivationSolverMessenger;
+class G4ParticleDefinition;
+class G4RadioactiveDecay;
+
+/// Post-run decay solver for the activation of the dump layers
+/// (/dms/activation/ commands).
+///
+/// The production rates per layer come from the merged DMSNuclideInventory
+/// and the beam power set with /dms/activation/beamPower. The decay network
+/// of all produced nuclides and their descendants is taken from the Geant4
+/// radioactive decay data: nuclides with a mean life below 1 us decay
+/// promptly into their daughters, stable nuclides end the chains.
+///
+/// Ordered by decreasing mass, the decay matrix is lower triangular and its
+/// exponential has the closed (Bateman) form V exp(-Lambda t) V^-1, with the
+/// unit triangular eigenvector matrix V built once for the whole network.
+/// For an irradiation of length T followed by a cooling time t the amount
+/// of nuclide i is
+///   N_i = sum_k V_ik c_k (1 - exp(-lambda_k T)) / lambda_k exp(-lambda_k t)
+/// with c = V^-1 R. Activity and decay power of a layer reduce to dot
+/// products over the modes k, evaluated for all times at once. Equal
+/// decay constants are separated by a relative 1e-6.
+///
+/// The decay power counts the full Q-value of every decay, including the
+/// neutrino share of beta decays, and is therefore an upper bound. The
+/// master writes:
+///  - <fileName>.csv          : activity, specific activity and decay power
+///                              per layer for every irradiation and cooling
+///                              time,
+///  - <fileName>_nuclides.csv : activity per nuclide, for the nuclides above
+///                              /dms/activation/minFraction of their layer.
+
+class DMSActivationSolver
+{
+  public:
+    DMSActivationSolver();
+    ~DMSActivationSolver();
+
+    void   SetActive(G4bool value) { fActive = value; }
+    G4bool IsActive() const        { return fActive; }
+    void SetBeamPower(G4double watts)          { fBeamPower = watts; }
+    void SetIrradiationTimes(const std::vector<G4double>& times)
+      { fIrradiationTimes = times; }
+    void SetCoolingTimes(const std::vector<G4double>& times)
+      { fCoolingTimes = times; }
+    // 0 and n times spaced logarithmically from first to last
+    void SetCoolingRange(G4double first, G4double last, G4int n);
+    void SetMinFraction(G4double value)        { fMinFraction = value; }
+    void SetFileName(const G4String& name)     { fFileName = name; }
+    const G4String& GetFileName() const        { return fFileName; }
+
+    // Solve the decay chains of the merged inventory and write the results;
+    // called on the master
+    void Solve(const DMSNuclideInventory& inventory);
+
+  private:
+    struct Node
+    {
+      const G4ParticleDefinition* definition;
+      G4double lambda;   // 1/s
+      G4double energy;   // MeV per decay, including prompt daughters
+      std::vector<std::pair<G4int, G4double> > daughters;   // node, yield
+    };
+
+    G4bool IsStable(const G4ParticleDefinition* definition) const;
+    G4int  AddNode(const G4ParticleDefinition* definition);
+    void   Resolve(const G4ParticleDefinition* definition, G4double weight,
+                   std::map<G4int, G4double>& yields, G4double& energy,
+                   G4int depth);
+    // Order the network and build the modes, returns old -> new index
+    std::vector<G4int> BuildModes();
+    // Activity [Bq] and decay power [W] after irradiation and cooling
+    void   Evaluate(const std::vector<G4double>& c, G4double irradiation,
+                    const std::vector<G4double>& cooling,
+                    std::vector<G4double>& activity,
+                    std::vector<G4double>& power) const;
+
+    DMSActivationSolverMessenger* fMessenger;
+    G4RadioactiveDecay* fDecay;
+    G4bool   fActive;
+    G4double fBeamPower;
+    std::vector<G4double> fIrradiationTimes;   // G4 units
+    std::vector<G4double> fCoolingTimes;       // G4 units
+    G4double fMinFraction;
+    G4String fFileName;
+
+    // Decay network, ordered by decreasing mass once built
+    std::vector<Node> fNodes;
+    std::map<const G4ParticleDefinition*, G4int> fNodeIndex;
+    // Modes: column k of V as (i, V_ik) for i >= k, activity and power
+    // weights sum_i lambda_i V_ik and sum_i lambda_i Q_i V_ik
+    std::vector<std::vector<std::pair<G4int, G4double> > > fColumns;
+    std::vector<G4double> fLambda;
+    std::vector<G4double> fActivityWeight;
+    std::vector<G4double> fPowerWeight;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
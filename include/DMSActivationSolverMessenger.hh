@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSActivationSolverMessenger.hh
+/// \brief Definition of the DMSActivationSolverMessenger class
+
+#ifndef DMSActivationSolverMessenger_h
+#define DMSActivationSolverMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class DMSActivationSolver;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+
+/// Messenger class that defines the /dms/activation/ commands of
+/// DMSActivationSolver. The solver runs on the master only, so the commands
+/// are not broadcast to the workers.
+
+class DMSActivationSolverMessenger : public G4UImessenger
+{
+  public:
+    DMSActivationSolverMessenger(DMSActivationSolver* solver);
+    virtual ~DMSActivationSolverMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    // "value ... unit" -> values in G4 units
+    G4bool ParseTimes(const G4String& list, std::vector<G4double>& times) const;
+
+    DMSActivationSolver* fSolver;
+
+    G4UIdirectory*       fActivationDirectory;
+    G4UIcmdWithABool*    fActiveCmd;
+    G4UIcmdWithADouble*  fBeamPowerCmd;
+    G4UIcmdWithAString*  fIrradiationCmd;
+    G4UIcmdWithAString*  fCoolingCmd;
+    G4UIcommand*         fCoolingRangeCmd;
+    G4UIcmdWithADouble*  fMinFractionCmd;
+    G4UIcmdWithAString*  fFileNameCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSArrowWriter.hh
+/// \brief Definition of the DMSArrowWriter class
+
+#ifndef DMSArrowWriter_h
+#define DMSArrowWriter_h 1
+
+#include "DMSOutputSchema.hh"
+#include "globals.hh"
+
+#include <memory>
+#include <vector>
+
+struct DMSOutputBatch;
+
+namespace arrow
+{
+  class DataType;
+  class Schema;
+  namespace io  { class FileOutputStream; }
+  namespace ipc { class RecordBatchWriter; }
+}
+
+/// Apache Arrow IPC file backend of DMSAsyncWriter
+/// (/dms/output/format arrow, requires building WITH_ARROW).
+///
+/// Each DMSOutputBatch, i.e. the events collected by one worker, becomes one
+/// record batch. The numeric columns are wrapped without conversion and the
+/// code columns are written as dictionary-encoded string columns under
+/// their name ("procID" -> "procName"), with the DMSNameDictionary table as
+/// dictionary. Since the table only grows during the run, later batches
+/// carry it as dictionary deltas.
+/// In the event layout the file has one row per event instead: an eventID
+/// column and one list column per secondary column, all lists sharing the
+/// offsets of the event index (CSR).
+/// The result is an Arrow IPC file (Feather V2), which readers can
+/// memory-map directly.
+
+class DMSArrowWriter
+{
+  public:
+    DMSArrowWriter(const G4String& fileName,
+                   const std::vector<DMSNtupleColumn>& columns,
+                   G4bool eventLayout = false);
+    ~DMSArrowWriter();
+
+    void Write(const DMSOutputBatch* batch);
+    void Close();
+
+  private:
+    std::vector<DMSNtupleColumn> fColumns;
+    std::vector<G4int> fCodeKinds;
+    G4bool fEventLayout;
+    std::vector<std::shared_ptr<arrow::DataType>> fValueTypes;
+    std::shared_ptr<arrow::Schema> fSchema;
+    std::shared_ptr<arrow::io::FileOutputStream> fFile;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> fWriter;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,140 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSAsyncWriter.hh
+/// \brief Definition of the DMSAsyncWriter class
+
+#ifndef DMSAsyncWriter_h
+#define DMSAsyncWriter_h 1
+
+#include "DMSBoundedQueue.hh"
+#include "DMSOutputSchema.hh"
+#include "globals.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+class DMSArrowWriter;
+
+/// Block of complete events in column-major layout, built by one worker
+/// and handed over to the writer thread.
+
+struct DMSOutputBatch
+{
+  G4int  threadId = 0;
+  size_t rows = 0;
+  size_t events = 0;
+  std::vector<std::vector<char>> columns;
+  // Event layout: ID and end row of each event in the batch
+  std::vector<int32_t> eventIDs;
+  std::vector<int32_t> eventEnds;
+
+  template <class T>
+  void Append(size_t column, T value)
+  {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    columns[column].insert(columns[column].end(), bytes, bytes + sizeof(T));
+  }
+};
+
+/// Writer of the "binary" and "arrow" output formats (/dms/output/format).
+///
+/// Workers push finished batches into a lock-free bounded queue and a
+/// dedicated writer thread compresses (zlib) and writes them, or passes them
+/// to DMSArrowWriter, so file I/O stays off the tracking threads. When the
+/// queue is full, Push() waits for the writer; the memory held by pending
+/// output is therefore capped at about queueDepth batches.
+///
+/// The writer is shared by all threads: the master opens it in
+/// BeginOfRunAction() and closes it in EndOfRunAction(), after the workers
+/// have pushed their last batch.
+///
+/// Binary file layout (host byte order):
+///   header : "DMSB", u32 version, u32 nColumns,
+///            nColumns x { u8 type ('I','F','D'), u16 length, name }
+///   blocks : u8 tag ('R' rows, 'E' events, 'D' dictionary), u32 threadId,
+///            u32 nRows, u64 rawSize, u64 storedSize, zlib payload
+/// A row block payload holds the columns one after the other, nRows values
+/// each. In the event layout each row block is followed by an event block
+/// indexing it: nRows i32 event IDs, then nRows + 1 i32 offsets (CSR) into
+/// the rows of the preceding row block. The dictionary block written at
+/// close holds { i32 kind, i32 code, u16 length, name } entries (see
+/// DMSNameDictionary).
+
+class DMSAsyncWriter
+{
+  public:
+    enum Format { kBinary, kArrow };
+
+    static DMSAsyncWriter* Instance();
+    // Whether the arrow format was compiled in
+    static G4bool HasArrow();
+
+    void Open(const G4String& fileName,
+              const std::vector<DMSNtupleColumn>& columns,
+              size_t queueDepth, Format format = kBinary,
+              G4bool eventLayout = false);
+    void Close();
+    G4bool IsOpen() const { return fOpen; }
+
+    // Producer side, called by the workers
+    DMSOutputBatch* NewBatch(size_t reservedRows) const;
+    void Push(DMSOutputBatch* batch);
+
+  private:
+    DMSAsyncWriter();
+    ~DMSAsyncWriter();
+
+    void Run();
+    void WriteBlock(char tag, G4int threadId, size_t rows,
+                    const std::vector<char>& raw);
+    void WriteBatch(const DMSOutputBatch* batch);
+    void WriteDictionary();
+
+    std::vector<DMSNtupleColumn> fColumns;
+    DMSBoundedQueue<DMSOutputBatch*>* fQueue;
+    DMSArrowWriter* fArrowWriter;
+    std::thread   fThread;
+    std::ofstream fFile;
+    std::vector<char> fCompressed;
+    std::atomic<G4bool> fStop;
+    G4bool fOpen;
+
+    // Statistics
+    std::atomic<size_t> fStalls;
+    size_t fBatches;
+    size_t fRows;
+    size_t fRawBytes;
+    size_t fStoredBytes;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
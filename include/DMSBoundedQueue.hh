@@ -0,0 +1,147 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSBoundedQueue.hh
+/// \brief Definition of the DMSBoundedQueue class template
+
+#ifndef DMSBoundedQueue_h
+#define DMSBoundedQueue_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/// Lock-free bounded queue (D. Vyukov's array based algorithm).
+///
+/// Any number of threads may push and pop concurrently; DMSAsyncWriter uses
+/// it with the worker threads as producers and its writer thread as the
+/// only consumer. TryPush() fails instead of blocking when the queue is
+/// full, which is how the producers see back-pressure.
+/// The capacity is rounded up to a power of two.
+
+template <class T>
+class DMSBoundedQueue
+{
+  public:
+    explicit DMSBoundedQueue(size_t capacity);
+    ~DMSBoundedQueue() {}
+
+    G4bool TryPush(const T& value);
+    G4bool TryPop(T& value);
+
+    size_t GetCapacity() const { return fMask + 1; }
+
+  private:
+    struct Cell
+    {
+      std::atomic<size_t> sequence;
+      T data;
+    };
+
+    DMSBoundedQueue(const DMSBoundedQueue&) = delete;
+    DMSBoundedQueue& operator=(const DMSBoundedQueue&) = delete;
+
+    std::unique_ptr<Cell[]> fCells;
+    size_t fMask;
+    // Separate cache lines for the producer and consumer positions
+    alignas(64) std::atomic<size_t> fEnqueuePos;
+    alignas(64) std::atomic<size_t> fDequeuePos;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <class T>
+DMSBoundedQueue<T>::DMSBoundedQueue(size_t capacity)
+: fCells(), fMask(0), fEnqueuePos(0), fDequeuePos(0)
+{
+  size_t size = 2;
+  while ( size < capacity ) size *= 2;
+  fCells.reset(new Cell[size]);
+  fMask = size - 1;
+  for ( size_t i = 0; i < size; ++i ) {
+    fCells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <class T>
+G4bool DMSBoundedQueue<T>::TryPush(const T& value)
+{
+  Cell* cell = 0;
+  size_t pos = fEnqueuePos.load(std::memory_order_relaxed);
+  for ( ;; ) {
+    cell = &fCells[pos & fMask];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+    if ( diff == 0 ) {
+      if ( fEnqueuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed) ) break;
+    }
+    else if ( diff < 0 ) {
+      return false;   // full
+    }
+    else {
+      pos = fEnqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+  cell->data = value;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <class T>
+G4bool DMSBoundedQueue<T>::TryPop(T& value)
+{
+  Cell* cell = 0;
+  size_t pos = fDequeuePos.load(std::memory_order_relaxed);
+  for ( ;; ) {
+    cell = &fCells[pos & fMask];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = intptr_t(sequence) - intptr_t(pos + 1);
+    if ( diff == 0 ) {
+      if ( fDequeuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed) ) break;
+    }
+    else if ( diff < 0 ) {
+      return false;   // empty
+    }
+    else {
+      pos = fDequeuePos.load(std::memory_order_relaxed);
+    }
+  }
+  value = cell->data;
+  cell->sequence.store(pos + fMask + 1, std::memory_order_release);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSCheckpoint.hh
+/// \brief Definition of the DMSCheckpoint class
+
+#ifndef DMSCheckpoint_h
+#define DMSCheckpoint_h 1
+
+#include "globals.hh"
+
+#include <string>
+
+class DMSRunAction;
+class DMSCheckpointMessenger;
+
+/// Checkpoint and restart of long runs (/dms/checkpoint/ commands).
+///
+/// /dms/checkpoint/beamOn N runs the N events as a sequence of runs of
+/// /dms/checkpoint/interval events. The master does not reset its
+/// accumulables between these runs, so the mesh, the nuclide inventory and
+/// the trigger counters cover all events, and the final outputs are
+/// written after the last run only. The ntuple and histogram files are
+/// written per run with the suffix _c<run>; completed files are never
+/// reopened and dms-merge sums them.
+///
+/// After every run the checkpoint file <fileName>.chk is replaced
+/// atomically. It holds the number of completed events, the state of the
+/// master random engine and the merged accumulables. The events are seeded
+/// from their event number (DMSEventSeeder), or from the master engine
+/// with /dms/random/perEvent false, so a run resumed with --resume or
+/// /dms/checkpoint/resume repeats the interrupted run with the same seeds
+/// and continues as the uninterrupted run would have.
+
+class DMSCheckpoint
+{
+  public:
+    DMSCheckpoint(DMSRunAction* runAction);
+    ~DMSCheckpoint();
+
+    void SetInterval(G4int events)         { fInterval = events; }
+    void SetFileName(const G4String& name) { fFileName = name; }
+    static void SetResume(G4bool value)    { fgResume = value; }
+
+    // Run nEvents in runs of the interval, starting from the checkpoint
+    // file when resuming; called on the master
+    void BeamOn(G4int nEvents);
+
+    // Completed events before the current run, added to the event IDs
+    static G4int GetEventOffset()  { return fgEventOffset; }
+    // Suffix of the output files of the current run, empty for plain runs
+    static G4String GetOutputSuffix();
+
+    // Whether the master keeps its accumulables from the previous run
+    G4bool IsContinuing() const { return fContinuing; }
+    // Whether the current run completes the events, i.e. the final
+    // outputs are written at its end
+    G4bool IsFinalRun() const   { return fFinalRun; }
+
+    // Load the accumulables read from the checkpoint file; called by the
+    // master at the begin of the first resumed run, after the reset
+    void RestoreScorers();
+
+  private:
+    // <fileName>.chk, with the shard suffix of a sharded job
+    G4String GetFileName() const;
+    G4bool Write(G4int nEvents, G4int completed, G4int chunk) const;
+    G4bool Read(G4int nEvents, G4int& completed, G4int& chunk);
+
+    DMSRunAction* fRunAction;
+    DMSCheckpointMessenger* fMessenger;
+    G4int    fInterval;
+    G4String fFileName;
+    G4bool   fContinuing;
+    G4bool   fFinalRun;
+    std::string fPendingScorers;
+
+    static G4bool fgResume;
+    static G4int  fgEventOffset;
+    static G4int  fgChunk;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,99 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSDesignScan.hh
+/// \brief Definition of the DMSDesignScan class
+
+#ifndef DMSDesignScan_h
+#define DMSDesignScan_h 1
+
+#include "globals.hh"
+
+#include <utility>
+#include <vector>
+
+class DMSRunAction;
+class DMSDesignScanMessenger;
+
+/// Scan of dump design variants in one job (/dms/scan/ commands).
+///
+/// Every variant is a macro of /dms/geometry/ commands applied to the
+/// layer stack in place when the scan starts. The variants are run one
+/// after the other with the same number of events on all threads, so the
+/// kernel, the physics tables and the HP data are initialized once for the
+/// whole scan; only the geometry and the tables of new materials are
+/// rebuilt. The output files of each variant get a _<variant> suffix.
+/// At the end the master prints and writes to DMSScan.csv, per variant,
+/// the events/s, the neutrons leaving the dump per primary and the power
+/// deposited per layer (for the beam power of /dms/mesh/beamPower; the
+/// energy mesh is activated if needed).
+///
+/// Settings other than the layers that a variant macro changes stay in
+/// effect for the following variants.
+
+class DMSDesignScan
+{
+  public:
+    DMSDesignScan(DMSRunAction* runAction);
+    ~DMSDesignScan();
+
+    void AddVariant(const G4String& name, const G4String& macro);
+    void ClearVariants() { fVariants.clear(); }
+    // Run all variants; called on the master
+    void Run(G4int nEvents);
+
+    // Suffix of the output files of the current variant
+    static const G4String& GetOutputSuffix() { return fgOutputSuffix; }
+
+  private:
+    struct Variant
+    {
+      G4String name;
+      G4String macro;
+    };
+
+    struct Result
+    {
+      G4String name;
+      G4double seconds;
+      G4double leakingNeutrons;
+      // Material and power [W] per layer
+      std::vector<std::pair<G4String, G4double> > layers;
+    };
+
+    Result Collect(const Variant& variant, G4double seconds) const;
+    void   Print(const std::vector<Result>& results, G4int nEvents) const;
+
+    DMSRunAction* fRunAction;
+    DMSDesignScanMessenger* fMessenger;
+    std::vector<Variant> fVariants;
+
+    static G4String fgOutputSuffix;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
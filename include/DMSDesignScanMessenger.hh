@@ -0,0 +1,65 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSDesignScanMessenger.hh
+/// \brief Definition of the DMSDesignScanMessenger class
+
+#ifndef DMSDesignScanMessenger_h
+#define DMSDesignScanMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class DMSDesignScan;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithAnInteger;
+
+/// Messenger class that defines the /dms/scan/ commands of DMSDesignScan.
+/// The scan is driven by the master, so the commands are not broadcast to
+/// the workers.
+
+class DMSDesignScanMessenger : public G4UImessenger
+{
+  public:
+    DMSDesignScanMessenger(DMSDesignScan* scan);
+    virtual ~DMSDesignScanMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    DMSDesignScan* fScan;
+
+    G4UIdirectory*           fScanDirectory;
+    G4UIcommand*             fAddVariantCmd;
+    G4UIcmdWithoutParameter* fClearVariantsCmd;
+    G4UIcmdWithAnInteger*    fRunCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
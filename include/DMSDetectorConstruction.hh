@@ -33,10 +33,39 @@
 #include "G4VUserDetectorConstruction.hh"
 #include "globals.hh"
 
+#include <map>
+#include <vector>
+
 class G4VPhysicalVolume;
 class G4LogicalVolume;
+class G4VisAttributes;
+class DMSDetectorMessenger;
+
+/// One layer of the dump: a box of material between zFront and zBack,
+/// less the box of the previous layer
+
+struct DMSLayer
+{
+  G4String material;
+  G4double halfX;
+  G4double halfY;
+  G4double zFront;
+  G4double zBack;
+};
 
 /// Detector construction class to define materials and geometry
+///
+/// The dump is a stack of nested layers (/dms/geometry/ commands), each a
+/// box that encloses the box of the previous layer, which is subtracted
+/// from it. The layers are named layer1, layer2, ... from the inside out.
+/// The default stack is the graphite core in copper, iron, copper, iron
+/// and concrete, with the front faces at z = 0.
+/// The layers are either boolean solids placed side by side in the World
+/// (the default) or plain boxes placed as nested daughters, each in the
+/// next layer; both give the same material map, see DMSNavigationBenchmark.
+/// Changing the stack between runs rebuilds the geometry at the next run,
+/// as /run/reinitializeGeometry does: the old volumes are deleted, the
+/// materials, and so the physics tables of their couples, are kept.
 
 class DMSDetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -46,10 +75,45 @@ class DMSDetectorConstruction : public G4VUserDetectorConstruction
 
     virtual G4VPhysicalVolume* Construct();
 
-  protected:
+    enum Mode { kBoolean = 0, kNested };
+    void SetMode(Mode mode);
+    Mode GetMode() const { return fMode; }
+    // Create the World and the layers in the given mode; Construct() and
+    // DMSNavigationBenchmark
+    G4VPhysicalVolume* BuildWorld(Mode mode, G4bool checkOverlaps) const;
+
+    // Layer stack, indices from 0
+    void ClearLayers();
+    void SetLayers(const std::vector<DMSLayer>& layers);
+    void AddLayer(const DMSLayer& layer);
+    G4bool SetLayer(size_t index, const DMSLayer& layer);
+    G4bool SetLayerMaterial(size_t index, const G4String& material);
+    const std::vector<DMSLayer>& GetLayers() const { return fLayers; }
+    void PrintLayers() const;
+
+    // Whether the material is known or can be built from the NIST database
+    static G4bool CheckMaterial(const G4String& name);
+
+    // Incremented at every construction, for caches keyed by volume
+    static G4int GetGeometryVersion() { return fgGeometryVersion; }
+    // Volume of a layer without the layers inside it, exact in both modes:
+    // the box less the inner box (boolean) or less its daughters (nested)
+    static G4double GetLayerVolume(const G4LogicalVolume* volume);
+
+  private:
+    void DefineMaterials();
+    void GeometryChanged();
+    G4bool CheckLayers() const;
+
+    DMSDetectorMessenger* fMessenger;
+    std::vector<DMSLayer> fLayers;
+    Mode fMode;
+    std::map<G4String, G4VisAttributes*> fVisAttributes;
+    G4VisAttributes* fDefaultVisAttributes;
+
+    static G4int fgGeometryVersion;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 #endif
-
@@ -0,0 +1,76 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSDetectorMessenger.hh
+/// \brief Definition of the DMSDetectorMessenger class
+
+#ifndef DMSDetectorMessenger_h
+#define DMSDetectorMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+#include <iosfwd>
+
+class DMSDetectorConstruction;
+struct DMSLayer;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+
+/// Messenger class that defines the /dms/geometry/ commands of
+/// DMSDetectorConstruction. The geometry is built by the master, so the
+/// commands are not broadcast to the workers.
+
+class DMSDetectorMessenger : public G4UImessenger
+{
+  public:
+    DMSDetectorMessenger(DMSDetectorConstruction* detector);
+    virtual ~DMSDetectorMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    G4UIcommand* NewLayerCommand(const char* name, G4bool withIndex);
+    G4bool ReadLayer(std::istream& stream, DMSLayer& layer) const;
+
+    DMSDetectorConstruction* fDetector;
+
+    G4UIdirectory*           fGeometryDirectory;
+    G4UIcmdWithoutParameter* fClearLayersCmd;
+    G4UIcommand*             fAddLayerCmd;
+    G4UIcommand*             fSetLayerCmd;
+    G4UIcommand*             fSetMaterialCmd;
+    G4UIcmdWithoutParameter* fPrintLayersCmd;
+    G4UIcmdWithAString*      fModeCmd;
+    G4UIcmdWithAnInteger*    fBenchmarkCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
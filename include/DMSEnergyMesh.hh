@@ -0,0 +1,174 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSEnergyMesh.hh
+/// \brief Definition of the DMSEnergyMesh class
+
+#ifndef DMSEnergyMesh_h
+#define DMSEnergyMesh_h 1
+
+#include "G4VAccumulable.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <cmath>
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
+
+class G4LogicalVolume;
+class DMSEnergyMeshMessenger;
+
+/// Voxel mesh of the energy deposited in the dump (/dms/mesh/ commands).
+///
+/// The mesh is either Cartesian (x, y, z bins) or cylindrical around the
+/// beam axis (r, phi, z bins). Every thread owns its own instance and fills
+/// a flat array indexed by voxel, so the stepping path takes no lock and
+/// threads never write to shared cache lines. As a G4VAccumulable the
+/// arrays are summed into the master instance at the end of the run, which
+/// then writes:
+///  - <fileName>.dmsm : power density per voxel [W/cm3] for the beam power
+///                      set with /dms/mesh/beamPower (layout below),
+///  - <fileName>_layers.csv and the printed summary: deposited power per
+///                      logical volume.
+/// The normalisation uses the deposited fraction of the primary energy, so
+/// it does not depend on the gun settings.
+///
+/// Binary layout (host byte order):
+///   "DMSM", u32 version, u8 type ('C' Cartesian, 'Y' cylindrical),
+///   3 x u32 bins, 3 x f64 lower edge, 3 x f64 upper edge ([cm], phi in
+///   rad), f64 beam power [W], f64 primary energy [MeV], u64 events,
+///   f32 power density, x (or r) fastest then y (or phi) then z.
+
+class DMSEnergyMesh : public G4VAccumulable
+{
+  public:
+    enum Type { kCartesian = 0, kCylindrical };
+
+    DMSEnergyMesh();
+    virtual ~DMSEnergyMesh();
+
+    // G4VAccumulable
+    virtual void Merge(const G4VAccumulable& other);
+    virtual void Reset();
+
+    void   SetActive(G4bool value) { fActive = value; }
+    G4bool IsActive() const        { return fActive; }
+    void SetType(Type type)        { fType = type; }
+    void SetBins(G4int n1, G4int n2, G4int n3);
+    void SetLower(const G4ThreeVector& lower) { fLower = lower; }
+    void SetUpper(const G4ThreeVector& upper) { fUpper = upper; }
+    void SetBeamPower(G4double watts)         { fBeamPower = watts; }
+    void SetFileName(const G4String& name)    { fFileName = name; }
+
+    inline void Fill(const G4ThreeVector& position, G4double edep,
+                     const G4LogicalVolume* volume);
+    void AddPrimaryEnergy(G4double energy) { fPrimaryEnergy += energy; }
+    void CountEvent() { ++fEvents; }
+
+    // Write the output files and the summary; called on the master
+    void Write() const;
+
+    // Access to the merged mesh, e.g. for DMSThermalSolver
+    Type     GetType() const              { return fType; }
+    G4int    GetBins(G4int axis) const    { return fBins[axis]; }
+    G4double GetMin(G4int axis) const     { return fMin[axis]; }
+    G4double GetMax(G4int axis) const     { return fMax[axis]; }
+    const std::vector<G4double>& GetEnergy() const { return fEdep; }
+    // The voxel sums, reduced over the MPI ranks by DMSMPIReducer
+    std::vector<G4double>& GetEnergy()             { return fEdep; }
+    const G4String& GetFileName() const   { return fFileName; }
+    G4double GetBeamPower() const         { return fBeamPower; }
+    // Deposited energy in the logical volume
+    G4double GetVolumeEnergy(const G4LogicalVolume* volume) const;
+    // Deposited energy -> power [W] for the selected beam power
+    G4double GetPowerFactor() const
+      { return fPrimaryEnergy > 0. ? fBeamPower / fPrimaryEnergy : 0.; }
+    // Write one value per voxel with the .dmsm header
+    void WriteField(const G4String& fileName, const std::vector<float>& values) const;
+
+    // Merged state for DMSCheckpoint and DMSShard; Load() adds the saved
+    // sums and needs the same mesh settings. Without the voxels only the
+    // sums per volume and the totals are saved, see DMSMPIReducer
+    void   Save(std::ostream& stream, G4bool withVoxels = true) const;
+    G4bool Load(std::istream& stream, G4bool withVoxels = true);
+
+  private:
+    inline G4int GetIndex(const G4ThreeVector& position) const;
+
+    DMSEnergyMeshMessenger* fMessenger;
+    G4bool        fActive;
+    Type          fType;
+    G4int         fBins[3];
+    G4ThreeVector fLower;
+    G4ThreeVector fUpper;
+    // Effective edges and inverse bin widths, set in Reset()
+    G4double      fMin[3];
+    G4double      fMax[3];
+    G4double      fInvWidth[3];
+    G4double      fBeamPower;
+    G4String      fFileName;
+
+    std::vector<G4double> fEdep;
+    std::unordered_map<const G4LogicalVolume*, G4double> fVolumeEdep;
+    G4double fOutsideEdep;
+    G4double fPrimaryEnergy;
+    G4long   fEvents;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4int DMSEnergyMesh::GetIndex(const G4ThreeVector& position) const
+{
+  G4double u = position.x();
+  G4double v = position.y();
+  if ( fType == kCylindrical ) {
+    u = std::sqrt(u * u + v * v);
+    v = std::atan2(position.y(), position.x());
+  }
+
+  G4int i = G4int(std::floor(( u - fMin[0] ) * fInvWidth[0]));
+  G4int j = G4int(std::floor(( v - fMin[1] ) * fInvWidth[1]));
+  G4int k = G4int(std::floor(( position.z() - fMin[2] ) * fInvWidth[2]));
+  if ( i < 0 || i >= fBins[0] || j < 0 || j >= fBins[1]
+       || k < 0 || k >= fBins[2] ) return -1;
+  return ( k * fBins[1] + j ) * fBins[0] + i;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void DMSEnergyMesh::Fill(const G4ThreeVector& position, G4double edep,
+                                const G4LogicalVolume* volume)
+{
+  G4int index = GetIndex(position);
+  if ( index >= 0 ) fEdep[index] += edep;
+  else              fOutsideEdep += edep;
+  fVolumeEdep[volume] += edep;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -31,12 +31,25 @@
 #define DMSEventAction_h 1
 
 #include "G4UserEventAction.hh"
+#include "DMSSecondaryBuffer.hh"
+#include "DMSNameDictionary.hh"
 #include "globals.hh"
 
+#include <unordered_map>
+
 class DMSRunAction;
+class G4Track;
+struct DMSOutputBatch;
 
 /// Event action class
 ///
+/// It owns the per-event buffer of recorded secondaries filled by
+/// DMSSteppingAction. In EndOfEventAction() the whole event is either
+/// written in one batch (ntuple rows or binary output batch, and/or
+/// histograms, as selected in DMSRunAction) or, if an event trigger is set
+/// and did not fire, dropped.
+/// In the event layout it also completes the trackID of the buffered
+/// secondaries when they are stacked (see DMSStackingAction).
 
 class DMSEventAction : public G4UserEventAction
 {
@@ -47,8 +60,28 @@ class DMSEventAction : public G4UserEventAction
     virtual void BeginOfEventAction(const G4Event* event);
     virtual void EndOfEventAction(const G4Event* event);
 
+    DMSSecondaryBuffer& GetBuffer() { return fBuffer; }
+    void   SetTriggered()       { fTriggered = true; }
+    G4bool IsTriggered() const  { return fTriggered; }
+
+    // Event layout: the trackID of a buffered secondary is assigned when
+    // it is stacked, after the step that created it
+    void AddPendingTrack(const G4Track* secondary, size_t row)
+      { fPendingTracks[secondary] = row; }
+    G4bool HasPendingTracks() const { return ! fPendingTracks.empty(); }
+    void AssignTrackID(const G4Track* track);
+
   private:
-    DMSRunAction* fRunAction;
+    void Flush();
+    void FillNtupleRow(size_t row, G4bool useCodes, G4bool eventLayout);
+    void FillBatchRow(DMSOutputBatch* batch, size_t row, G4bool eventLayout);
+
+    DMSRunAction*      fRunAction;
+    DMSSecondaryBuffer fBuffer;
+    DMSNameDictionary  fDictionary;
+    std::unordered_map<const G4Track*, size_t> fPendingTracks;
+    G4bool             fTriggered;
+    G4int              fGeometryVersion;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSEventSeeder.hh
+/// \brief Definition of the DMSEventSeeder class
+
+#ifndef DMSEventSeeder_h
+#define DMSEventSeeder_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+
+class DMSEventSeederMessenger;
+
+/// Per-event random seeds (/dms/random/ commands).
+///
+/// Every event gets its own random stream: DMSPrimaryGeneratorAction
+/// reseeds the engine of its thread from SplitMix64 of (run seed, event
+/// number) before anything is generated. The event number is the event ID
+/// plus /dms/random/firstEvent and the events completed in earlier runs of
+/// a /dms/checkpoint/beamOn, so an event is simulated the same way whatever
+/// the number of threads, the scheduling of the events or the splitting of
+/// the run. /dms/random/rerunEvent simulates a single event again in
+/// isolation.
+///
+/// The settings are shared by all threads; the commands are executed by
+/// the master between runs only.
+
+class DMSEventSeeder
+{
+  public:
+    DMSEventSeeder();
+    ~DMSEventSeeder();
+
+    static void   SetSeed(G4long seed)       { fgSeed = seed; }
+    static G4long GetSeed()                  { return fgSeed; }
+    static void   SetFirstEvent(G4int event) { fgFirstEvent = event; }
+    static G4int  GetFirstEvent()            { return fgFirstEvent; }
+    static void   SetActive(G4bool value)    { fgActive = value; }
+
+    // Number of the event in the whole job
+    static G4int GetEventNumber(G4int eventID);
+    // Seed the engine of the calling thread for the event
+    static void  SeedEvent(G4int eventID);
+
+    // Run the event with the given number alone; called on the master
+    void RerunEvent(G4int eventNumber);
+
+  private:
+    static inline uint64_t SplitMix64(uint64_t& state);
+
+    DMSEventSeederMessenger* fMessenger;
+
+    static G4long fgSeed;
+    static G4int  fgFirstEvent;
+    static G4bool fgActive;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline uint64_t DMSEventSeeder::SplitMix64(uint64_t& state)
+{
+  uint64_t z = ( state += 0x9E3779B97F4A7C15ULL );
+  z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+  return z ^ ( z >> 31 );
+}
+
+#endif
@@ -0,0 +1,104 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSHistoManager.hh
+/// \brief Definition of the DMSHistoManager class
+
+#ifndef DMSHistoManager_h
+#define DMSHistoManager_h 1
+
+#include "globals.hh"
+
+#include <unordered_map>
+
+class G4ParticleDefinition;
+class G4LogicalVolume;
+
+/// Spectra of the recorded secondaries, filled instead of (or in addition
+/// to) the DMSDumpSim ntuple when /dms/record/mode is "histograms" or "both".
+///
+/// The histograms are booked with G4AnalysisManager in every thread and
+/// merged on the master when the file is written; they are inactive unless
+/// the histogram mode is selected. Binning can be changed with the
+/// /analysis/h1/set and /analysis/h2/set commands.
+///
+///  H1 neutronE      : log10 binned neutron kinetic energy [MeV]
+///  H2 kinE_volume   : kinetic energy [MeV] x production volume index
+///  H2 cosTheta_kinE : cos(angle to the beam axis) x kinetic energy [MeV]
+///  H2 z_particle    : production z [cm] x particle category
+///
+/// The volume index is the position of the logical volume in the
+/// G4LogicalVolumeStore (0 World, then layer1, layer2, ..., up to 15 layers);
+/// the particle categories are listed in EParticleCategory.
+
+class DMSHistoManager
+{
+  public:
+    enum EParticleCategory {
+      kGamma = 0, kElectron, kPositron, kNeutron, kProton, kPion, kIon, kOther,
+      kNumberOfCategories
+    };
+
+    DMSHistoManager();
+    ~DMSHistoManager();
+
+    void Book();
+    void SetActivation(G4bool active);
+    // Clear the contents, e.g. once they are summed elsewhere
+    void Reset();
+
+    // Drop the cached volume indices and categories; called when a run starts
+    void ClearCache();
+
+    inline G4int GetVolumeIndex(const G4LogicalVolume* volume);
+    void Fill(const G4ParticleDefinition* particle, G4double kineticEnergy,
+              G4double cosTheta, G4double z, G4int volumeIndex);
+
+  private:
+    G4int ResolveVolumeIndex(const G4LogicalVolume* volume);
+    G4int GetCategory(const G4ParticleDefinition* particle);
+
+    G4int fNeutronEId;
+    G4int fEnergyVolumeId;
+    G4int fCosThetaEnergyId;
+    G4int fZParticleId;
+
+    std::unordered_map<const G4LogicalVolume*, G4int>      fVolumeIndex;
+    std::unordered_map<const G4ParticleDefinition*, G4int> fCategory;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4int DMSHistoManager::GetVolumeIndex(const G4LogicalVolume* volume)
+{
+  auto it = fVolumeIndex.find(volume);
+  if ( it != fVolumeIndex.end() ) return it->second;
+  return ResolveVolumeIndex(volume);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,60 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSMPIReducer.hh
+/// \brief Definition of the DMSMPIReducer class
+
+#ifndef DMSMPIReducer_h
+#define DMSMPIReducer_h 1
+
+#include "globals.hh"
+
+class DMSRunAction;
+
+/// End of job reduction over the MPI ranks of dms-dump_cooling_mpi, the
+/// G4MPI build (WITH_MPI, DMS_WITH_MPI).
+///
+/// Every rank runs the multithreaded run manager on its slice of the
+/// events as shard <rank> of <size> (DMSShard), in a single run. At the end
+/// the histograms are summed into rank 0 with G4MPIhistoMerger and the
+/// scorers of every rank are added into rank 0: the counters and the mesh
+/// voxels with MPI_Reduce, the sums per volume and the nuclide inventory
+/// received one rank after the other; rank 0 writes the histogram file and
+/// the mesh, thermal, nuclide and activation results, and prints the event
+/// throughput of every rank. The other ranks write a file only when they
+/// record ntuples.
+
+class DMSMPIReducer
+{
+  public:
+    // Collective over all ranks; called on the master thread after the run
+    // of the rank, nEvents events in the given wall time
+    static void Reduce(DMSRunAction& runAction, G4int nEvents, G4double seconds);
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSNameDictionary.hh
+/// \brief Definition of the DMSNameDictionary class
+
+#ifndef DMSNameDictionary_h
+#define DMSNameDictionary_h 1
+
+#include "globals.hh"
+
+#include <unordered_map>
+#include <vector>
+
+class G4VProcess;
+class G4ParticleDefinition;
+class G4LogicalVolume;
+
+/// Maps processes, particle definitions and logical volumes to small integer
+/// codes so that the secondary ntuple can store int columns instead of
+/// strings.
+///
+/// The code assignment is global (shared by all threads and keyed by name),
+/// so that codes written by different workers into a merged ntuple agree.
+/// Each thread keeps its own pointer -> code cache in front of it; the
+/// global table is only locked on a cache miss, i.e. a few dozen times per
+/// thread and run.
+
+class DMSNameDictionary
+{
+  public:
+    enum Kind { kProcess = 0, kParticle, kVolume, kNumberOfKinds };
+
+    DMSNameDictionary();
+    ~DMSNameDictionary();
+
+    inline G4int GetCode(const G4VProcess* process);
+    inline G4int GetCode(const G4ParticleDefinition* particle);
+    inline G4int GetCode(const G4LogicalVolume* volume);
+
+    // Forget the cached volume pointers, once the geometry is rebuilt
+    void ClearVolumeCache() { fCache[kVolume].clear(); }
+
+    // Snapshot of the global code -> name table of the given kind
+    static std::vector<G4String> GetNames(Kind kind);
+    static const char* GetKindName(Kind kind);
+
+  private:
+    G4int Lookup(Kind kind, const void* key);
+    G4int Insert(Kind kind, const void* key);
+    static G4int Register(Kind kind, const G4String& name);
+
+    std::unordered_map<const void*, G4int> fCache[kNumberOfKinds];
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4int DMSNameDictionary::Lookup(Kind kind, const void* key)
+{
+  auto it = fCache[kind].find(key);
+  if ( it != fCache[kind].end() ) return it->second;
+  return Insert(kind, key);
+}
+
+inline G4int DMSNameDictionary::GetCode(const G4VProcess* process)
+{
+  return Lookup(kProcess, process);
+}
+
+inline G4int DMSNameDictionary::GetCode(const G4ParticleDefinition* particle)
+{
+  return Lookup(kParticle, particle);
+}
+
+inline G4int DMSNameDictionary::GetCode(const G4LogicalVolume* volume)
+{
+  return Lookup(kVolume, volume);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
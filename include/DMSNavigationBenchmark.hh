@@ -0,0 +1,58 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSNavigationBenchmark.hh
+/// \brief Definition of the DMSNavigationBenchmark class
+
+#ifndef DMSNavigationBenchmark_h
+#define DMSNavigationBenchmark_h 1
+
+#include "globals.hh"
+
+class DMSDetectorConstruction;
+
+/// Navigation benchmark of the two geometry modes of DMSDetectorConstruction.
+///
+/// Run() builds the current layer stack once as boolean shells and once as
+/// nested boxes, next to the geometry of the runs, and for each of them
+/// traces the same straight rays, from random points in the dump in random
+/// directions, with a navigator of its own until they leave the dump. It
+/// prints the steps, the time in navigation and the steps per second.
+/// It then locates the same random points in both geometries and counts
+/// the points where the materials differ: zero for an equivalent nested
+/// geometry. The rays use their own random engine with a fixed seed, so
+/// the benchmark is reproducible and leaves the event seeds alone.
+/// The benchmark volumes are deleted at the end.
+
+class DMSNavigationBenchmark
+{
+  public:
+    static void Run(const DMSDetectorConstruction* detector, G4int nRays);
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,156 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSNuclideInventory.hh
+/// \brief Definition of the DMSNuclideInventory class
+
+#ifndef DMSNuclideInventory_h
+#define DMSNuclideInventory_h 1
+
+#include "G4VAccumulable.hh"
+#include "G4Track.hh"
+#include "G4VProcess.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Ions.hh"
+#include "DMSNuclideMap.hh"
+#include "globals.hh"
+
+#include <iosfwd>
+
+class DMSNuclideInventoryMessenger;
+
+/// Residual nuclide inventory per layer (/dms/nuclides/ commands).
+///
+/// Every nucleus produced as a secondary is counted, with its track weight,
+/// under the key (Z, A, isomer level, physical volume, copy number). The
+/// products of radioactive decays are not counted by default, so that the
+/// table holds what the beam produces. Every thread owns its own
+/// instance with an open-addressing DMSNuclideMap; as a G4VAccumulable the
+/// maps are summed into the master instance at the end of the run, which
+/// prints the main nuclides and writes <fileName>.csv with the production
+/// per primary of every entry.
+///
+/// Key layout: isomer level bits 0-7, A bits 8-16, Z bits 17-23, copy
+/// number bits 24-39, volume instance ID bits 40-63.
+
+class DMSNuclideInventory : public G4VAccumulable
+{
+  public:
+    // Fields of a key
+    struct Nuclide
+    {
+      explicit Nuclide(uint64_t key)
+      : isomer(key & 0xff),
+        A(( key >> 8 ) & 0x1ff),
+        Z(( key >> 17 ) & 0x7f),
+        copyNumber(( key >> 24 ) & 0xffff),
+        volumeID(( key >> 40 ) & 0xffffff) { }
+
+      G4int isomer;
+      G4int A;
+      G4int Z;
+      G4int copyNumber;
+      G4int volumeID;
+    };
+
+    DMSNuclideInventory();
+    virtual ~DMSNuclideInventory();
+
+    // G4VAccumulable
+    virtual void Merge(const G4VAccumulable& other);
+    virtual void Reset();
+
+    void   SetActive(G4bool value)          { fActive = value; }
+    G4bool IsActive() const                 { return fActive; }
+    void   SetDecayProducts(G4bool value)   { fDecayProducts = value; }
+    void   SetPrintLimit(G4int value)       { fPrintLimit = value; }
+    void   SetFileName(const G4String& name) { fFileName = name; }
+    const G4String& GetFileName() const     { return fFileName; }
+
+    inline void Fill(const G4Track* secondary, const G4VPhysicalVolume* volume,
+                     G4int copyNumber);
+    void AddPrimaryEnergy(G4double energy) { fPrimaryEnergy += energy; }
+
+    // Merged inventory, e.g. for DMSActivationSolver
+    const DMSNuclideMap& GetMap() const  { return fMap; }
+    G4double GetPrimaryEnergy() const    { return fPrimaryEnergy; }
+
+    // Print and write the inventory for the number of primaries; called on
+    // the master
+    void Write(G4int nPrimaries) const;
+
+    // Merged state for DMSCheckpoint and DMSShard; the volumes are saved
+    // by name and Load() adds the saved counts to the volumes of the same
+    // name in the current geometry
+    void   Save(std::ostream& stream) const;
+    G4bool Load(std::istream& stream);
+
+    static inline uint64_t Key(G4int Z, G4int A, G4int isomer,
+                               G4int volumeID, G4int copyNumber);
+
+  private:
+    DMSNuclideInventoryMessenger* fMessenger;
+    G4bool   fActive;
+    G4bool   fDecayProducts;
+    G4int    fPrintLimit;
+    G4String fFileName;
+    DMSNuclideMap fMap;
+    G4double fPrimaryEnergy;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline uint64_t DMSNuclideInventory::Key(G4int Z, G4int A, G4int isomer,
+                                         G4int volumeID, G4int copyNumber)
+{
+  return   uint64_t(isomer & 0xff)
+         | ( uint64_t(A & 0x1ff) << 8 )
+         | ( uint64_t(Z & 0x7f) << 17 )
+         | ( uint64_t(copyNumber & 0xffff) << 24 )
+         | ( uint64_t(volumeID & 0xffffff) << 40 );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void DMSNuclideInventory::Fill(const G4Track* secondary,
+                                      const G4VPhysicalVolume* volume,
+                                      G4int copyNumber)
+{
+  const G4ParticleDefinition* definition = secondary->GetDefinition();
+  if ( definition->GetParticleType() != "nucleus" ) return;
+  if ( ! fDecayProducts ) {
+    const G4VProcess* creator = secondary->GetCreatorProcess();
+    if ( creator && creator->GetProcessType() == fDecay ) return;
+  }
+  const G4Ions* ion = static_cast<const G4Ions*>(definition);
+  fMap.Add(Key(ion->GetAtomicNumber(), ion->GetAtomicMass(),
+               ion->GetIsomerLevel(), volume->GetInstanceID(), copyNumber),
+           secondary->GetWeight());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,135 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSNuclideMap.hh
+/// \brief Definition of the DMSNuclideMap class
+
+#ifndef DMSNuclideMap_h
+#define DMSNuclideMap_h 1
+
+#include "globals.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/// Open-addressing hash map from a non-zero 64 bit key to a summed weight.
+///
+/// Linear probing in a power-of-two table of key/value slots with
+/// Fibonacci hashing: a lookup touches one or two cache lines and never
+/// allocates. The table doubles when it is half full. Key 0 marks an empty
+/// slot. Entries cannot be removed, only all cleared.
+
+class DMSNuclideMap
+{
+  public:
+    struct Slot
+    {
+      uint64_t key;
+      G4double value;
+    };
+
+    explicit DMSNuclideMap(size_t capacity = 1024);
+    ~DMSNuclideMap() {}
+
+    inline void Add(uint64_t key, G4double value);
+    void Clear();
+
+    size_t Size() const { return fSize; }
+    // All slots, the empty ones have key 0
+    const std::vector<Slot>& GetSlots() const { return fSlots; }
+
+  private:
+    void Grow();
+    inline size_t Hash(uint64_t key) const
+      { return ( key * 0x9E3779B97F4A7C15ULL ) >> fShift; }
+
+    std::vector<Slot> fSlots;
+    size_t fMask;
+    size_t fSize;
+    G4int  fShift;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline DMSNuclideMap::DMSNuclideMap(size_t capacity)
+: fSlots(), fMask(0), fSize(0), fShift(64)
+{
+  size_t size = 16;
+  while ( size < capacity ) size <<= 1;
+  fSlots.assign(size, Slot{0, 0.});
+  fMask = size - 1;
+  while ( ( size_t(1) << ( 64 - fShift ) ) < size ) --fShift;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void DMSNuclideMap::Add(uint64_t key, G4double value)
+{
+  size_t index = Hash(key);
+  while ( true ) {
+    Slot& slot = fSlots[index];
+    if ( slot.key == key ) {
+      slot.value += value;
+      return;
+    }
+    if ( slot.key == 0 ) {
+      slot.key = key;
+      slot.value = value;
+      if ( 2 * ++fSize > fSlots.size() ) Grow();
+      return;
+    }
+    index = ( index + 1 ) & fMask;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void DMSNuclideMap::Clear()
+{
+  std::fill(fSlots.begin(), fSlots.end(), Slot{0, 0.});
+  fSize = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void DMSNuclideMap::Grow()
+{
+  std::vector<Slot> slots(2 * fSlots.size(), Slot{0, 0.});
+  slots.swap(fSlots);
+  fMask = fSlots.size() - 1;
+  --fShift;
+  for ( const Slot& slot : slots ) {
+    if ( slot.key == 0 ) continue;
+    size_t index = Hash(slot.key);
+    while ( fSlots[index].key != 0 ) index = ( index + 1 ) & fMask;
+    fSlots[index] = slot;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
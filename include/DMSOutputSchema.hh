@@ -0,0 +1,121 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSOutputSchema.hh
+/// \brief Definition of the DMSOutputSchema class
+
+#ifndef DMSOutputSchema_h
+#define DMSOutputSchema_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+/// Column of an ntuple: name and type code as used by G4AnalysisManager
+/// ('I' int, 'F' float, 'D' double, 'S' string).
+
+struct DMSNtupleColumn
+{
+  G4String name;
+  char     type;
+};
+
+/// Kinematic column of the secondary ntuple: a DMSOutputSchema::Quantity
+/// stored as float ('F') or double ('D').
+
+struct DMSKinematicColumn
+{
+  G4int quantity;
+  char  type;
+};
+
+/// Names and layout of the objects written into the output file.
+///
+/// Shared by DMSRunAction, which books them, and by the dms-merge tool,
+/// which reads them back from the per-thread files.
+/// The secondary ntuple holds the four name (or code) columns followed by
+/// a selectable list of kinematic columns (/dms/record/columns). The layout
+/// actually written is stored in the DMSSchema ntuple, one row per column.
+/// In the "event" layout (/dms/record/layout) the mother column is replaced
+/// by the trackID and parentID of the secondary, and the DMSEvents ntuple
+/// holds one row per event with the number of its contiguous secondary
+/// rows.
+
+class DMSOutputSchema
+{
+  public:
+    enum Quantity {
+      kKinE = 0, kX, kY, kZ, kGlobalTime, kLocalTime,
+      kPx, kPy, kPz, kDirX, kDirY, kDirZ, kNumberOfQuantities
+    };
+
+    static const char* GetSecondaryNtupleName()  { return "DMSDumpSim"; }
+    static const char* GetDictionaryNtupleName() { return "DMSDictionary"; }
+    static const char* GetSchemaNtupleName()     { return "DMSSchema"; }
+    static const char* GetEventsNtupleName()     { return "DMSEvents"; }
+
+    static std::vector<DMSNtupleColumn>
+      GetSecondaryColumns(G4bool useCodes,
+                          const std::vector<DMSKinematicColumn>& kinematics,
+                          G4bool eventLayout = false);
+    static std::vector<DMSNtupleColumn> GetDictionaryColumns();
+    static std::vector<DMSNtupleColumn> GetSchemaColumns();
+    static std::vector<DMSNtupleColumn> GetEventColumns();
+
+    // Column name and unit of a quantity ("kinE", MeV)
+    static const char* GetQuantityName(G4int quantity);
+    static G4double    GetQuantityUnit(G4int quantity);
+
+    // Size-tuned default: kinE, position, global time and direction as
+    // float; the momentum follows from kinE and the direction
+    static std::vector<DMSKinematicColumn> GetDefaultKinematics(char type = 'F');
+    // All twelve quantities, the layout of files without DMSSchema
+    static std::vector<DMSKinematicColumn> GetAllKinematics(char type = 'D');
+    // Parse a blank-separated list of column names, each optionally
+    // suffixed with ":F" or ":D"; "default" and "all" select the lists
+    // above. Returns false, with the reason in error if given, if a name
+    // is unknown or a quantity is selected twice.
+    static G4bool ParseKinematics(const G4String& list, char defaultType,
+                                  std::vector<DMSKinematicColumn>& kinematics,
+                                  G4String* error = 0);
+
+    // DMSNameDictionary kind of a code column ("procID" -> kProcess),
+    // -1 for the other columns
+    static G4int GetCodeKind(const G4String& column);
+    // Name column matching a code column ("procID" -> "procName")
+    static G4String GetNameColumn(const G4String& codeColumn);
+
+    // Book an ntuple with the given columns, returns its id
+    static G4int CreateNtuple(const G4String& name, const G4String& title,
+                              const std::vector<DMSNtupleColumn>& columns);
+
+    static const std::vector<G4String>& GetH1Names();
+    static const std::vector<G4String>& GetH2Names();
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
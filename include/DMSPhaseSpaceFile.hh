@@ -0,0 +1,104 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhaseSpaceFile.hh
+/// \brief Definition of the DMSPhaseSpaceFile class
+
+#ifndef DMSPhaseSpaceFile_h
+#define DMSPhaseSpaceFile_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <vector>
+
+/// One particle of a phase-space file, 40 bytes: the PDG code, the
+/// statistical weight, the position in mm, the direction, the kinetic
+/// energy in MeV and the time in ns.
+
+struct DMSPhaseSpaceRecord
+{
+  int32_t pdg;
+  float   weight;
+  float   x, y, z;
+  float   ux, uy, uz;
+  float   kineticEnergy;
+  float   time;
+};
+
+/// A binary phase-space file, mapped read-only in memory.
+///
+/// The file is a 16 byte header ("DMSP", the format version, the record
+/// size and the number of primaries simulated to produce the records, 0
+/// if unknown, as 32 bit integers) followed by the records; the number of
+/// records follows from the file size. The mapping is shared by all
+/// threads, which read it concurrently with their own cursors, and the
+/// pages are loaded by the system as they are read, so that files larger
+/// than the memory can be used. Open() maps a file once; a file changed
+/// since it was mapped is mapped again, the earlier mappings being kept
+/// until the end of the job.
+
+class DMSPhaseSpaceFile
+{
+  public:
+    // The mapping of the file; 0, with a warning, if it is not readable
+    static const DMSPhaseSpaceFile* Open(const G4String& fileName);
+
+    const G4String& GetFileName() const { return fFileName; }
+    uint64_t GetNumberOfRecords() const { return fNumberOfRecords; }
+    uint32_t GetNumberOfPrimaries() const { return fNumberOfPrimaries; }
+    const DMSPhaseSpaceRecord& GetRecord(uint64_t index) const
+      { return fRecords[index]; }
+
+    // Write the header of a file, at the current position
+    static void WriteHeader(std::ostream& file, uint32_t nPrimaries);
+
+  private:
+    DMSPhaseSpaceFile(const G4String& fileName);
+    ~DMSPhaseSpaceFile();
+
+    G4String fFileName;
+    void*    fMap;
+    size_t   fMapSize;
+    int64_t  fModified;
+    const DMSPhaseSpaceRecord* fRecords;
+    uint64_t fNumberOfRecords;
+    uint32_t fNumberOfPrimaries;
+
+    // Deletes the mappings at the end of the job
+    struct Registry
+    {
+      ~Registry();
+      std::map<G4String, std::vector<DMSPhaseSpaceFile*> > files;
+    };
+    static Registry fgRegistry;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
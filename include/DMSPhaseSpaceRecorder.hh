@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhaseSpaceRecorder.hh
+/// \brief Definition of the DMSPhaseSpaceRecorder class
+
+#ifndef DMSPhaseSpaceRecorder_h
+#define DMSPhaseSpaceRecorder_h 1
+
+#include "DMSPhaseSpaceFile.hh"
+#include "globals.hh"
+
+#include <fstream>
+#include <vector>
+
+class G4Step;
+class G4LogicalVolume;
+class DMSPhaseSpaceRecorderMessenger;
+
+/// Recording of the particles that cross into a volume (/dms/phaseSpace/
+/// commands), the first stage of a two-stage simulation.
+///
+/// Every particle that enters the selected logical volume through one of
+/// its boundaries, from outside or from a volume inside it, is written to
+/// a phase-space file (see DMSPhaseSpaceFile) at the boundary, with its
+/// track weight. The file is replayed in the second stage by
+/// /dms/beam/phaseSpace. With /dms/phaseSpace/kill the recorded particles
+/// are stopped, so that the first stage does not simulate the layers that
+/// the second stage studies.
+///
+/// The recorder is shared by all threads: the master opens the file in
+/// BeginOfRunAction() and closes it in EndOfRunAction(). Every thread
+/// fills its own buffer, appended to the file under a lock when it is
+/// full and at the end of the run of the thread; the records are
+/// therefore in the order in which the buffers were flushed. The file is
+/// written under a temporary name and renamed when it is complete; the
+/// number of events of the run is then stored in its header, so that the
+/// second stage can normalise its results per primary of the first.
+
+class DMSPhaseSpaceRecorder
+{
+  public:
+    static DMSPhaseSpaceRecorder* Instance();
+
+    void SetVolumeName(const G4String& name);
+    const G4String& GetVolumeName() const { return fVolumeName; }
+    void SetFileName(const G4String& name) { fFileName = name; }
+    const G4String& GetFileName() const { return fFileName; }
+    void SetKill(G4bool value) { fKill = value; }
+    G4bool IsActive() const { return ! fVolumeName.empty(); }
+
+    // Master
+    void Open(const G4String& suffix);
+    void Close(G4int nEvents);
+
+    // Called by DMSSteppingAction; true if the track is to be stopped
+    G4bool Record(const G4Step* step);
+    // Append the buffer of the calling thread to the file
+    void Flush();
+
+  private:
+    DMSPhaseSpaceRecorder();
+    ~DMSPhaseSpaceRecorder();
+
+    DMSPhaseSpaceRecorderMessenger* fMessenger;
+
+    G4String fVolumeName;
+    G4String fFileName;
+    G4bool   fKill;
+
+    // State of the open file
+    const G4LogicalVolume* fVolume;
+    G4String      fOutputName;
+    std::ofstream fFile;
+    uint64_t      fRecords;
+
+    static G4ThreadLocal std::vector<DMSPhaseSpaceRecord>* fgBuffer;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,64 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhaseSpaceRecorderMessenger.hh
+/// \brief Definition of the DMSPhaseSpaceRecorderMessenger class
+
+#ifndef DMSPhaseSpaceRecorderMessenger_h
+#define DMSPhaseSpaceRecorderMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class DMSPhaseSpaceRecorder;
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+
+/// Messenger class that defines the /dms/phaseSpace/ commands of
+/// DMSPhaseSpaceRecorder. The recorder is shared by all threads, so the
+/// commands are not broadcast to the workers.
+
+class DMSPhaseSpaceRecorderMessenger : public G4UImessenger
+{
+  public:
+    DMSPhaseSpaceRecorderMessenger(DMSPhaseSpaceRecorder* recorder);
+    virtual ~DMSPhaseSpaceRecorderMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    DMSPhaseSpaceRecorder* fRecorder;
+
+    G4UIdirectory*      fPhaseSpaceDirectory;
+    G4UIcmdWithAString* fRecordCmd;
+    G4UIcmdWithAString* fFileNameCmd;
+    G4UIcmdWithABool*   fKillCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
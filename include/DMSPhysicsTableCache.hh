@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhysicsTableCache.hh
+/// \brief Definition of the DMSPhysicsTableCache class
+
+#ifndef DMSPhysicsTableCache_h
+#define DMSPhysicsTableCache_h 1
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+#include <cstdint>
+#include <string>
+
+class DMSPhysicsTableCacheMessenger;
+class G4VModularPhysicsList;
+
+/// Cache of the physics tables between jobs (/dms/physicsCache/ commands).
+///
+/// When a run initializes, the master hashes what the tables depend on:
+/// the Geant4 version, the physics constructors of the list, the
+/// materials, the material and region of every logical volume and the
+/// production cuts of the regions. If the cache directory has a
+/// subdirectory for the hash, the tables are retrieved from it
+/// (/run/particle/retrievePhysicsTable); otherwise they are built and then
+/// stored into it (/run/particle/storePhysicsTable). The subdirectory is
+/// written under a temporary name and renamed, so jobs sharing the cache
+/// never read incomplete tables.
+///
+/// The build time is kept with the tables, and the time of the retrieval
+/// is printed next to it. The HP data are not part of the tables and are
+/// read again by every job.
+
+class DMSPhysicsTableCache : public G4VStateDependent
+{
+  public:
+    DMSPhysicsTableCache(G4VModularPhysicsList* physicsList);
+    virtual ~DMSPhysicsTableCache();
+
+    // G4VStateDependent
+    virtual G4bool Notify(G4ApplicationState requestedState);
+
+    void SetDirectory(const G4String& directory) { fDirectory = directory; }
+    void SetEnabled(G4bool value)                { fEnabled = value; }
+
+  private:
+    enum Mode { kNone, kRetrieve, kStore };
+
+    uint64_t ComputeKey(std::string& description) const;
+    G4String GetTableDirectory(uint64_t key) const;
+    void     Store();
+
+    G4VModularPhysicsList* fPhysicsList;
+    DMSPhysicsTableCacheMessenger* fMessenger;
+
+    G4String fDirectory;
+    G4bool   fEnabled;
+    uint64_t fKey;
+    Mode     fMode;
+    G4String fTableDirectory;
+    G4String fDescription;
+    G4double fBuildSeconds;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
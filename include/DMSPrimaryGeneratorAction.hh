@@ -32,16 +32,46 @@
 
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleGun.hh"
+#include "G4ThreeVector.hh"
 #include "globals.hh"
 
+#include <cstdint>
+#include <map>
+
 class G4ParticleGun;
 class G4Event;
-class G4Box;
+class G4ParticleDefinition;
+class DMSPhaseSpaceFile;
+class DMSPrimaryGeneratorMessenger;
 
 /// The primary generator action class with particle gun.
 ///
-/// The default kinematic is a 6 MeV gamma, randomly distribued 
-/// in front of the phantom across 80% of the (X,Y) phantom size.
+/// The default kinematic is a 600 MeV proton pencil beam along z, started
+/// just in front of the dump face. The /dms/beam/ commands give the beam a
+/// Gaussian, possibly elliptical, spot and a Gaussian divergence in x and
+/// y, and raster it over a rectangle with a triangular sweep in x and y,
+/// advanced by the event number. The particle and the energy are those of
+/// the gun (/gun/particle, /gun/energy).
+///
+/// Alternatively the primaries are read from a phase-space file (see
+/// DMSPhaseSpaceFile), a given number per event. Each thread reads the
+/// shared mapping of the file with its own cursor, placed for every event
+/// at the event number times the particles per event, so that an event
+/// gets the same particles whatever the thread or the order of the events;
+/// the file is recycled when the events need more particles than it has.
+/// The particles before the dump face are moved along their direction to
+/// the face, through the vacuum of the World.
+/// In the second stage of a two-stage simulation (see DMSPhaseSpaceRecorder)
+/// every group of particles can be recycled in several events, each time
+/// turned about the z axis at random: by a multiple of 90 degrees with a
+/// random reflection, the symmetries of square layers on the axis, or by
+/// any angle for a geometry symmetric about the axis. The number of
+/// first-stage primaries that an event stands for, from the header of the
+/// file, is kept for DMSRunAction, which prints the results of the second
+/// stage per primary of the first.
+///
+/// The dump face is the lowest z of the volumes placed in the World,
+/// found again at every run from the G4LogicalVolumeStore.
 
 class DMSPrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
@@ -55,9 +85,61 @@ class DMSPrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     // method to access particle gun
     const G4ParticleGun* GetParticleGun() const { return fParticleGun; }
 
+    // Beam profile, widths as rms
+    void SetSpot(G4double sigmaX, G4double sigmaY)
+      { fSigmaX = sigmaX; fSigmaY = sigmaY; }
+    void SetDivergence(G4double sigmaX, G4double sigmaY)
+      { fDivergenceX = sigmaX; fDivergenceY = sigmaY; }
+    void SetRaster(G4double halfX, G4double halfY)
+      { fRasterX = halfX; fRasterY = halfY; }
+    void SetRasterPeriods(G4int eventsX, G4int eventsY)
+      { fRasterPeriodX = eventsX; fRasterPeriodY = eventsY; }
+    void SetCentre(const G4ThreeVector& centre) { fCentre = centre; }
+    void SetStartAtFace(G4bool value) { fStartAtFace = value; }
+
+    // Phase-space source, "" for the beam
+    void SetPhaseSpaceFile(const G4String& fileName);
+    void SetParticlesPerEvent(G4int value) { fParticlesPerEvent = value; }
+    enum Rotation { kNoRotation, kSquare, kFree };
+    void SetRecycle(G4int value) { fRecycle = value; }
+    void SetRotation(Rotation value) { fRotation = value; }
+
+    // Primaries of the first stage per event of the current run, 0 for
+    // the beam or if the phase-space file does not give them
+    static G4double GetSourcePrimariesPerEvent();
+
   private:
+    void BeginRun();
+    void GenerateBeam(G4Event* event, G4int eventNumber);
+    void GeneratePhaseSpace(G4Event* event, G4int eventNumber);
+    G4ParticleDefinition* GetDefinition(G4int pdg);
+
     G4ParticleGun*  fParticleGun; // pointer a to G4 gun class
-    G4Box* fEnvelopeBox;
+    DMSPrimaryGeneratorMessenger* fMessenger;
+
+    G4double fSigmaX;
+    G4double fSigmaY;
+    G4double fDivergenceX;
+    G4double fDivergenceY;
+    G4double fRasterX;
+    G4double fRasterY;
+    G4int    fRasterPeriodX;
+    G4int    fRasterPeriodY;
+    G4ThreeVector fCentre;
+    G4bool   fStartAtFace;
+    G4double fFaceZ;
+
+    G4String fPhaseSpaceName;
+    const DMSPhaseSpaceFile* fPhaseSpace;
+    G4int    fParticlesPerEvent;
+    G4int    fRecycle;
+    Rotation fRotation;
+    uint64_t fCursor;
+    std::map<G4int, G4ParticleDefinition*> fDefinitions;
+
+    G4int fRunID;
+
+    static G4double fgSourcePrimariesPerEvent;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,77 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPrimaryGeneratorMessenger.hh
+/// \brief Definition of the DMSPrimaryGeneratorMessenger class
+
+#ifndef DMSPrimaryGeneratorMessenger_h
+#define DMSPrimaryGeneratorMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class DMSPrimaryGeneratorAction;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWith3VectorAndUnit;
+
+/// Messenger class that defines the /dms/beam/ commands of
+/// DMSPrimaryGeneratorAction. Every worker has its own generator, so the
+/// commands are broadcast, as the /gun/ commands.
+
+class DMSPrimaryGeneratorMessenger : public G4UImessenger
+{
+  public:
+    DMSPrimaryGeneratorMessenger(DMSPrimaryGeneratorAction* generator);
+    virtual ~DMSPrimaryGeneratorMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    G4UIcommand* NewPairCommand(const char* name, const char* defaultUnit);
+    G4bool ReadPair(const G4String& value, G4double& x, G4double& y) const;
+
+    DMSPrimaryGeneratorAction* fGenerator;
+
+    G4UIdirectory*       fBeamDirectory;
+    G4UIcommand*         fSpotCmd;
+    G4UIcommand*         fDivergenceCmd;
+    G4UIcommand*         fRasterCmd;
+    G4UIcommand*         fRasterPeriodsCmd;
+    G4UIcmdWith3VectorAndUnit* fCentreCmd;
+    G4UIcmdWithABool*    fStartAtFaceCmd;
+    G4UIcmdWithAString*  fPhaseSpaceCmd;
+    G4UIcmdWithAnInteger* fParticlesPerEventCmd;
+    G4UIcmdWithAnInteger* fRecycleCmd;
+    G4UIcmdWithAString*  fRotationCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -32,15 +32,61 @@
 
 #include "G4UserRunAction.hh"
 #include "G4Accumulable.hh"
+#include "DMSSecondaryFilter.hh"
+#include "DMSHistoManager.hh"
+#include "DMSAsyncWriter.hh"
 #include "globals.hh"
 
+#include <iosfwd>
+
 class G4Run;
+class DMSRunActionMessenger;
+class DMSEnergyMesh;
+class DMSThermalSolver;
+class DMSNuclideInventory;
+class DMSActivationSolver;
+class DMSCheckpoint;
+class DMSEventSeeder;
+class DMSDesignScan;
 
 /// Run action class
 ///
-/// In EndOfRunAction(), it calculates the dose in the selected volume 
-/// from the energy deposit accumulated via stepping and event actions.
-/// The computed dose is then printed on the screen.
+/// It books the DMSDumpSim ntuple at the first BeginOfRunAction(), so that
+/// the layout selected with /dms/record/ commands is known, and writes the
+/// output file in EndOfRunAction().
+/// With the "codes" encoding the name columns are replaced by int codes from
+/// DMSNameDictionary and the code -> name table is written into the
+/// DMSDictionary ntuple at the end of each run.
+/// The kinematic columns and their precision are selected with
+/// /dms/record/columns and /dms/record/precision; the resulting layout is
+/// written into the DMSSchema ntuple.
+/// With /dms/record/layout event the rows carry trackID and parentID and an
+/// event index (DMSEvents ntuple, or the event blocks/lists of the binary
+/// and arrow formats) gives the contiguous rows of each event.
+/// It also owns the thread-local DMSSecondaryFilter applied by
+/// DMSSteppingAction before anything is buffered, the event trigger
+/// evaluated by DMSEventAction, and the DMSHistoManager spectra filled in
+/// the "histograms" and "both" record modes.
+/// The DMSEnergyMesh of deposited energy (/dms/mesh/) is a registered
+/// accumulable; the master writes the merged mesh at the end of the run
+/// and passes it to the DMSThermalSolver (/dms/thermal/). The residual
+/// nuclide inventory (/dms/nuclides/) is merged and written the same way
+/// and feeds the DMSActivationSolver (/dms/activation/).
+/// Long runs can be split by DMSCheckpoint (/dms/checkpoint/): the master
+/// then keeps its accumulables between the runs, writes the final outputs
+/// after the last one only and the output files get a _c<run> suffix.
+/// The per-event seeds are set up with DMSEventSeeder (/dms/random/); the
+/// event IDs in the output are the event numbers of the whole job.
+/// With /dms/output/perThreadFiles each worker writes its ntuples into its
+/// own file instead of sending them to the master; the files can be
+/// combined after the run with the dms-merge tool.
+/// With /dms/output/format binary or arrow the rows are not filled into an
+/// ntuple but collected in per-thread batches and written by the
+/// DMSAsyncWriter thread.
+/// At the end of each run the master prints the scaling efficiency over
+/// the worker threads, see DMSScalingMonitor, and the number of neutrons
+/// leaving the dump. DMSDesignScan (/dms/scan/) runs a list of geometry
+/// variants in one job and compares them.
 
 class DMSRunAction : public G4UserRunAction
 {
@@ -52,8 +98,114 @@ class DMSRunAction : public G4UserRunAction
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
 
+    void   SetUseNameCodes(G4bool value);
+    G4bool GetUseNameCodes() const { return fUseNameCodes; }
+
+    void   SetColumns(const G4String& list);
+    void   SetPrecision(const G4String& precision);
+    const std::vector<DMSKinematicColumn>& GetKinematics() const
+      { return fKinematics; }
+
+    void   SetLayout(const G4String& layout);
+    G4bool GetEventLayout() const { return fEventLayout; }
+
+    void   SetRecordMode(const G4String& mode);
+    G4bool GetFillNtuple() const     { return fFillNtuple; }
+    G4bool GetFillHistograms() const { return fFillHistograms; }
+
+    void   SetPerThreadFiles(G4bool value);
+    G4bool GetPerThreadFiles() const { return fPerThreadFiles; }
+
+    void   SetOutputFormat(const G4String& format);
+    // Whether the rows go through DMSAsyncWriter instead of an ntuple
+    G4bool GetAsyncOutput() const  { return fAsyncOutput; }
+    void   SetBatchRows(G4int rows)     { fBatchRows = rows; }
+    void   SetBatchEvents(G4int events) { fBatchEvents = events; }
+    void   SetQueueDepth(G4int depth)   { fQueueDepth = depth; }
+
+    // Batch of the binary output currently filled by this thread
+    inline DMSOutputBatch* GetOutputBatch();
+    // Close the event in the event index and hand the batch over to the
+    // writer once it holds enough rows or events
+    void EndOfEventOutput(G4int eventID, size_t nRows);
+
+    DMSSecondaryFilter& GetSecondaryFilter() { return fSecondaryFilter; }
+    DMSSecondaryFilter& GetEventTrigger()    { return fEventTrigger; }
+    DMSHistoManager&    GetHistoManager()    { return fHistoManager; }
+    DMSEnergyMesh&      GetEnergyMesh()      { return *fEnergyMesh; }
+    DMSThermalSolver&   GetThermalSolver()   { return *fThermalSolver; }
+    DMSNuclideInventory& GetNuclideInventory() { return *fNuclideInventory; }
+    DMSActivationSolver& GetActivationSolver() { return *fActivationSolver; }
+    DMSCheckpoint&       GetCheckpoint()       { return *fCheckpoint; }
+
+    // Neutrons leaving the outer surface of the dump
+    void     CountLeakingNeutron()      { fLeakingNeutrons += 1.; }
+    G4double GetLeakingNeutrons() const { return fLeakingNeutrons.GetValue(); }
+
+    // The event counters of the trigger and the leaking neutrons, summed
+    // over the MPI ranks by DMSMPIReducer
+    void GetCounters(G4double counters[3]) const;
+    void SetCounters(const G4double counters[3]);
+
+    // Merged accumulables of the master, for DMSCheckpoint and DMSShard;
+    // LoadScorers() adds the saved values to the current ones
+    void   SaveScorers(std::ostream& stream) const;
+    G4bool LoadScorers(std::istream& stream);
+    // Write the mesh, thermal, nuclide and activation results of the
+    // master for nEvents primaries
+    void   WriteResults(G4int nEvents);
+
+    void CountEvent(G4bool kept);
+
   private:
+    void BookNtuples();
+    void FillDictionary();
+    void FillSchema();
+    G4bool CheckNotBooked(const G4String& command) const;
+
+    DMSRunActionMessenger* fMessenger;
+    G4bool fUseNameCodes;
+    G4bool fEventLayout;
+    G4String fColumnList;
+    char     fPrecision;
+    std::vector<DMSKinematicColumn> fKinematics;
+    G4bool fFillNtuple;
+    G4bool fFillHistograms;
+    G4bool fPerThreadFiles;
+    G4bool fAsyncOutput;
+    DMSAsyncWriter::Format fAsyncFormat;
+    G4int  fBatchRows;
+    G4int  fBatchEvents;
+    G4int  fQueueDepth;
+    DMSOutputBatch* fOutputBatch;
+    G4bool fNtuplesBooked;
+    G4int  fSchemaNtupleId;
+    G4int  fDictionaryNtupleId;
+    G4int  fEventsNtupleId;
+    DMSSecondaryFilter fSecondaryFilter;
+    DMSSecondaryFilter fEventTrigger;
+    DMSHistoManager    fHistoManager;
+    DMSEnergyMesh*     fEnergyMesh;
+    DMSThermalSolver*  fThermalSolver;
+    DMSNuclideInventory* fNuclideInventory;
+    DMSActivationSolver* fActivationSolver;
+    DMSCheckpoint*       fCheckpoint;
+    DMSEventSeeder*      fEventSeeder;
+    DMSDesignScan*       fDesignScan;
+    G4Accumulable<G4int> fKeptEvents;
+    G4Accumulable<G4int> fRejectedEvents;
+    G4Accumulable<G4double> fLeakingNeutrons;
 };
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline DMSOutputBatch* DMSRunAction::GetOutputBatch()
+{
+  if ( ! fOutputBatch ) {
+    fOutputBatch = DMSAsyncWriter::Instance()->NewBatch(fBatchRows);
+  }
+  return fOutputBatch;
+}
+
 #endif
 
@@ -0,0 +1,82 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSRunActionMessenger.hh
+/// \brief Definition of the DMSRunActionMessenger class
+
+#ifndef DMSRunActionMessenger_h
+#define DMSRunActionMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class DMSRunAction;
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+
+/// Messenger class that defines the /dms/record/ commands of DMSRunAction.
+
+class DMSRunActionMessenger : public G4UImessenger
+{
+  public:
+    DMSRunActionMessenger(DMSRunAction* runAction);
+    virtual ~DMSRunActionMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    DMSRunAction* fRunAction;
+
+    G4UIdirectory*      fDMSDirectory;
+    G4UIdirectory*      fRecordDirectory;
+    G4UIcmdWithAString* fModeCmd;
+    G4UIcmdWithAString* fEncodingCmd;
+    G4UIcmdWithAString* fColumnsCmd;
+    G4UIcmdWithAString* fPrecisionCmd;
+    G4UIcmdWithAString* fLayoutCmd;
+    G4UIcmdWithAString* fParticlesCmd;
+    G4UIcmdWithAString* fVolumesCmd;
+    G4UIcmdWithADoubleAndUnit* fMinEnergyCmd;
+
+    G4UIdirectory*      fTriggerDirectory;
+    G4UIcmdWithAString* fTriggerParticlesCmd;
+    G4UIcmdWithAString* fTriggerVolumesCmd;
+    G4UIcmdWithADoubleAndUnit* fTriggerMinEnergyCmd;
+
+    G4UIdirectory*    fOutputDirectory;
+    G4UIcmdWithABool* fPerThreadFilesCmd;
+    G4UIcmdWithAString*   fFormatCmd;
+    G4UIcmdWithAnInteger* fBatchRowsCmd;
+    G4UIcmdWithAnInteger* fBatchEventsCmd;
+    G4UIcmdWithAnInteger* fQueueDepthCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,90 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSScalingMonitor.hh
+/// \brief Definition of the DMSScalingMonitor class
+
+#ifndef DMSScalingMonitor_h
+#define DMSScalingMonitor_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+#include <vector>
+
+/// Scaling efficiency of a run over the worker threads.
+///
+/// Every thread sums the wall time of its events (BeginEvent() and
+/// EndEvent(), called by DMSEventAction). At the end of its run a worker
+/// reports its events, busy time and the end of its last event; the
+/// master then prints, per thread and in total, the busy time against the
+/// run wall time. The efficiency is the busy time over (threads x wall
+/// time); the tail is the time between the first and the last thread
+/// running out of events, i.e. the idle cores at the end of the run.
+
+class DMSScalingMonitor
+{
+  public:
+    // Master
+    static void BeginRun();
+    static void Print();
+
+    // Workers
+    static void BeginWorkerRun();
+    static void EndWorkerRun();
+
+    // All threads
+    static void BeginEvent();
+    static void EndEvent();
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct WorkerRecord
+    {
+      G4int    threadID;
+      G4int    events;
+      G4double busySeconds;
+      Clock::time_point end;
+    };
+
+    static Clock::time_point fgRunStart;
+    static std::vector<WorkerRecord> fgWorkers;
+
+    struct EventClock
+    {
+      Clock::time_point start;
+      Clock::time_point end;
+    };
+
+    static G4ThreadLocal EventClock* fgEventClock;
+    static G4ThreadLocal G4int    fgEvents;
+    static G4ThreadLocal G4double fgBusySeconds;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
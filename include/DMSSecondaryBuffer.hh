@@ -0,0 +1,143 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSSecondaryBuffer.hh
+/// \brief Definition of the DMSSecondaryBuffer class
+
+#ifndef DMSSecondaryBuffer_h
+#define DMSSecondaryBuffer_h 1
+
+#include "DMSOutputSchema.hh"
+#include "G4Track.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4VProcess;
+class G4ParticleDefinition;
+class G4LogicalVolume;
+
+/// Structure-of-arrays buffer of the secondaries recorded during one event.
+///
+/// DMSSteppingAction appends to it and DMSEventAction flushes or discards
+/// it at the end of the event. Names are kept as pointers and resolved only
+/// when the event is written; quantities are in Geant4 internal units.
+/// The trackID of a secondary is only known once it is stacked, it is set
+/// by DMSEventAction::AssignTrackID().
+/// Clear() keeps the capacity, so after the first events no allocation
+/// happens on the stepping path.
+
+class DMSSecondaryBuffer
+{
+  public:
+    DMSSecondaryBuffer() {}
+    ~DMSSecondaryBuffer() {}
+
+    inline void Append(const G4Track* secondary,
+                       const G4ParticleDefinition* mother,
+                       const G4LogicalVolume* volume,
+                       G4int parentID);
+    inline void Clear();
+
+    size_t Size() const { return kinE.size(); }
+    // Value of a DMSOutputSchema::Quantity for one row
+    inline G4double Get(G4int quantity, size_t row) const;
+
+    std::vector<const G4VProcess*>           process;
+    std::vector<const G4ParticleDefinition*> particle;
+    std::vector<const G4ParticleDefinition*> mother;
+    std::vector<const G4LogicalVolume*>      volume;
+    std::vector<G4int> trackID, parentID;
+    std::vector<G4double> kinE;
+    std::vector<G4double> x, y, z;
+    std::vector<G4double> globalTime, localTime;
+    std::vector<G4double> px, py, pz;
+    std::vector<G4double> dirX, dirY, dirZ;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void DMSSecondaryBuffer::Append(const G4Track* secondary,
+                                       const G4ParticleDefinition* motherParticle,
+                                       const G4LogicalVolume* productionVolume,
+                                       G4int parentTrackID)
+{
+  process.push_back(secondary->GetCreatorProcess());
+  particle.push_back(secondary->GetDefinition());
+  mother.push_back(motherParticle);
+  volume.push_back(productionVolume);
+  trackID.push_back(0);
+  parentID.push_back(parentTrackID);
+  kinE.push_back(secondary->GetKineticEnergy());
+  const G4ThreeVector& position = secondary->GetPosition();
+  x.push_back(position.x());
+  y.push_back(position.y());
+  z.push_back(position.z());
+  globalTime.push_back(secondary->GetGlobalTime());
+  localTime.push_back(secondary->GetLocalTime());
+  const G4ThreeVector momentum = secondary->GetMomentum();
+  px.push_back(momentum.x());
+  py.push_back(momentum.y());
+  pz.push_back(momentum.z());
+  const G4ThreeVector& direction = secondary->GetMomentumDirection();
+  dirX.push_back(direction.x());
+  dirY.push_back(direction.y());
+  dirZ.push_back(direction.z());
+}
+
+inline void DMSSecondaryBuffer::Clear()
+{
+  process.clear(); particle.clear(); mother.clear(); volume.clear();
+  trackID.clear(); parentID.clear();
+  kinE.clear();
+  x.clear(); y.clear(); z.clear();
+  globalTime.clear(); localTime.clear();
+  px.clear(); py.clear(); pz.clear();
+  dirX.clear(); dirY.clear(); dirZ.clear();
+}
+
+inline G4double DMSSecondaryBuffer::Get(G4int quantity, size_t row) const
+{
+  switch ( quantity ) {
+    case DMSOutputSchema::kKinE:       return kinE[row];
+    case DMSOutputSchema::kX:          return x[row];
+    case DMSOutputSchema::kY:          return y[row];
+    case DMSOutputSchema::kZ:          return z[row];
+    case DMSOutputSchema::kGlobalTime: return globalTime[row];
+    case DMSOutputSchema::kLocalTime:  return localTime[row];
+    case DMSOutputSchema::kPx:         return px[row];
+    case DMSOutputSchema::kPy:         return py[row];
+    case DMSOutputSchema::kPz:         return pz[row];
+    case DMSOutputSchema::kDirX:       return dirX[row];
+    case DMSOutputSchema::kDirY:       return dirY[row];
+    case DMSOutputSchema::kDirZ:       return dirZ[row];
+    default:                           return 0.;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
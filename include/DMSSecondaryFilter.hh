@@ -0,0 +1,106 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSSecondaryFilter.hh
+/// \brief Definition of the DMSSecondaryFilter class
+
+#ifndef DMSSecondaryFilter_h
+#define DMSSecondaryFilter_h 1
+
+#include "globals.hh"
+
+#include <set>
+#include <unordered_map>
+
+class G4ParticleDefinition;
+class G4LogicalVolume;
+
+/// Selection of the secondaries written by DMSSteppingAction, also used as
+/// the event trigger of DMSEventAction (an event is kept if any secondary
+/// passes the trigger selection).
+///
+/// The selection is set by name with /dms/record/particles, volumes and
+/// minEnergy. Names are resolved once per particle definition and logical
+/// volume and the decision is cached by pointer, so a rejected secondary
+/// costs one hash lookup. An empty name list accepts everything.
+/// One instance per thread, owned by DMSRunAction.
+
+class DMSSecondaryFilter
+{
+  public:
+    DMSSecondaryFilter();
+    ~DMSSecondaryFilter();
+
+    void SetParticles(const G4String& names);
+    void SetVolumes(const G4String& names);
+    void SetMinEnergy(G4double energy) { fMinEnergy = energy; }
+
+    // Drop the cached decisions; called when a run starts
+    void ClearCache();
+
+    inline G4bool AcceptVolume(const G4LogicalVolume* volume);
+    inline G4bool Accept(const G4ParticleDefinition* particle,
+                         G4double kineticEnergy);
+
+    G4bool IsActive() const
+    { return ! fParticleNames.empty() || ! fVolumeNames.empty() || fMinEnergy > 0.; }
+    void   Print(const G4String& what) const;
+
+  private:
+    G4bool Resolve(const G4ParticleDefinition* particle);
+    G4bool Resolve(const G4LogicalVolume* volume);
+
+    std::set<G4String> fParticleNames;
+    std::set<G4String> fVolumeNames;
+    G4double fMinEnergy;
+
+    std::unordered_map<const G4ParticleDefinition*, G4bool> fParticleCache;
+    std::unordered_map<const G4LogicalVolume*, G4bool>      fVolumeCache;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4bool DMSSecondaryFilter::AcceptVolume(const G4LogicalVolume* volume)
+{
+  if ( fVolumeNames.empty() ) return true;
+  auto it = fVolumeCache.find(volume);
+  if ( it != fVolumeCache.end() ) return it->second;
+  return Resolve(volume);
+}
+
+inline G4bool DMSSecondaryFilter::Accept(const G4ParticleDefinition* particle,
+                                         G4double kineticEnergy)
+{
+  if ( kineticEnergy < fMinEnergy ) return false;
+  if ( fParticleNames.empty() ) return true;
+  auto it = fParticleCache.find(particle);
+  if ( it != fParticleCache.end() ) return it->second;
+  return Resolve(particle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
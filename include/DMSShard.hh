@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSShard.hh
+/// \brief Definition of the DMSShard class
+
+#ifndef DMSShard_h
+#define DMSShard_h 1
+
+#include "globals.hh"
+
+class DMSRunAction;
+
+/// Splitting of a job into shards, set from the command line
+/// (--shard i/N, --events M, --seed S, --reduce).
+///
+/// A sharded job runs the slice [i*M/N, (i+1)*M/N) of the M events of the
+/// /dms/checkpoint/beamOn in its macro (or of --events M). The slice starts
+/// at its event number, so with per-event seeds (DMSEventSeeder) the N
+/// shards together simulate exactly the events of one unsharded job. The
+/// output files get the suffix _s<i>; instead of the mesh, nuclide and
+/// activation results, a shard writes its merged scorers into
+/// DMSScorers_s<i>.dmss. Running the same macro with --reduce sums the
+/// scorer files of all shards in place of the beamOn and writes the
+/// results for the total number of events; dms-merge sums the histograms.
+/// In dms-dump_cooling_mpi the ranks are the shards and the reduction is
+/// done in memory by DMSMPIReducer; rank 0 keeps the plain file names.
+
+class DMSShard
+{
+  public:
+    // Parse "i/N"; false for an invalid value
+    static G4bool SetShard(const G4String& value);
+    static void   SetJobEvents(G4int events) { fgJobEvents = events; }
+    static void   SetReduce(G4bool value)    { fgReduce = value; }
+    // dms-dump_cooling_mpi: every rank is a shard, see DMSMPIReducer
+    static void   SetMPIRank(G4int rank, G4int size);
+
+    static G4bool IsActive()   { return fgCount > 1; }
+    static G4bool IsReduce()   { return fgReduce; }
+    static G4bool IsMPI()      { return fgMPI && IsActive(); }
+    static G4int  GetIndex()   { return fgIndex; }
+    static G4int  GetCount()   { return fgCount; }
+
+    // Events of the whole job: --events, else the number given to beamOn
+    static G4int GetJobEvents(G4int nEvents)
+      { return ( fgJobEvents > 0 ) ? fgJobEvents : nEvents; }
+    // First event number and number of events of this shard
+    static void  GetRange(G4int jobEvents, G4int& firstEvent, G4int& nEvents);
+    // Suffix of the output files of this shard, empty for unsharded jobs
+    static G4String GetOutputSuffix();
+
+    // Write the merged scorers of this shard; called on the master after
+    // its last run
+    static G4bool WriteScorers(const DMSRunAction& runAction, G4int jobEvents,
+                               G4int firstEvent, G4int nEvents);
+    // Sum the scorer files of all shards into the master accumulables and
+    // write the results
+    static void Reduce(DMSRunAction& runAction, G4int jobEvents);
+
+  private:
+    static G4String GetScorerFileName(G4int index);
+
+    static G4int  fgIndex;
+    static G4int  fgCount;
+    static G4int  fgJobEvents;
+    static G4bool fgReduce;
+    static G4bool fgMPI;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,58 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSStackingAction.hh
+/// \brief Definition of the DMSStackingAction class
+
+#ifndef DMSStackingAction_h
+#define DMSStackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+class DMSEventAction;
+
+/// Stacking action class
+///
+/// Secondaries get their track ID only when they are stacked, after the
+/// step in which DMSSteppingAction buffered them. In the event layout this
+/// hands the IDs back to DMSEventAction; the classification is unchanged.
+
+class DMSStackingAction : public G4UserStackingAction
+{
+  public:
+    DMSStackingAction(DMSEventAction* eventAction);
+    virtual ~DMSStackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track);
+
+  private:
+    DMSEventAction* fEventAction;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
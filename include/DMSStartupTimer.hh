@@ -0,0 +1,139 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSStartupTimer.hh
+/// \brief Definition of the DMSStartupTimer class
+
+#ifndef DMSStartupTimer_h
+#define DMSStartupTimer_h 1
+
+#include "G4VStateDependent.hh"
+#include "G4VPhysicsConstructor.hh"
+#include "G4VProcess.hh"
+#include "globals.hh"
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+class G4ParticleDefinition;
+
+/// Wall time spent before the first run, printed by the master when the
+/// first run starts.
+///
+/// The phases follow the application states of the master: setup until
+/// /run/initialize, geometry (until DMSDetectorConstruction::Construct()
+/// returns), physics construction, then the physics tables built when the
+/// first run starts. The tables are timed per particle by DMSTableTimer, an
+/// inactive process that DMSTimingPhysics appends to every particle: its
+/// BuildPhysicsTable() is called after those of all other processes of the
+/// particle. The tables of the particles with high precision data (n, p,
+/// d, t, He3, alpha in QGSP_BIC_AllHP) are reported apart; they include
+/// the loading of the HP data.
+
+class DMSStartupTimer : public G4VStateDependent
+{
+  public:
+    static DMSStartupTimer* Instance();
+    virtual ~DMSStartupTimer() {}
+
+    // G4VStateDependent
+    virtual G4bool Notify(G4ApplicationState requestedState);
+
+    // Marks, master thread only
+    void GeometryDone();
+    void TablesPrepared();
+    void TableBuilt(const G4ParticleDefinition& particle);
+
+    // Time of the last building of the physics tables
+    G4double GetTablesSeconds() const
+      { return Seconds(fTablesStart, fLastTable); }
+
+    void Print() const;
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    DMSStartupTimer();
+    static G4double Seconds(Clock::time_point from, Clock::time_point to);
+
+    Clock::time_point fStart;
+    Clock::time_point fInitStart;
+    Clock::time_point fGeometryEnd;
+    Clock::time_point fInitEnd;
+    Clock::time_point fTablesStart;
+    Clock::time_point fLastTable;
+    Clock::time_point fRunStart;
+    std::vector<std::pair<G4String, G4double> > fTableTimes;
+    G4bool fPrinted;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Inactive process whose table methods mark the startup timer
+
+class DMSTableTimer : public G4VProcess
+{
+  public:
+    DMSTableTimer() : G4VProcess("DMSTableTimer", fUserDefined) {}
+    virtual ~DMSTableTimer() {}
+
+    virtual void PreparePhysicsTable(const G4ParticleDefinition&);
+    virtual void BuildPhysicsTable(const G4ParticleDefinition& particle);
+
+    // Never invoked, the process is not in the stepping loops
+    virtual G4double AlongStepGetPhysicalInteractionLength(const G4Track&,
+      G4double, G4double, G4double&, G4GPILSelection*) { return DBL_MAX; }
+    virtual G4double AtRestGetPhysicalInteractionLength(const G4Track&,
+      G4ForceCondition*) { return DBL_MAX; }
+    virtual G4double PostStepGetPhysicalInteractionLength(const G4Track&,
+      G4double, G4ForceCondition*) { return DBL_MAX; }
+    virtual G4VParticleChange* AlongStepDoIt(const G4Track&, const G4Step&)
+      { return 0; }
+    virtual G4VParticleChange* AtRestDoIt(const G4Track&, const G4Step&)
+      { return 0; }
+    virtual G4VParticleChange* PostStepDoIt(const G4Track&, const G4Step&)
+      { return 0; }
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Physics constructor adding DMSTableTimer to all particles, to be
+/// registered after the physics of the list
+
+class DMSTimingPhysics : public G4VPhysicsConstructor
+{
+  public:
+    DMSTimingPhysics() : G4VPhysicsConstructor("DMSTimingPhysics") {}
+    virtual ~DMSTimingPhysics() {}
+
+    virtual void ConstructParticle() {}
+    virtual void ConstructProcess();
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -34,22 +34,28 @@
 #include "globals.hh"
 
 class DMSEventAction;
+class DMSRunAction;
 
 class G4LogicalVolume;
 
 /// Stepping action class
-/// 
+///
+/// Evaluates the event trigger on the secondaries created in the step and
+/// appends those accepted by the /dms/record/ selection to the event buffer
+/// of DMSEventAction, which writes them at the end of the event.
 
 class DMSSteppingAction : public G4UserSteppingAction
 {
   public:
-    DMSSteppingAction();
+    DMSSteppingAction(DMSRunAction* runAction, DMSEventAction* eventAction);
     virtual ~DMSSteppingAction();
 
     // method from the base class
     virtual void UserSteppingAction(const G4Step*);
 
   private:
+    DMSRunAction*   fRunAction;
+    DMSEventAction* fEventAction;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
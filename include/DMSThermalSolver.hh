@@ -0,0 +1,141 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSThermalSolver.hh
+/// \brief Definition of the DMSThermalSolver class
+
+#ifndef DMSThermalSolver_h
+#define DMSThermalSolver_h 1
+
+#include "globals.hh"
+
+#include <map>
+#include <vector>
+
+class DMSEnergyMesh;
+class DMSThermalSolverMessenger;
+class G4LogicalVolume;
+
+/// Post-run heat conduction solver (/dms/thermal/ commands).
+///
+/// The merged Cartesian DMSEnergyMesh is used as the thermal grid: the
+/// deposited power of each voxel is the heat source and the material at
+/// the voxel centre, found by navigating the geometry, gives the thermal
+/// conductivity and the heat capacity. Materials below 10 mg/cm3 (vacuum,
+/// gases) are treated as insulators. The faces of the grid selected with
+/// /dms/thermal/cooledFaces are held at the coolant temperature, through a
+/// heat transfer coefficient if one is set; all other faces are adiabatic.
+///
+/// The finite volume equations are solved with red-black successive
+/// over-relaxation. The grid is padded with one ghost layer so that the
+/// sweep has no branches, and the z slabs are shared between threads that
+/// synchronise only between the red and the black half sweeps. The
+/// steady state is solved for the full beam power; with a non-zero
+/// /dms/thermal/duration the transient from a uniform coolant temperature
+/// is integrated with implicit (backward Euler) steps.
+///
+/// The master writes:
+///  - <fileName>_temperature.dmsm : temperature per voxel [K], steady state
+///                                  (or the end of the transient if the
+///                                  grid is not cooled), same layout as the
+///                                  mesh,
+///  - <fileName>_thermal.csv      : peak and mean temperature per layer,
+///  - <fileName>_thermal_history.csv : peak temperature per layer versus
+///                                  time for the transient.
+
+class DMSThermalSolver
+{
+  public:
+    DMSThermalSolver();
+    ~DMSThermalSolver();
+
+    void   SetActive(G4bool value) { fActive = value; }
+    G4bool IsActive() const        { return fActive; }
+    // Conductivity in W/(m K) and heat capacity in J/(kg K) of a material
+    void SetConductivity(const G4String& material, G4double value);
+    void SetHeatCapacity(const G4String& material, G4double value);
+    // Any of xmin xmax ymin ymax zmin zmax, or "none"
+    void SetCooledFaces(const G4String& faces);
+    void SetCoolantTemperature(G4double kelvin) { fCoolantTemperature = kelvin; }
+    // W/(m2 K), 0 holds the face at the coolant temperature
+    void SetHeatTransfer(G4double value)  { fHeatTransfer = value; }
+    void SetDuration(G4double duration)   { fDuration = duration; }
+    void SetTimeSteps(G4int steps)        { fTimeSteps = steps; }
+    void SetTolerance(G4double kelvin)    { fTolerance = kelvin; }
+    void SetMaxIterations(G4int value)    { fMaxIterations = value; }
+    // 0 uses all cores
+    void SetThreads(G4int value)          { fThreads = value; }
+
+    // Solve on the merged mesh and write the results; called on the master
+    void Solve(const DMSEnergyMesh& mesh);
+
+  private:
+    struct Properties {
+      G4double conductivity;
+      G4double heatCapacity;
+    };
+
+    G4bool BuildGrid(const DMSEnergyMesh& mesh);
+    // Set the diagonal for a time step (0 for the steady state)
+    void   SetTimeStep(G4double seconds);
+    // Relax to convergence, returns the number of iterations
+    G4int  Relax();
+    G4double Sweep(G4int color, G4int k0, G4int k1);
+    void   LayerTemperatures(std::vector<G4double>& peak,
+                             std::vector<G4double>& mean) const;
+    std::vector<float> Unpad() const;
+
+    DMSThermalSolverMessenger* fMessenger;
+    G4bool   fActive;
+    std::map<G4String, Properties> fProperties;
+    G4bool   fCooled[6];
+    G4double fCoolantTemperature;
+    G4double fHeatTransfer;
+    G4double fDuration;
+    G4int    fTimeSteps;
+    G4double fTolerance;
+    G4int    fMaxIterations;
+    G4int    fThreads;
+
+    // Padded grid, x fastest
+    G4int fN[3];
+    G4int fStride[3];
+    G4double fOmega;
+    std::vector<G4double> fT;
+    std::vector<G4double> fSource;      // W, plus the coolant and previous step terms
+    std::vector<G4double> fPower;       // W
+    std::vector<G4double> fCapacity;    // J/K
+    std::vector<G4double> fG[3];        // W/K, between p and p + stride
+    std::vector<G4double> fGBoundary;   // W/K, to the coolant
+    std::vector<G4double> fInvDiag;
+    std::vector<G4double> fRelax;       // omega, 0 outside of the solid
+    std::vector<G4int>    fLayer;       // index in fLayers, -1 outside
+    std::vector<const G4LogicalVolume*> fLayers;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
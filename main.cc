@@ -29,8 +29,21 @@
 
 #include "DMSDetectorConstruction.hh"
 #include "DMSActionInitialization.hh"
+#include "DMSCheckpoint.hh"
+#include "DMSEventSeeder.hh"
+#include "DMSShard.hh"
+#include "DMSStartupTimer.hh"
+#include "DMSPhysicsTableCache.hh"
+
+#ifdef DMS_WITH_MPI
+#include "G4MPImanager.hh"
+#endif
 
-#ifdef G4MULTITHREADED
+#include "G4Version.hh"
+#if G4VERSION_NUMBER >= 1070
+#include "G4RunManagerFactory.hh"
+#include "G4TaskRunManager.hh"
+#elif defined(G4MULTITHREADED)
 #include "G4MTRunManager.hh"
 #else
 #include "G4RunManager.hh"
@@ -40,32 +53,111 @@
 #include "G4VModularPhysicsList.hh"
 #include "QGSP_BIC_AllHP.hh"
 
+#ifndef DMS_HEADLESS
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
+#endif
 
 #include "Randomize.hh"
 
+#include <cstdlib>
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  // Start of the startup time breakdown
+  DMSStartupTimer::Instance();
+
+  // Command line:
+  //   [--shard i/N] [--events M] [--seed S] [--resume | --reduce]
+  //   [--headless] [--run-manager type] [--threads N] [--grainsize G]
+  //   [macro]
+  // --shard runs the slice i of N of the events of the macro (or of M),
+  // --reduce sums the scorers of all shards, see DMSShard; --resume
+  // continues the next /dms/checkpoint/beamOn from its checkpoint file;
+  // --headless runs the macro without creating the vis manager;
+  // --run-manager selects serial, mt (default) or tasking (or tbb), with
+  // N threads (default: all cores) and, for tasking, G tasks per thread
+  //
+  G4long seed = 1;
+  G4String runManagerType = "MT";
+  G4int nThreads = G4Threading::G4GetNumberOfCores();
+  G4int grainsize = 0;
+#ifdef DMS_HEADLESS
+  G4bool headless = true;
+#else
+  G4bool headless = false;
+#endif
+  G4String macro;
+  for ( G4int i = 1; i < argc; ++i ) {
+    G4String argument = argv[i];
+    if ( argument == "--resume" )                      DMSCheckpoint::SetResume(true);
+    else if ( argument == "--reduce" )                 DMSShard::SetReduce(true);
+    else if ( argument == "--headless" )               headless = true;
+    else if ( argument == "--events" && i + 1 < argc ) DMSShard::SetJobEvents(std::atoi(argv[++i]));
+    else if ( argument == "--seed" && i + 1 < argc )   seed = std::atol(argv[++i]);
+    else if ( argument == "--run-manager" && i + 1 < argc ) runManagerType = argv[++i];
+    else if ( argument == "--threads" && i + 1 < argc ) nThreads = std::atoi(argv[++i]);
+    else if ( argument == "--grainsize" && i + 1 < argc ) grainsize = std::atoi(argv[++i]);
+    else if ( argument == "--shard" && i + 1 < argc
+              && DMSShard::SetShard(argv[i + 1]) )     ++i;
+    else if ( argument[0] == '-' ) {
+      G4cerr << "Usage: " << argv[0] << " [--shard i/N] [--events M]"
+             << " [--seed S] [--resume | --reduce] [--headless]"
+             << " [--run-manager serial|mt|tasking|tbb] [--threads N]"
+             << " [--grainsize G] [macro]" << G4endl;
+      return 1;
+    }
+    else                                               macro = argument;
+  }
+
+#ifdef DMS_WITH_MPI
+  // Every rank runs its slice of the events of the macro as a shard;
+  // the options above are not passed on to G4MPImanager
+  G4MPImanager* g4MPI = new G4MPImanager(1, argv);
+  DMSShard::SetMPIRank(g4MPI->GetRank(), g4MPI->GetSize());
+  if ( macro.empty() ) {
+    G4cerr << "Usage: mpirun -np <ranks> " << argv[0] << " [--events M]"
+           << " [--seed S] macro" << G4endl;
+    delete g4MPI;
+    return 1;
+  }
+#endif
+
+  // Detect interactive mode (if no macro) and define UI session
   //
+  if ( headless && macro.empty() ) {
+    G4cerr << "The headless mode needs a macro." << G4endl;
+    return 1;
+  }
+#ifndef DMS_HEADLESS
   G4UIExecutive* ui = 0;
-  if ( argc == 1 ) {
+  if ( macro.empty() ) {
     ui = new G4UIExecutive(argc, argv);
   }
+#endif
 
   // Optionally: choose a different Random engine
   // G4Random::setTheEngine(new CLHEP::MTwistEngine);
-  G4long seed = 1;
   G4Random::setTheSeed(seed);
-
-  // Construct the default run manager
+  // Every event is seeded from (seed, event number), see DMSEventSeeder,
+  // so the results do not depend on the number of threads
+  DMSEventSeeder::SetSeed(seed);
+
+  // Construct the run manager. The tasking one hands out the events in
+  // tasks to a thread pool whose idle threads steal queued tasks, which
+  // balances the very uneven event times; /run/eventModulo sets the events
+  // a thread takes at a time in both the mt and tasking modes
   //
-#ifdef G4MULTITHREADED
+#if G4VERSION_NUMBER >= 1070
+  G4RunManager* runManager = G4RunManagerFactory::CreateRunManager(
+    G4RunManagerFactory::GetType(runManagerType));
+  G4TaskRunManager* taskRunManager = dynamic_cast<G4TaskRunManager*>(runManager);
+  if ( taskRunManager && grainsize > 0 ) taskRunManager->SetGrainsize(grainsize);
+  runManager->SetNumberOfThreads(nThreads);
+#elif defined(G4MULTITHREADED)
   G4MTRunManager* runManager = new G4MTRunManager;
-  G4int nThreads = G4Threading::G4GetNumberOfCores();
   runManager->SetNumberOfThreads(nThreads);
 #else
   G4RunManager* runManager = new G4RunManager;
@@ -76,45 +168,60 @@ int main(int argc,char** argv)
   // Detector construction
   runManager->SetUserInitialization(new DMSDetectorConstruction());
 
-  // Physics list
+  // Physics list; DMSTimingPhysics times the physics tables
   G4VModularPhysicsList* physicsList = new QGSP_BIC_AllHP;
   physicsList->SetVerboseLevel(0);
+  physicsList->RegisterPhysics(new DMSTimingPhysics);
   runManager->SetUserInitialization(physicsList);
+  // Retrieves the physics tables from the previous jobs or caches them
+  DMSPhysicsTableCache* physicsCache = new DMSPhysicsTableCache(physicsList);
 
   // User action initialization
   runManager->SetUserInitialization(new DMSActionInitialization());
 
-  // Initialize visualization
+  // Initialize visualization, except in the headless mode
   //
-  G4VisManager* visManager = new G4VisExecutive;
-  // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
-  // G4VisManager* visManager = new G4VisExecutive("Quiet");
-  visManager->Initialize();
+#ifndef DMS_HEADLESS
+  G4VisManager* visManager = 0;
+  if ( ! headless ) {
+    visManager = new G4VisExecutive;
+    // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
+    // G4VisManager* visManager = new G4VisExecutive("Quiet");
+    visManager->Initialize();
+  }
+#endif
 
   // Get the pointer to the User Interface manager
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
   // Process macro or start UI session
   //
-  if ( ! ui ) {
+  if ( ! macro.empty() ) {
     // batch mode
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+    UImanager->ApplyCommand(command+macro);
   }
+#ifndef DMS_HEADLESS
   else { 
     // interactive mode
     UImanager->ApplyCommand("/control/execute init_vis.mac");
     ui->SessionStart();
     delete ui;
   }
+#endif
 
   // Job termination
   // Free the store: user actions, physics_list and detector_description are
   // owned and deleted by the run manager, so they should not be deleted
   // in the main() program !
 
+#ifndef DMS_HEADLESS
   delete visManager;
+#endif
+  delete physicsCache;
+#ifdef DMS_WITH_MPI
+  delete g4MPI;
+#endif
   delete runManager;
 }
 
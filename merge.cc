@@ -0,0 +1,663 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file merge.cc
+/// \brief Main program of dms-merge, which combines DMS output files
+///
+/// Usage: dms-merge [-j nThreads] [-r] [-s] -o output input ...
+///
+/// An input is either a file name or the base name of a run written with
+/// /dms/output/perThreadFiles, e.g. DMSNeutronEmission, which expands to
+/// DMSNeutronEmission.root and DMSNeutronEmission_t<N>.root, and to the
+/// files of every run DMSNeutronEmission_c<K> of a /dms/checkpoint/beamOn
+/// and of every shard DMSNeutronEmission_s<I> of a sharded job.
+/// The DMSDumpSim ntuples are concatenated with the layout found in the
+/// DMSSchema ntuple, the codes of the DMSDictionary of every input are
+/// renumbered by name into one dictionary, as each process numbers the
+/// names in the order it meets them, and the histograms are summed. The
+/// DMSEvents index of the event layout is carried along; the rows of an
+/// event are never split. With -r only the histograms are reduced. The
+/// inputs are read by nThreads reader threads while the main thread writes
+/// the output. With -s the events are written in event ID order: up to
+/// nThreads inputs are read at once, each by its own reader, and the
+/// writer takes the lowest event ID of all of them; more inputs are merged
+/// in batches of nThreads into temporary files, which are merged in turn.
+
+#include "DMSOutputSchema.hh"
+
+#include "G4Threading.hh"
+#include "g4root.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <tuple>
+
+namespace
+{
+  // (kind, code) of an input -> code of the output
+  typedef std::map<std::pair<G4int, G4int>, G4int> CodeMap;
+
+  // Rows per chunk handed from the readers to the writer
+  const size_t kChunkRows = 10000;
+  // Chunks kept in memory per reader thread
+  const size_t kChunksPerReader = 4;
+
+  /// Column-wise block of ntuple rows; numeric columns are carried as
+  /// doubles, which is exact for the int codes. In the event layout it
+  /// holds complete events, listed as (eventID, nSecondaries).
+  struct Chunk
+  {
+    std::vector<std::vector<G4double>> numbers;
+    std::vector<std::vector<G4String>> strings;
+    std::vector<std::pair<G4int, G4int>> events;
+    size_t rows = 0;
+  };
+
+  /// Bounded queue between the reader threads and the writer
+  class ChunkQueue
+  {
+    public:
+      ChunkQueue(size_t capacity, G4int producers)
+      : fCapacity(capacity), fProducers(producers) {}
+
+      void Push(Chunk&& chunk)
+      {
+        std::unique_lock<std::mutex> lock(fMutex);
+        fNotFull.wait(lock, [this] { return fChunks.size() < fCapacity; });
+        fChunks.push_back(std::move(chunk));
+        fNotEmpty.notify_one();
+      }
+
+      G4bool Pop(Chunk& chunk)
+      {
+        std::unique_lock<std::mutex> lock(fMutex);
+        fNotEmpty.wait(lock, [this] { return ! fChunks.empty() || fProducers == 0; });
+        if ( fChunks.empty() ) return false;
+        chunk = std::move(fChunks.front());
+        fChunks.pop_front();
+        fNotFull.notify_one();
+        return true;
+      }
+
+      void ProducerDone()
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        --fProducers;
+        fNotEmpty.notify_all();
+      }
+
+    private:
+      std::mutex fMutex;
+      std::condition_variable fNotFull;
+      std::condition_variable fNotEmpty;
+      std::deque<Chunk> fChunks;
+      size_t fCapacity;
+      G4int fProducers;
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PrintUsage()
+  {
+    G4cerr << "Usage: dms-merge [-j nThreads] [-r] [-s] -o output input ..." << G4endl
+           << "  -j nThreads : number of reader threads (default: all cores)" << G4endl
+           << "  -r          : reduce histograms only, skip the ntuples" << G4endl
+           << "  -s          : write the events in event ID order (event layout)" << G4endl
+           << "  -o output   : output file name" << G4endl
+           << "  input       : file name, or base name of per-thread files" << G4endl;
+  }
+
+  G4bool FileExists(const G4String& fileName)
+  {
+    std::ifstream file(fileName);
+    return file.good();
+  }
+
+  // Expand a base name into the master file, the per-thread files, the
+  // files of the runs of a checkpointed sequence and the files of the shards
+  void AddInput(const G4String& name, std::vector<G4String>& inputs)
+  {
+    if ( name.size() > 5 && name.substr(name.size() - 5) == ".root" ) {
+      inputs.push_back(name);
+      return;
+    }
+    if ( FileExists(name + ".root") ) inputs.push_back(name + ".root");
+    for ( G4int thread = 0; ; ++thread ) {
+      G4String fileName = name + "_t" + std::to_string(thread) + ".root";
+      if ( ! FileExists(fileName) ) break;
+      inputs.push_back(fileName);
+    }
+    for ( G4int run = 0; ; ++run ) {
+      G4String runName = name + "_c" + std::to_string(run);
+      if ( ! FileExists(runName + ".root")
+           && ! FileExists(runName + "_t0.root") ) break;
+      AddInput(runName, inputs);
+    }
+    for ( G4int shard = 0; ; ++shard ) {
+      G4String shardName = name + "_s" + std::to_string(shard);
+      if ( ! FileExists(shardName + ".root")
+           && ! FileExists(shardName + "_t0.root")
+           && ! FileExists(shardName + "_c0.root")
+           && ! FileExists(shardName + "_c0_t0.root") ) break;
+      AddInput(shardName, inputs);
+    }
+  }
+
+  template <class Axis>
+  std::vector<G4double> GetEdges(const Axis& axis)
+  {
+    if ( ! axis.is_fixed_binning() ) return axis.edges();
+    std::vector<G4double> edges;
+    G4double width = ( axis.upper_edge() - axis.lower_edge() ) / axis.bins();
+    for ( unsigned int i = 0; i <= axis.bins(); ++i ) {
+      edges.push_back(axis.lower_edge() + i * width);
+    }
+    return edges;
+  }
+
+  // File of the given pass of the ordered merge
+  G4String TemporaryName(const G4String& output, G4int pass, size_t batch)
+  {
+    G4String base = output;
+    if ( base.size() > 5 && base.substr(base.size() - 5) == ".root" ) {
+      base = base.substr(0, base.size() - 5);
+    }
+    return base + "_merge" + std::to_string(pass) + "_"
+           + std::to_string(batch) + ".root";
+  }
+
+  G4bool SameLayout(const std::map<G4int, DMSNtupleColumn>& first,
+                    const std::map<G4int, DMSNtupleColumn>& second)
+  {
+    if ( first.size() != second.size() ) return false;
+    for ( const auto& entry : first ) {
+      auto column = second.find(entry.first);
+      if ( column == second.end() || column->second.name != entry.second.name
+           || column->second.type != entry.second.type ) return false;
+    }
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  // Reader thread: stream the secondary ntuple of each assigned file
+  void ReadNtuples(G4int threadId,
+                   const std::vector<G4String>& inputs,
+                   std::atomic<size_t>& nextInput,
+                   const std::vector<DMSNtupleColumn>& columns,
+                   const std::map<G4String, CodeMap>& codeMaps,
+                   ChunkQueue& queue)
+  {
+    // Each reader thread gets its own (worker) instance of the reader
+    G4Threading::G4SetThreadId(threadId);
+    auto reader = G4AnalysisReader::Instance();
+    reader->SetVerboseLevel(0);
+
+    struct Value { G4int i; G4float f; G4double d; G4String s; };
+    std::vector<Value> values(columns.size());
+    std::vector<G4int> kinds;
+    for ( const auto& column : columns ) {
+      kinds.push_back(DMSOutputSchema::GetCodeKind(column.name));
+    }
+
+    for ( size_t input = nextInput++; input < inputs.size(); input = nextInput++ ) {
+      G4int id = reader->GetNtuple(DMSOutputSchema::GetSecondaryNtupleName(),
+                                   inputs[input]);
+      if ( id < 0 ) continue;
+      auto codeMap = codeMaps.find(inputs[input]);
+
+      for ( size_t c = 0; c < columns.size(); ++c ) {
+        switch ( columns[c].type ) {
+          case 'I': reader->SetNtupleIColumn(id, columns[c].name, values[c].i); break;
+          case 'F': reader->SetNtupleFColumn(id, columns[c].name, values[c].f); break;
+          case 'D': reader->SetNtupleDColumn(id, columns[c].name, values[c].d); break;
+          case 'S': reader->SetNtupleSColumn(id, columns[c].name, values[c].s); break;
+        }
+      }
+
+      // Event index of the event layout, read before the rows
+      std::vector<std::pair<G4int, G4int>> events;
+      G4int eventsId = reader->GetNtuple(DMSOutputSchema::GetEventsNtupleName(),
+                                         inputs[input]);
+      if ( eventsId >= 0 ) {
+        G4int eventID, nSecondaries;
+        reader->SetNtupleIColumn(eventsId, "eventID", eventID);
+        reader->SetNtupleIColumn(eventsId, "nSecondaries", nSecondaries);
+        while ( reader->GetNtupleRow(eventsId) ) {
+          events.push_back(std::make_pair(eventID, nSecondaries));
+        }
+      }
+
+      Chunk chunk;
+      chunk.numbers.resize(columns.size());
+      chunk.strings.resize(columns.size());
+      auto recode = [&](size_t c, G4int value) {
+        if ( kinds[c] < 0 || codeMap == codeMaps.end() ) return value;
+        auto code = codeMap->second.find(std::make_pair(kinds[c], value));
+        return code != codeMap->second.end() ? code->second : value;
+      };
+      auto readRow = [&]() {
+        if ( ! reader->GetNtupleRow(id) ) return false;
+        for ( size_t c = 0; c < columns.size(); ++c ) {
+          switch ( columns[c].type ) {
+            case 'I': chunk.numbers[c].push_back(recode(c, values[c].i)); break;
+            case 'F': chunk.numbers[c].push_back(values[c].f); break;
+            case 'D': chunk.numbers[c].push_back(values[c].d); break;
+            case 'S': chunk.strings[c].push_back(values[c].s); break;
+          }
+        }
+        ++chunk.rows;
+        return true;
+      };
+      auto pushChunk = [&]() {
+        queue.Push(std::move(chunk));
+        chunk = Chunk();
+        chunk.numbers.resize(columns.size());
+        chunk.strings.resize(columns.size());
+      };
+
+      // Chunks end on event boundaries
+      for ( const auto& event : events ) {
+        G4int row = 0;
+        while ( row < event.second && readRow() ) ++row;
+        if ( row < event.second ) break;
+        chunk.events.push_back(event);
+        if ( chunk.rows >= kChunkRows ) pushChunk();
+      }
+      // Rows of the flat layout, or beyond the event index
+      while ( readRow() ) {
+        if ( chunk.rows >= kChunkRows && events.empty() ) pushChunk();
+      }
+      if ( chunk.rows || ! chunk.events.empty() ) queue.Push(std::move(chunk));
+      G4cout << "dms-merge: read " << inputs[input] << G4endl;
+    }
+    queue.ProducerDone();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  G4int nThreads = G4Threading::G4GetNumberOfCores();
+  G4bool reduceOnly = false;
+  G4bool ordered = false;
+  G4String output;
+  std::vector<G4String> inputs;
+
+  for ( G4int i = 1; i < argc; ++i ) {
+    G4String arg = argv[i];
+    if ( arg == "-j" && i + 1 < argc )      nThreads = std::atoi(argv[++i]);
+    else if ( arg == "-o" && i + 1 < argc ) output = argv[++i];
+    else if ( arg == "-r" )                 reduceOnly = true;
+    else if ( arg == "-s" )                 ordered = true;
+    else if ( arg[0] == '-' )               { PrintUsage(); return 1; }
+    else                                    AddInput(arg, inputs);
+  }
+  if ( output.empty() || inputs.empty() ) {
+    PrintUsage();
+    return 1;
+  }
+  if ( std::find(inputs.begin(), inputs.end(), output) != inputs.end() ) {
+    G4cerr << "dms-merge: the output must not be one of the inputs" << G4endl;
+    return 1;
+  }
+  nThreads = std::max(1, std::min<G4int>(nThreads, inputs.size()));
+
+  // Histograms and dictionaries are small, they are read by the main thread
+  auto reader = G4AnalysisReader::Instance();
+  reader->SetVerboseLevel(0);
+
+  std::vector<std::unique_ptr<tools::histo::h1d>> h1Sums;
+  for ( const auto& name : DMSOutputSchema::GetH1Names() ) {
+    std::unique_ptr<tools::histo::h1d> sum;
+    for ( const auto& input : inputs ) {
+      G4int id = reader->ReadH1(name, input);
+      if ( id < 0 ) continue;
+      auto h1 = reader->GetH1(id);
+      if ( ! sum ) sum.reset(new tools::histo::h1d(*h1));
+      else sum->add(*h1);
+    }
+    h1Sums.push_back(std::move(sum));
+  }
+
+  std::vector<std::unique_ptr<tools::histo::h2d>> h2Sums;
+  for ( const auto& name : DMSOutputSchema::GetH2Names() ) {
+    std::unique_ptr<tools::histo::h2d> sum;
+    for ( const auto& input : inputs ) {
+      G4int id = reader->ReadH2(name, input);
+      if ( id < 0 ) continue;
+      auto h2 = reader->GetH2(id);
+      if ( ! sum ) sum.reset(new tools::histo::h2d(*h2));
+      else sum->add(*h2);
+    }
+    h2Sums.push_back(std::move(sum));
+  }
+
+  G4bool hasNtuple = false;
+  G4bool hasEvents = false;
+  G4bool useCodes = false;
+  // Output dictionary, the codes numbered by kind in the order of the
+  // inputs, and the renumbering of the codes of every input
+  std::vector<std::tuple<G4int, G4int, G4String>> dictionary;
+  std::map<std::pair<G4int, G4String>, G4int> outputCodes;
+  std::map<G4int, G4int> nextCode;
+  std::map<G4String, CodeMap> codeMaps;
+  std::map<G4int, DMSNtupleColumn> schema;
+  G4String schemaInput;
+  if ( ! reduceOnly ) {
+    G4int kind, code;
+    G4String name;
+    for ( const auto& input : inputs ) {
+      if ( reader->GetNtuple(DMSOutputSchema::GetSecondaryNtupleName(), input) >= 0 ) {
+        hasNtuple = true;
+      }
+      if ( reader->GetNtuple(DMSOutputSchema::GetEventsNtupleName(), input) >= 0 ) {
+        hasEvents = true;
+      }
+      // All inputs must have the layout of the first one; a master file
+      // of per-thread files holds no rows
+      G4int id = reader->GetNtuple(DMSOutputSchema::GetSchemaNtupleName(), input);
+      if ( id >= 0 ) {
+        G4int index, type;
+        std::map<G4int, DMSNtupleColumn> inputSchema;
+        reader->SetNtupleIColumn(id, "index", index);
+        reader->SetNtupleSColumn(id, "column", name);
+        reader->SetNtupleIColumn(id, "type", type);
+        while ( reader->GetNtupleRow(id) ) {
+          inputSchema[index] = { name, char(type) };
+        }
+        if ( schema.empty() ) {
+          schema = inputSchema;
+          schemaInput = input;
+        }
+        else if ( ! inputSchema.empty() && ! SameLayout(schema, inputSchema) ) {
+          G4cerr << "dms-merge: " << input << " has another DMSDumpSim layout"
+                 << " (/dms/record/ columns) than " << schemaInput << G4endl;
+          return 1;
+        }
+      }
+      id = reader->GetNtuple(DMSOutputSchema::GetDictionaryNtupleName(), input);
+      if ( id < 0 ) continue;
+      useCodes = true;
+      reader->SetNtupleIColumn(id, "kind", kind);
+      reader->SetNtupleIColumn(id, "code", code);
+      reader->SetNtupleSColumn(id, "name", name);
+      CodeMap& codeMap = codeMaps[input];
+      while ( reader->GetNtupleRow(id) ) {
+        const auto key = std::make_pair(kind, name);
+        auto outputCode = outputCodes.find(key);
+        if ( outputCode == outputCodes.end() ) {
+          outputCode = outputCodes.insert(std::make_pair(key, nextCode[kind]++)).first;
+          dictionary.push_back(std::make_tuple(kind, outputCode->second, name));
+        }
+        codeMap[std::make_pair(kind, code)] = outputCode->second;
+      }
+    }
+  }
+
+  if ( ordered && hasNtuple && ! hasEvents ) {
+    G4cerr << "dms-merge: -s needs the event layout (/dms/record/layout event)"
+           << G4endl;
+    return 1;
+  }
+
+  // Book the output
+  auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->SetVerboseLevel(1);
+  analysisManager->SetFileName(output);
+
+  // Files written before DMSSchema existed hold all kinematics as doubles
+  std::vector<DMSNtupleColumn> columns;
+  for ( const auto& entry : schema ) columns.push_back(entry.second);
+  if ( columns.empty() ) {
+    columns = DMSOutputSchema::GetSecondaryColumns(useCodes,
+                                                   DMSOutputSchema::GetAllKinematics());
+  }
+
+  G4int dictionaryId = -1;
+  G4int schemaId = -1;
+  G4int eventsId = -1;
+  if ( hasNtuple ) {
+    DMSOutputSchema::CreateNtuple(DMSOutputSchema::GetSecondaryNtupleName(),
+                                  "DMS Dump Simulation", columns);
+    if ( useCodes ) {
+      dictionaryId
+        = DMSOutputSchema::CreateNtuple(DMSOutputSchema::GetDictionaryNtupleName(),
+                                        "DMS name dictionary",
+                                        DMSOutputSchema::GetDictionaryColumns());
+    }
+    schemaId = DMSOutputSchema::CreateNtuple(DMSOutputSchema::GetSchemaNtupleName(),
+                                             "DMS secondary ntuple layout",
+                                             DMSOutputSchema::GetSchemaColumns());
+    if ( hasEvents ) {
+      eventsId = DMSOutputSchema::CreateNtuple(DMSOutputSchema::GetEventsNtupleName(),
+                                               "DMS event index",
+                                               DMSOutputSchema::GetEventColumns());
+    }
+  }
+
+  const auto& h1Names = DMSOutputSchema::GetH1Names();
+  std::vector<G4int> h1Ids(h1Sums.size(), -1);
+  for ( size_t i = 0; i < h1Sums.size(); ++i ) {
+    if ( ! h1Sums[i] ) continue;
+    h1Ids[i] = analysisManager->CreateH1(h1Names[i], h1Sums[i]->title(),
+                                         GetEdges(h1Sums[i]->axis()));
+  }
+  const auto& h2Names = DMSOutputSchema::GetH2Names();
+  std::vector<G4int> h2Ids(h2Sums.size(), -1);
+  for ( size_t i = 0; i < h2Sums.size(); ++i ) {
+    if ( ! h2Sums[i] ) continue;
+    h2Ids[i] = analysisManager->CreateH2(h2Names[i], h2Sums[i]->title(),
+                                         GetEdges(h2Sums[i]->axis_x()),
+                                         GetEdges(h2Sums[i]->axis_y()));
+  }
+
+  size_t nRows = 0;
+  auto writeRows = [&](const Chunk& chunk, size_t first, size_t count) {
+    for ( size_t row = first; row < first + count; ++row ) {
+      for ( size_t c = 0; c < columns.size(); ++c ) {
+        switch ( columns[c].type ) {
+          case 'I': analysisManager->FillNtupleIColumn(0, c, G4int(chunk.numbers[c][row])); break;
+          case 'F': analysisManager->FillNtupleFColumn(0, c, G4float(chunk.numbers[c][row])); break;
+          case 'D': analysisManager->FillNtupleDColumn(0, c, chunk.numbers[c][row]); break;
+          case 'S': analysisManager->FillNtupleSColumn(0, c, chunk.strings[c][row]); break;
+        }
+      }
+      analysisManager->AddNtupleRow(0);
+    }
+    nRows += count;
+  };
+  auto writeEvent = [&](const std::pair<G4int, G4int>& event) {
+    analysisManager->FillNtupleIColumn(eventsId, 0, event.first);
+    analysisManager->FillNtupleIColumn(eventsId, 1, event.second);
+    analysisManager->AddNtupleRow(eventsId);
+  };
+
+  // Write the events of the files in event ID order. Every file holds its
+  // events in increasing event ID, so a merge of the heads of the files
+  // gives the global order; every file has its own reader.
+  auto mergeOrdered = [&](const std::vector<G4String>& files,
+                          const std::map<G4String, CodeMap>& fileCodeMaps) {
+    struct Cursor
+    {
+      std::vector<G4String> input;
+      std::atomic<size_t> nextInput;
+      std::unique_ptr<ChunkQueue> queue;
+      Chunk chunk;
+      size_t event = 0;
+      size_t row = 0;
+    };
+    std::vector<std::unique_ptr<Cursor>> cursors;
+    std::vector<std::thread> readers;
+    for ( size_t i = 0; i < files.size(); ++i ) {
+      cursors.emplace_back(new Cursor);
+      Cursor& cursor = *cursors.back();
+      cursor.input.push_back(files[i]);
+      cursor.nextInput = 0;
+      cursor.queue.reset(new ChunkQueue(kChunksPerReader, 1));
+      readers.emplace_back(ReadNtuples, G4int(i), std::cref(cursor.input),
+                           std::ref(cursor.nextInput), std::cref(columns),
+                           std::cref(fileCodeMaps), std::ref(*cursor.queue));
+    }
+
+    // Move the cursor to its next event, false at the end of its input
+    auto advance = [&](Cursor& cursor) {
+      while ( cursor.event >= cursor.chunk.events.size() ) {
+        if ( ! cursor.queue->Pop(cursor.chunk) ) return false;
+        cursor.event = 0;
+        cursor.row = 0;
+      }
+      return true;
+    };
+
+    typedef std::pair<G4int, size_t> Head;  // event ID, input
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for ( size_t i = 0; i < cursors.size(); ++i ) {
+      if ( advance(*cursors[i]) ) {
+        heads.push(Head(cursors[i]->chunk.events[0].first, i));
+      }
+    }
+    while ( ! heads.empty() ) {
+      const size_t input = heads.top().second;
+      Cursor& cursor = *cursors[input];
+      heads.pop();
+      const auto event = cursor.chunk.events[cursor.event];
+      writeRows(cursor.chunk, cursor.row, event.second);
+      writeEvent(event);
+      cursor.row += event.second;
+      ++cursor.event;
+      if ( advance(cursor) ) {
+        heads.push(Head(cursor.chunk.events[cursor.event].first, input));
+      }
+    }
+    for ( auto& thread : readers ) thread.join();
+  };
+
+  // The ordered merge reads at most nThreads files at once: larger sets
+  // are merged in batches into temporary files, whose codes are already
+  // those of the output, until nThreads files are left; a batch has at
+  // least two files, so that every pass reduces their number
+  const size_t batchSize = std::max<size_t>(nThreads, 2);
+  std::vector<G4String> orderedInputs = inputs;
+  std::vector<G4String> temporaries;
+  const std::map<G4String, CodeMap> noCodeMaps;
+  if ( hasNtuple && ordered ) {
+    for ( G4int pass = 0; orderedInputs.size() > batchSize; ++pass ) {
+      std::vector<G4String> merged;
+      const std::map<G4String, CodeMap>& passCodeMaps
+        = ( pass == 0 ) ? codeMaps : noCodeMaps;
+      for ( size_t first = 0; first < orderedInputs.size(); first += batchSize ) {
+        const size_t last = std::min(first + batchSize, orderedInputs.size());
+        const std::vector<G4String> batch(orderedInputs.begin() + first,
+                                          orderedInputs.begin() + last);
+        const G4String fileName = TemporaryName(output, pass, first / batchSize);
+        analysisManager->SetFileName(fileName);
+        if ( ! analysisManager->OpenFile() ) return 1;
+        mergeOrdered(batch, passCodeMaps);
+        analysisManager->Write();
+        analysisManager->CloseFile();
+        merged.push_back(fileName);
+      }
+      // The temporary files of the previous pass are merged
+      for ( const auto& fileName : temporaries ) std::remove(fileName.c_str());
+      temporaries = merged;
+      orderedInputs = merged;
+    }
+    G4cout << "dms-merge: " << inputs.size() << " files merged into "
+           << orderedInputs.size() << " temporary files" << G4endl;
+  }
+
+  // The histograms of the output, after the temporary files
+  for ( size_t i = 0; i < h1Sums.size(); ++i ) {
+    if ( h1Sums[i] ) analysisManager->GetH1(h1Ids[i])->add(*h1Sums[i]);
+  }
+  for ( size_t i = 0; i < h2Sums.size(); ++i ) {
+    if ( h2Sums[i] ) analysisManager->GetH2(h2Ids[i])->add(*h2Sums[i]);
+  }
+
+  analysisManager->SetFileName(output);
+  if ( ! analysisManager->OpenFile() ) return 1;
+
+  // Concatenate the secondary ntuples: readers in parallel, one writer
+  nRows = 0;
+  if ( hasNtuple ) {
+    if ( ! ordered ) {
+      ChunkQueue queue(nThreads * kChunksPerReader, nThreads);
+      std::atomic<size_t> nextInput(0);
+      std::vector<std::thread> readers;
+      for ( G4int i = 0; i < nThreads; ++i ) {
+        readers.emplace_back(ReadNtuples, i, std::cref(inputs), std::ref(nextInput),
+                             std::cref(columns), std::cref(codeMaps),
+                             std::ref(queue));
+      }
+
+      Chunk chunk;
+      while ( queue.Pop(chunk) ) {
+        writeRows(chunk, 0, chunk.rows);
+        for ( const auto& event : chunk.events ) writeEvent(event);
+      }
+      for ( auto& thread : readers ) thread.join();
+    }
+    else {
+      mergeOrdered(orderedInputs, temporaries.empty() ? codeMaps : noCodeMaps);
+      for ( const auto& fileName : temporaries ) std::remove(fileName.c_str());
+    }
+
+    for ( const auto& entry : dictionary ) {
+      analysisManager->FillNtupleIColumn(dictionaryId, 0, std::get<0>(entry));
+      analysisManager->FillNtupleIColumn(dictionaryId, 1, std::get<1>(entry));
+      analysisManager->FillNtupleSColumn(dictionaryId, 2, std::get<2>(entry));
+      analysisManager->AddNtupleRow(dictionaryId);
+    }
+    for ( size_t index = 0; index < columns.size(); ++index ) {
+      analysisManager->FillNtupleIColumn(schemaId, 0, index);
+      analysisManager->FillNtupleSColumn(schemaId, 1, columns[index].name);
+      analysisManager->FillNtupleIColumn(schemaId, 2, columns[index].type);
+      analysisManager->AddNtupleRow(schemaId);
+    }
+  }
+
+  analysisManager->Write();
+  analysisManager->CloseFile();
+
+  G4cout << "dms-merge: wrote " << nRows << " rows from " << inputs.size()
+         << " files into " << output << G4endl;
+
+  delete analysisManager;
+  return 0;
+}
@@ -32,6 +32,7 @@
 #include "DMSRunAction.hh"
 #include "DMSEventAction.hh"
 #include "DMSSteppingAction.hh"
+#include "DMSStackingAction.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -64,7 +65,8 @@ void DMSActionInitialization::Build() const
   DMSEventAction* eventAction = new DMSEventAction(runAction);
   SetUserAction(eventAction);
 
-  SetUserAction(new DMSSteppingAction());
+  SetUserAction(new DMSSteppingAction(runAction, eventAction));
+  SetUserAction(new DMSStackingAction(eventAction));
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,438 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSActivationSolver.cc
+/// \brief Implementation of the DMSActivationSolver class
+
+#include "DMSActivationSolver.hh"
+#include "DMSActivationSolverMessenger.hh"
+#include "DMSNuclideInventory.hh"
+#include "DMSDetectorConstruction.hh"
+
+#include "G4RadioactiveDecay.hh"
+#include "G4DecayTable.hh"
+#include "G4VDecayChannel.hh"
+#include "G4IonTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4Timer.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+
+namespace {
+  // Shorter lived nuclides decay promptly into their daughters
+  const G4double kPromptLifetime = 1.*us;
+  const G4int    kMaxDepth = 64;
+  // Minimum relative separation of the decay constants
+  const G4double kSeparation = 1.e-6;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSActivationSolver::DMSActivationSolver()
+: fMessenger(0),
+  fDecay(0),
+  fActive(false),
+  fBeamPower(1.),
+  fIrradiationTimes(),
+  fCoolingTimes(),
+  fMinFraction(1.e-3),
+  fFileName("DMSActivation")
+{
+  fMessenger = new DMSActivationSolverMessenger(this);
+  fIrradiationTimes = { 1.*86400.*s, 30.*86400.*s, 365.*86400.*s };
+  // Up to 10 years
+  SetCoolingRange(1.*s, 3650.*86400.*s, 81);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSActivationSolver::~DMSActivationSolver()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSActivationSolver::SetCoolingRange(G4double first, G4double last, G4int n)
+{
+  fCoolingTimes.assign(1, 0.);
+  for ( G4int i = 0; i < n; ++i ) {
+    G4double fraction = n > 1 ? G4double(i) / ( n - 1 ) : 0.;
+    fCoolingTimes.push_back(first * std::pow(last / first, fraction));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSActivationSolver::IsStable(const G4ParticleDefinition* definition) const
+{
+  if ( definition->GetPDGStable() || definition->GetPDGLifeTime() < 0. ) return true;
+  G4DecayTable* table = fDecay->GetDecayTable(definition);
+  return ! table || table->entries() == 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSActivationSolver::Resolve(const G4ParticleDefinition* definition,
+                                  G4double weight,
+                                  std::map<G4int, G4double>& yields,
+                                  G4double& energy, G4int depth)
+{
+  if ( depth > kMaxDepth || IsStable(definition) ) return;
+  if ( definition->GetPDGLifeTime() >= kPromptLifetime ) {
+    yields[AddNode(definition)] += weight;
+    return;
+  }
+
+  // Prompt decay: pass the weight on to the daughters
+  G4DecayTable* table = fDecay->GetDecayTable(definition);
+  G4double total = 0.;
+  for ( G4int i = 0; i < table->entries(); ++i ) {
+    total += table->GetDecayChannel(i)->GetBR();
+  }
+  if ( total <= 0. ) return;
+  for ( G4int i = 0; i < table->entries(); ++i ) {
+    G4VDecayChannel* channel = table->GetDecayChannel(i);
+    const G4double branch = weight * channel->GetBR() / total;
+    G4double q = definition->GetPDGMass();
+    for ( G4int j = 0; j < channel->GetNumberOfDaughters(); ++j ) {
+      q -= channel->GetDaughter(j)->GetPDGMass();
+    }
+    energy += branch * std::max(q, 0.) / MeV;
+    for ( G4int j = 0; j < channel->GetNumberOfDaughters(); ++j ) {
+      const G4ParticleDefinition* daughter = channel->GetDaughter(j);
+      if ( daughter->GetParticleType() == "nucleus" ) {
+        Resolve(daughter, branch, yields, energy, depth + 1);
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSActivationSolver::AddNode(const G4ParticleDefinition* definition)
+{
+  auto it = fNodeIndex.find(definition);
+  if ( it != fNodeIndex.end() ) return it->second;
+
+  const G4int index = fNodes.size();
+  fNodeIndex[definition] = index;
+  Node node;
+  node.definition = definition;
+  node.lambda = 1. / ( definition->GetPDGLifeTime() / s );
+  node.energy = 0.;
+  fNodes.push_back(node);
+
+  // A decay is the same as the prompt decay of a nuclide with this weight
+  std::map<G4int, G4double> yields;
+  G4double energy = 0.;
+  G4DecayTable* table = fDecay->GetDecayTable(definition);
+  G4double total = 0.;
+  for ( G4int i = 0; i < table->entries(); ++i ) {
+    total += table->GetDecayChannel(i)->GetBR();
+  }
+  for ( G4int i = 0; i < table->entries() && total > 0.; ++i ) {
+    G4VDecayChannel* channel = table->GetDecayChannel(i);
+    const G4double branch = channel->GetBR() / total;
+    G4double q = definition->GetPDGMass();
+    for ( G4int j = 0; j < channel->GetNumberOfDaughters(); ++j ) {
+      q -= channel->GetDaughter(j)->GetPDGMass();
+    }
+    energy += branch * std::max(q, 0.) / MeV;
+    for ( G4int j = 0; j < channel->GetNumberOfDaughters(); ++j ) {
+      const G4ParticleDefinition* daughter = channel->GetDaughter(j);
+      if ( daughter->GetParticleType() == "nucleus" ) {
+        Resolve(daughter, branch, yields, energy, 1);
+      }
+    }
+  }
+  fNodes[index].energy = energy;
+  fNodes[index].daughters.assign(yields.begin(), yields.end());
+  return index;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4int> DMSActivationSolver::BuildModes()
+{
+  const G4int n = fNodes.size();
+
+  // Decays lower the mass, so parents come before their daughters
+  std::vector<G4int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](G4int a, G4int b) {
+    return fNodes[a].definition->GetPDGMass() > fNodes[b].definition->GetPDGMass();
+  });
+  std::vector<G4int> newIndex(n);
+  for ( G4int k = 0; k < n; ++k ) newIndex[order[k]] = k;
+  std::vector<Node> nodes(n);
+  G4bool ordered = true;
+  for ( G4int k = 0; k < n; ++k ) {
+    nodes[k] = fNodes[order[k]];
+    for ( auto& daughter : nodes[k].daughters ) {
+      daughter.first = newIndex[daughter.first];
+      if ( daughter.first <= k ) ordered = false;
+    }
+  }
+  fNodes.swap(nodes);
+  for ( auto& entry : fNodeIndex ) entry.second = newIndex[entry.second];
+  if ( ! ordered ) {
+    G4Exception("DMSActivationSolver::BuildModes", "DMSActivation002",
+                JustWarning, "Decay network not ordered by mass; the chains"
+                " through nuclides of equal mass are dropped.");
+  }
+
+  // Decay constants, equal ones separated
+  fLambda.resize(n);
+  for ( G4int k = 0; k < n; ++k ) fLambda[k] = fNodes[k].lambda;
+  std::vector<G4int> byLambda(n);
+  std::iota(byLambda.begin(), byLambda.end(), 0);
+  std::sort(byLambda.begin(), byLambda.end(),
+            [this](G4int a, G4int b) { return fLambda[a] < fLambda[b]; });
+  for ( G4int k = 1; k < n; ++k ) {
+    const G4double floor = fLambda[byLambda[k - 1]] * ( 1. + kSeparation );
+    if ( fLambda[byLambda[k]] < floor ) fLambda[byLambda[k]] = floor;
+  }
+
+  // Feeding of each nuclide, A_ij = yield_ji lambda_j
+  std::vector<std::vector<std::pair<G4int, G4double> > > parents(n);
+  for ( G4int j = 0; j < n; ++j ) {
+    for ( const auto& daughter : fNodes[j].daughters ) {
+      if ( daughter.first > j ) {
+        parents[daughter.first].push_back({ j, daughter.second * fLambda[j] });
+      }
+    }
+  }
+
+  // Column k of V: v_k = 1, v_i = sum_j A_ij v_j / (lambda_i - lambda_k)
+  // over the descendants i of k
+  fColumns.assign(n, std::vector<std::pair<G4int, G4double> >());
+  fActivityWeight.assign(n, 0.);
+  fPowerWeight.assign(n, 0.);
+  std::vector<G4double> v(n, 0.);
+  std::vector<char> reached(n, 0);
+  std::vector<G4int> members, stack;
+  for ( G4int k = 0; k < n; ++k ) {
+    members.assign(1, k);
+    stack.assign(1, k);
+    reached[k] = 1;
+    while ( ! stack.empty() ) {
+      G4int j = stack.back();
+      stack.pop_back();
+      for ( const auto& daughter : fNodes[j].daughters ) {
+        if ( daughter.first > j && ! reached[daughter.first] ) {
+          reached[daughter.first] = 1;
+          members.push_back(daughter.first);
+          stack.push_back(daughter.first);
+        }
+      }
+    }
+    std::sort(members.begin(), members.end());
+
+    v[k] = 1.;
+    for ( size_t m = 1; m < members.size(); ++m ) {
+      const G4int i = members[m];
+      G4double sum = 0.;
+      for ( const auto& parent : parents[i] ) sum += parent.second * v[parent.first];
+      v[i] = sum / ( fLambda[i] - fLambda[k] );
+    }
+    for ( const G4int i : members ) {
+      fColumns[k].push_back({ i, v[i] });
+      fActivityWeight[k] += fLambda[i] * v[i];
+      fPowerWeight[k] += fLambda[i] * fNodes[i].energy * MeV / joule * v[i];
+      v[i] = 0.;
+      reached[i] = 0;
+    }
+  }
+  return newIndex;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSActivationSolver::Evaluate(const std::vector<G4double>& c,
+                                   G4double irradiation,
+                                   const std::vector<G4double>& cooling,
+                                   std::vector<G4double>& activity,
+                                   std::vector<G4double>& power) const
+{
+  // Mode amplitudes at the end of the irradiation, then plain dot products
+  // over the modes for every cooling time
+  const size_t n = fLambda.size();
+  const G4double length = irradiation / s;
+  std::vector<G4double> a(n), p(n);
+  for ( size_t k = 0; k < n; ++k ) {
+    const G4double g = c[k] * -std::expm1(-fLambda[k] * length) / fLambda[k];
+    a[k] = g * fActivityWeight[k];
+    p[k] = g * fPowerWeight[k];
+  }
+  activity.assign(cooling.size(), 0.);
+  power.assign(cooling.size(), 0.);
+  for ( size_t m = 0; m < cooling.size(); ++m ) {
+    const G4double t = cooling[m] / s;
+    G4double sumA = 0., sumP = 0.;
+    for ( size_t k = 0; k < n; ++k ) {
+      const G4double e = std::exp(-fLambda[k] * t);
+      sumA += a[k] * e;
+      sumP += p[k] * e;
+    }
+    activity[m] = sumA;
+    power[m] = sumP;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSActivationSolver::Solve(const DMSNuclideInventory& inventory)
+{
+  if ( ! fActive ) return;
+  if ( ! inventory.IsActive() || inventory.GetPrimaryEnergy() <= 0. ) {
+    G4Exception("DMSActivationSolver::Solve", "DMSActivation001", JustWarning,
+                "The activation needs the nuclide inventory (/dms/nuclides/active).");
+    return;
+  }
+
+  G4Timer timer;
+  timer.Start();
+  // Only used as the reader of the decay data; like any process it is left
+  // to the process table
+  if ( ! fDecay ) fDecay = new G4RadioactiveDecay("DMSActivationDecay");
+  fNodes.clear();
+  fNodeIndex.clear();
+
+  // Production per layer in nuclei per second for the beam power
+  typedef std::pair<G4int, G4int> Layer;
+  const G4double rate = fBeamPower / ( inventory.GetPrimaryEnergy() / joule );
+  std::map<Layer, std::map<G4int, G4double> > production;
+  G4IonTable* ionTable = G4IonTable::GetIonTable();
+  for ( const auto& slot : inventory.GetMap().GetSlots() ) {
+    if ( ! slot.key ) continue;
+    DMSNuclideInventory::Nuclide nuclide(slot.key);
+    // Level 9 is an excited state outside of the nuclide table
+    const G4ParticleDefinition* definition =
+      ionTable->GetIon(nuclide.Z, nuclide.A, nuclide.isomer < 9 ? nuclide.isomer : 0);
+    if ( ! definition ) continue;
+    G4double prompt = 0.;
+    Resolve(definition, slot.value * rate,
+            production[Layer(nuclide.volumeID, nuclide.copyNumber)], prompt, 0);
+  }
+  const std::vector<G4int> newIndex = BuildModes();
+  const size_t n = fNodes.size();
+
+  std::map<G4int, G4VPhysicalVolume*> volumes;
+  for ( const auto volume : *G4PhysicalVolumeStore::GetInstance() ) {
+    volumes[volume->GetInstanceID()] = volume;
+  }
+
+  std::ofstream csv(fFileName + ".csv");
+  csv << "volume,copy,irradiation_s,cooling_s,activity_Bq,"
+      << "specific_activity_Bq_per_g,decay_power_W\n";
+  std::ofstream nuclidesCsv(fFileName + "_nuclides.csv");
+  nuclidesCsv << "volume,copy,irradiation_s,cooling_s,nuclide,half_life_s,activity_Bq\n";
+
+  const std::vector<G4double> reportTimes
+    = { 0., 3600.*s, 86400.*s, 30.*86400.*s, 365.*86400.*s };
+  const G4double longest = fIrradiationTimes.empty() ? 0.
+    : *std::max_element(fIrradiationTimes.begin(), fIrradiationTimes.end());
+  G4cout << G4endl
+         << " Activity [Bq] / decay power [W] for a beam power of " << fBeamPower
+         << " W (" << n << " radionuclides), after "
+         << G4BestUnit(longest, "Time") << " of irradiation and a cooling of"
+         << G4endl
+         << "                     0          1 h          1 d         30 d          1 y"
+         << G4endl;
+
+  std::vector<G4double> c(n), amplitude(n), amount(n), activity, power;
+  for ( const auto& layer : production ) {
+    // c = V^-1 R by forward substitution over the columns of V
+    std::fill(c.begin(), c.end(), 0.);
+    for ( const auto& entry : layer.second ) c[newIndex[entry.first]] += entry.second;
+    for ( size_t k = 0; k < n; ++k ) {
+      for ( size_t m = 1; m < fColumns[k].size(); ++m ) {
+        c[fColumns[k][m].first] -= fColumns[k][m].second * c[k];
+      }
+    }
+
+    G4VPhysicalVolume* physical = volumes[layer.first.first];
+    const G4String name = physical ? physical->GetName() : G4String("unknown");
+    // Mass of the layer alone, without its daughters in nested mode
+    const G4LogicalVolume* logical = physical ? physical->GetLogicalVolume() : 0;
+    const G4double mass = logical
+      ? DMSDetectorConstruction::GetLayerVolume(logical)
+        * logical->GetMaterial()->GetDensity() / g : 0.;
+
+    for ( const G4double irradiation : fIrradiationTimes ) {
+      Evaluate(c, irradiation, fCoolingTimes, activity, power);
+      for ( size_t m = 0; m < fCoolingTimes.size(); ++m ) {
+        csv << name << ',' << layer.first.second << ',' << irradiation / s << ','
+            << fCoolingTimes[m] / s << ',' << activity[m] << ','
+            << ( mass > 0. ? activity[m] / mass : 0. ) << ',' << power[m] << '\n';
+
+        // Nuclides of this time: N = V a
+        const G4double t = fCoolingTimes[m] / s;
+        for ( size_t k = 0; k < n; ++k ) {
+          amplitude[k] = c[k] * -std::expm1(-fLambda[k] * irradiation / s)
+                       / fLambda[k] * std::exp(-fLambda[k] * t);
+        }
+        std::fill(amount.begin(), amount.end(), 0.);
+        for ( size_t k = 0; k < n; ++k ) {
+          for ( const auto& element : fColumns[k] ) {
+            amount[element.first] += element.second * amplitude[k];
+          }
+        }
+        for ( size_t i = 0; i < n; ++i ) {
+          const G4double value = fLambda[i] * amount[i];
+          if ( value <= 0. || value < fMinFraction * activity[m] ) continue;
+          nuclidesCsv << name << ',' << layer.first.second << ','
+                      << irradiation / s << ',' << t << ','
+                      << fNodes[i].definition->GetParticleName() << ','
+                      << std::log(2.) / fLambda[i] << ',' << value << '\n';
+        }
+      }
+    }
+
+    Evaluate(c, longest, reportTimes, activity, power);
+    G4cout << "  " << std::setw(10) << name << std::setw(4) << layer.first.second;
+    for ( const auto value : activity ) G4cout << std::setw(13) << value;
+    G4cout << G4endl << "                ";
+    for ( const auto value : power ) G4cout << std::setw(13) << value;
+    G4cout << G4endl;
+  }
+  timer.Stop();
+  G4cout << "  Solved in " << timer.GetRealElapsed() << " s, written to "
+         << fFileName << ".csv and " << fFileName << "_nuclides.csv" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
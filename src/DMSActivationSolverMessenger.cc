@@ -0,0 +1,199 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSActivationSolverMessenger.cc
+/// \brief Implementation of the DMSActivationSolverMessenger class
+
+#include "DMSActivationSolverMessenger.hh"
+#include "DMSActivationSolver.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UnitsTable.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSActivationSolverMessenger::DMSActivationSolverMessenger(DMSActivationSolver* solver)
+: G4UImessenger(),
+  fSolver(solver),
+  fActivationDirectory(0),
+  fActiveCmd(0),
+  fBeamPowerCmd(0),
+  fIrradiationCmd(0),
+  fCoolingCmd(0),
+  fCoolingRangeCmd(0),
+  fMinFractionCmd(0),
+  fFileNameCmd(0)
+{
+  fActivationDirectory = new G4UIdirectory("/dms/activation/");
+  fActivationDirectory->SetGuidance("Activity and decay power of the layers after the run");
+
+  fActiveCmd = new G4UIcmdWithABool("/dms/activation/active", this);
+  fActiveCmd->SetGuidance("Solve the decay chains at the end of the run (default false).");
+  fActiveCmd->SetGuidance("Needs the nuclide inventory (/dms/nuclides/active).");
+  fActiveCmd->SetParameterName("active", true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fActiveCmd->SetToBeBroadcasted(false);
+
+  fBeamPowerCmd = new G4UIcmdWithADouble("/dms/activation/beamPower", this);
+  fBeamPowerCmd->SetGuidance("Beam power in W during the irradiation (default 1).");
+  fBeamPowerCmd->SetParameterName("watts", false);
+  fBeamPowerCmd->SetRange("watts>0.");
+  fBeamPowerCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fBeamPowerCmd->SetToBeBroadcasted(false);
+
+  fIrradiationCmd = new G4UIcmdWithAString("/dms/activation/irradiation", this);
+  fIrradiationCmd->SetGuidance("Irradiation times, values followed by a unit,");
+  fIrradiationCmd->SetGuidance("e.g. \"1 30 365 day\" (the default).");
+  fIrradiationCmd->SetParameterName("times", false);
+  fIrradiationCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fIrradiationCmd->SetToBeBroadcasted(false);
+
+  fCoolingCmd = new G4UIcmdWithAString("/dms/activation/cooling", this);
+  fCoolingCmd->SetGuidance("Cooling times, values followed by a unit,");
+  fCoolingCmd->SetGuidance("e.g. \"0 1 8 24 168 hour\".");
+  fCoolingCmd->SetParameterName("times", false);
+  fCoolingCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fCoolingCmd->SetToBeBroadcasted(false);
+
+  fCoolingRangeCmd = new G4UIcommand("/dms/activation/coolingRange", this);
+  fCoolingRangeCmd->SetGuidance("Cooling times 0 and n times spaced logarithmically");
+  fCoolingRangeCmd->SetGuidance("from first to last. Default 1 s to 3650 day, 81 times.");
+  auto first = new G4UIparameter("first", 'd', false);
+  first->SetParameterRange("first>0.");
+  fCoolingRangeCmd->SetParameter(first);
+  auto last = new G4UIparameter("last", 'd', false);
+  last->SetParameterRange("last>0.");
+  fCoolingRangeCmd->SetParameter(last);
+  auto times = new G4UIparameter("n", 'i', false);
+  times->SetParameterRange("n>0");
+  fCoolingRangeCmd->SetParameter(times);
+  auto unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue("s");
+  fCoolingRangeCmd->SetParameter(unit);
+  fCoolingRangeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fCoolingRangeCmd->SetToBeBroadcasted(false);
+
+  fMinFractionCmd = new G4UIcmdWithADouble("/dms/activation/minFraction", this);
+  fMinFractionCmd->SetGuidance("Nuclides written to the nuclide file: activity above this");
+  fMinFractionCmd->SetGuidance("fraction of their layer (default 1e-3).");
+  fMinFractionCmd->SetParameterName("fraction", false);
+  fMinFractionCmd->SetRange("fraction>=0.");
+  fMinFractionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fMinFractionCmd->SetToBeBroadcasted(false);
+
+  fFileNameCmd = new G4UIcmdWithAString("/dms/activation/fileName", this);
+  fFileNameCmd->SetGuidance("Base name of the activation output (default DMSActivation).");
+  fFileNameCmd->SetParameterName("fileName", false);
+  fFileNameCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fFileNameCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSActivationSolverMessenger::~DMSActivationSolverMessenger()
+{
+  delete fActiveCmd;
+  delete fBeamPowerCmd;
+  delete fIrradiationCmd;
+  delete fCoolingCmd;
+  delete fCoolingRangeCmd;
+  delete fMinFractionCmd;
+  delete fFileNameCmd;
+  delete fActivationDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSActivationSolverMessenger::ParseTimes(const G4String& list,
+                                                std::vector<G4double>& times) const
+{
+  std::vector<G4String> tokens;
+  std::istringstream is(list);
+  G4String token;
+  while ( is >> token ) tokens.push_back(token);
+  if ( tokens.size() < 2 ) return false;
+
+  const G4double unit = G4UnitDefinition::GetValueOf(tokens.back());
+  if ( unit <= 0. ) return false;
+  times.clear();
+  for ( size_t i = 0; i + 1 < tokens.size(); ++i ) {
+    std::istringstream value(tokens[i]);
+    G4double time;
+    if ( ! ( value >> time ) || time < 0. ) return false;
+    times.push_back(time * unit);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSActivationSolverMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fActiveCmd ) {
+    fSolver->SetActive(fActiveCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fBeamPowerCmd ) {
+    fSolver->SetBeamPower(fBeamPowerCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fIrradiationCmd || command == fCoolingCmd ) {
+    std::vector<G4double> times;
+    if ( ! ParseTimes(newValue, times) ) {
+      G4ExceptionDescription description;
+      description << "Expected time values followed by a unit, got \""
+                  << newValue << "\".";
+      G4Exception("DMSActivationSolverMessenger::SetNewValue", "DMSActivation003",
+                  JustWarning, description);
+      return;
+    }
+    if ( command == fIrradiationCmd ) fSolver->SetIrradiationTimes(times);
+    else fSolver->SetCoolingTimes(times);
+  }
+  else if ( command == fCoolingRangeCmd ) {
+    G4double first, last;
+    G4int n;
+    G4String unit;
+    std::istringstream is(newValue);
+    is >> first >> last >> n >> unit;
+    const G4double value = G4UnitDefinition::GetValueOf(unit);
+    fSolver->SetCoolingRange(first * value, last * value, n);
+  }
+  else if ( command == fMinFractionCmd ) {
+    fSolver->SetMinFraction(fMinFractionCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fFileNameCmd ) {
+    fSolver->SetFileName(newValue);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,191 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSArrowWriter.cc
+/// \brief Implementation of the DMSArrowWriter class
+
+#ifdef DMS_WITH_ARROW
+
+#include "DMSArrowWriter.hh"
+#include "DMSAsyncWriter.hh"
+#include "DMSNameDictionary.hh"
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+
+namespace
+{
+  void Check(const arrow::Status& status, const char* where)
+  {
+    if ( status.ok() ) return;
+    G4ExceptionDescription description;
+    description << status.ToString();
+    G4Exception(where, "DMSOutput005", FatalException, description);
+  }
+
+  template <class T>
+  T Unwrap(arrow::Result<T> result, const char* where)
+  {
+    Check(result.status(), where);
+    return result.MoveValueUnsafe();
+  }
+
+  std::shared_ptr<arrow::DataType> GetType(char type)
+  {
+    switch ( type ) {
+      case 'I': return arrow::int32();
+      case 'F': return arrow::float32();
+      default:  return arrow::float64();
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSArrowWriter::DMSArrowWriter(const G4String& fileName,
+                               const std::vector<DMSNtupleColumn>& columns,
+                               G4bool eventLayout)
+: fColumns(columns),
+  fEventLayout(eventLayout)
+{
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  if ( fEventLayout ) fields.push_back(arrow::field("eventID", arrow::int32(), false));
+  for ( const auto& column : fColumns ) {
+    G4int kind = DMSOutputSchema::GetCodeKind(column.name);
+    fCodeKinds.push_back(kind);
+    G4String name = column.name;
+    if ( kind >= 0 ) {
+      name = DMSOutputSchema::GetNameColumn(column.name);
+      fValueTypes.push_back(arrow::dictionary(arrow::int32(), arrow::utf8()));
+    }
+    else {
+      fValueTypes.push_back(GetType(column.type));
+    }
+    auto type = fValueTypes.back();
+    if ( fEventLayout ) type = arrow::list(arrow::field("item", type, false));
+    fields.push_back(arrow::field(name, type, false));
+  }
+  fSchema = arrow::schema(fields);
+
+  fFile = Unwrap(arrow::io::FileOutputStream::Open(fileName),
+                 "DMSArrowWriter::DMSArrowWriter");
+
+  // The dictionaries grow during the run and are sent as deltas
+  auto options = arrow::ipc::IpcWriteOptions::Defaults();
+  options.emit_dictionary_deltas = true;
+  fWriter = Unwrap(arrow::ipc::MakeFileWriter(fFile, fSchema, options),
+                   "DMSArrowWriter::DMSArrowWriter");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSArrowWriter::~DMSArrowWriter()
+{
+  if ( fWriter ) Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSArrowWriter::Write(const DMSOutputBatch* batch)
+{
+  // Every code in the batch was registered before it was filled, so the
+  // current tables cover it
+  std::shared_ptr<arrow::Array> dictionaries[DMSNameDictionary::kNumberOfKinds];
+  for ( G4int kind = 0; kind < DMSNameDictionary::kNumberOfKinds; ++kind ) {
+    arrow::StringBuilder builder;
+    auto names
+      = DMSNameDictionary::GetNames(static_cast<DMSNameDictionary::Kind>(kind));
+    for ( const auto& name : names ) {
+      Check(builder.Append(name), "DMSArrowWriter::Write");
+    }
+    dictionaries[kind] = Unwrap(builder.Finish(), "DMSArrowWriter::Write");
+  }
+
+  // Event layout: eventID column and the offsets shared by all lists
+  std::vector<std::shared_ptr<arrow::Array>> arrays;
+  std::vector<int32_t> offsets;
+  std::shared_ptr<arrow::Buffer> offsetsBuffer;
+  const int64_t nEvents = batch->eventIDs.size();
+  if ( fEventLayout ) {
+    auto eventIDs = std::make_shared<arrow::Buffer>(
+      reinterpret_cast<const uint8_t*>(batch->eventIDs.data()),
+      nEvents * sizeof(int32_t));
+    arrays.push_back(std::make_shared<arrow::Int32Array>(nEvents, eventIDs));
+    offsets.push_back(0);
+    offsets.insert(offsets.end(), batch->eventEnds.begin(), batch->eventEnds.end());
+    offsetsBuffer = std::make_shared<arrow::Buffer>(
+      reinterpret_cast<const uint8_t*>(offsets.data()),
+      offsets.size() * sizeof(int32_t));
+  }
+
+  for ( size_t c = 0; c < fColumns.size(); ++c ) {
+    // No copy: the batch outlives the synchronous WriteRecordBatch() below
+    const auto& column = batch->columns[c];
+    auto buffer = std::make_shared<arrow::Buffer>(
+      reinterpret_cast<const uint8_t*>(column.data()), column.size());
+
+    std::shared_ptr<arrow::Array> values;
+    if ( fCodeKinds[c] >= 0 ) {
+      auto indices = std::make_shared<arrow::Int32Array>(batch->rows, buffer);
+      values = Unwrap(arrow::DictionaryArray::FromArrays(fValueTypes[c], indices,
+                                                         dictionaries[fCodeKinds[c]]),
+                      "DMSArrowWriter::Write");
+    }
+    else {
+      auto data = arrow::ArrayData::Make(fValueTypes[c], batch->rows,
+                                         { nullptr, buffer }, 0);
+      values = arrow::MakeArray(data);
+    }
+
+    if ( fEventLayout ) {
+      const auto& field = fSchema->field(arrays.size());
+      arrays.push_back(std::make_shared<arrow::ListArray>(field->type(), nEvents,
+                                                          offsetsBuffer, values));
+    }
+    else {
+      arrays.push_back(values);
+    }
+  }
+
+  int64_t length = fEventLayout ? nEvents : int64_t(batch->rows);
+  auto recordBatch = arrow::RecordBatch::Make(fSchema, length, arrays);
+  Check(fWriter->WriteRecordBatch(*recordBatch), "DMSArrowWriter::Write");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSArrowWriter::Close()
+{
+  Check(fWriter->Close(), "DMSArrowWriter::Close");
+  Check(fFile->Close(), "DMSArrowWriter::Close");
+  fWriter.reset();
+  fFile.reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
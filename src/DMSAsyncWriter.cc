@@ -0,0 +1,337 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSAsyncWriter.cc
+/// \brief Implementation of the DMSAsyncWriter class
+
+#include "DMSAsyncWriter.hh"
+#include "DMSArrowWriter.hh"
+#include "DMSNameDictionary.hh"
+
+#include "G4Threading.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <zlib.h>
+
+namespace
+{
+  const uint32_t kFormatVersion = 1;
+
+  size_t ColumnSize(char type)
+  {
+    switch ( type ) {
+      case 'I': return sizeof(int32_t);
+      case 'F': return sizeof(float);
+      case 'D': return sizeof(double);
+      default:  return 0;
+    }
+  }
+
+  template <class T>
+  void Put(std::vector<char>& buffer, T value)
+  {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSAsyncWriter* DMSAsyncWriter::Instance()
+{
+  static DMSAsyncWriter instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSAsyncWriter::HasArrow()
+{
+#ifdef DMS_WITH_ARROW
+  return true;
+#else
+  return false;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSAsyncWriter::DMSAsyncWriter()
+: fQueue(0),
+  fArrowWriter(0),
+  fStop(false),
+  fOpen(false),
+  fStalls(0),
+  fBatches(0),
+  fRows(0),
+  fRawBytes(0),
+  fStoredBytes(0)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSAsyncWriter::~DMSAsyncWriter()
+{
+  if ( fOpen ) Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSAsyncWriter::Open(const G4String& fileName,
+                          const std::vector<DMSNtupleColumn>& columns,
+                          size_t queueDepth, Format format,
+                          G4bool eventLayout)
+{
+  if ( fOpen ) Close();
+
+  if ( format == kArrow && ! HasArrow() ) {
+    G4Exception("DMSAsyncWriter::Open", "DMSOutput004", FatalException,
+                "The arrow format requires building with WITH_ARROW.");
+  }
+
+  for ( const auto& column : columns ) {
+    if ( ColumnSize(column.type) == 0 ) {
+      G4Exception("DMSAsyncWriter::Open", "DMSOutput002", FatalException,
+                  "The binary format supports only I, F and D columns.");
+    }
+  }
+
+  fColumns = columns;
+#ifdef DMS_WITH_ARROW
+  if ( format == kArrow ) {
+    fArrowWriter = new DMSArrowWriter(fileName, fColumns, eventLayout);
+  }
+#else
+  // Only the arrow files record the layout
+  (void)eventLayout;
+#endif
+
+  if ( ! fArrowWriter ) {
+    fFile.open(fileName, std::ios::binary | std::ios::trunc);
+    if ( ! fFile ) {
+      G4ExceptionDescription description;
+      description << "Cannot open " << fileName;
+      G4Exception("DMSAsyncWriter::Open", "DMSOutput003", FatalException,
+                  description);
+    }
+
+    std::vector<char> header;
+    header.insert(header.end(), { 'D', 'M', 'S', 'B' });
+    Put<uint32_t>(header, kFormatVersion);
+    Put<uint32_t>(header, fColumns.size());
+    for ( const auto& column : fColumns ) {
+      Put<uint8_t>(header, column.type);
+      Put<uint16_t>(header, column.name.size());
+      header.insert(header.end(), column.name.begin(), column.name.end());
+    }
+    fFile.write(header.data(), header.size());
+  }
+
+  fQueue = new DMSBoundedQueue<DMSOutputBatch*>(queueDepth);
+  fStalls = 0;
+  fBatches = fRows = fRawBytes = fStoredBytes = 0;
+  fStop = false;
+  fOpen = true;
+  fThread = std::thread(&DMSAsyncWriter::Run, this);
+
+  G4cout << "DMSAsyncWriter: writing " << fileName << " with a queue of "
+         << fQueue->GetCapacity() << " batches" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSAsyncWriter::Close()
+{
+  if ( ! fOpen ) return;
+
+  // All producers are done: let the writer drain the queue and stop
+  fStop = true;
+  fThread.join();
+
+#ifdef DMS_WITH_ARROW
+  if ( fArrowWriter ) {
+    // The dictionaries went out with the record batches
+    fArrowWriter->Close();
+    delete fArrowWriter;
+    fArrowWriter = 0;
+  }
+#endif
+  if ( fFile.is_open() ) {
+    WriteDictionary();
+    fFile.close();
+  }
+  delete fQueue;
+  fQueue = 0;
+  fOpen = false;
+
+  G4cout << "DMSAsyncWriter: " << fRows << " rows in " << fBatches
+         << " batches";
+  if ( fRawBytes ) {
+    G4cout << ", " << fRawBytes << " bytes compressed to " << fStoredBytes;
+  }
+  G4cout << ", producers stalled " << fStalls << " times on a full queue"
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSOutputBatch* DMSAsyncWriter::NewBatch(size_t reservedRows) const
+{
+  auto batch = new DMSOutputBatch;
+  batch->threadId = G4Threading::G4GetThreadId();
+  batch->columns.resize(fColumns.size());
+  for ( size_t c = 0; c < fColumns.size(); ++c ) {
+    batch->columns[c].reserve(reservedRows * ColumnSize(fColumns[c].type));
+  }
+  return batch;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSAsyncWriter::Push(DMSOutputBatch* batch)
+{
+  if ( ! batch->rows && batch->eventIDs.empty() ) {
+    delete batch;
+    return;
+  }
+  if ( fQueue->TryPush(batch) ) return;
+
+  // Back-pressure: wait until the writer has made room
+  ++fStalls;
+  while ( ! fQueue->TryPush(batch) ) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSAsyncWriter::Run()
+{
+  DMSOutputBatch* batch = 0;
+  for ( ;; ) {
+    if ( fQueue->TryPop(batch) ) {
+      WriteBatch(batch);
+      delete batch;
+      continue;
+    }
+    // Everything pushed before the stop request has been written
+    if ( fStop ) {
+      while ( fQueue->TryPop(batch) ) {
+        WriteBatch(batch);
+        delete batch;
+      }
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSAsyncWriter::WriteBatch(const DMSOutputBatch* batch)
+{
+  ++fBatches;
+  fRows += batch->rows;
+#ifdef DMS_WITH_ARROW
+  if ( fArrowWriter ) {
+    fArrowWriter->Write(batch);
+    return;
+  }
+#endif
+
+  std::vector<char> raw;
+  size_t size = 0;
+  for ( const auto& column : batch->columns ) size += column.size();
+  raw.reserve(size);
+  for ( const auto& column : batch->columns ) {
+    raw.insert(raw.end(), column.begin(), column.end());
+  }
+  WriteBlock('R', batch->threadId, batch->rows, raw);
+
+  if ( ! batch->eventIDs.empty() ) {
+    std::vector<char> index;
+    for ( auto eventID : batch->eventIDs ) Put<int32_t>(index, eventID);
+    Put<int32_t>(index, 0);
+    for ( auto end : batch->eventEnds ) Put<int32_t>(index, end);
+    WriteBlock('E', batch->threadId, batch->eventIDs.size(), index);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSAsyncWriter::WriteBlock(char tag, G4int threadId, size_t rows,
+                                const std::vector<char>& raw)
+{
+  uLongf storedSize = compressBound(raw.size());
+  fCompressed.resize(storedSize);
+  const int status
+    = compress2(reinterpret_cast<Bytef*>(fCompressed.data()), &storedSize,
+                reinterpret_cast<const Bytef*>(raw.data()), raw.size(), 1);
+  if ( status != Z_OK ) {
+    // A block that cannot be compressed would leave a corrupt file
+    G4ExceptionDescription description;
+    description << "zlib error " << status << " compressing a block of "
+                << raw.size() << " bytes.";
+    G4Exception("DMSAsyncWriter::WriteBlock", "DMSOutput006", FatalException,
+                description);
+    return;
+  }
+
+  std::vector<char> header;
+  Put<uint8_t>(header, tag);
+  Put<uint32_t>(header, threadId);
+  Put<uint32_t>(header, rows);
+  Put<uint64_t>(header, raw.size());
+  Put<uint64_t>(header, storedSize);
+  fFile.write(header.data(), header.size());
+  fFile.write(fCompressed.data(), storedSize);
+
+  fRawBytes += raw.size();
+  fStoredBytes += storedSize;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSAsyncWriter::WriteDictionary()
+{
+  std::vector<char> raw;
+  size_t entries = 0;
+  for ( G4int kind = 0; kind < DMSNameDictionary::kNumberOfKinds; ++kind ) {
+    auto names
+      = DMSNameDictionary::GetNames(static_cast<DMSNameDictionary::Kind>(kind));
+    for ( size_t code = 0; code < names.size(); ++code ) {
+      Put<int32_t>(raw, kind);
+      Put<int32_t>(raw, code);
+      Put<uint16_t>(raw, names[code].size());
+      raw.insert(raw.end(), names[code].begin(), names[code].end());
+      ++entries;
+    }
+  }
+  WriteBlock('D', -1, entries, raw);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,322 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSCheckpoint.cc
+/// \brief Implementation of the DMSCheckpoint class
+
+#include "DMSCheckpoint.hh"
+#include "DMSCheckpointMessenger.hh"
+#include "DMSRunAction.hh"
+#include "DMSEventSeeder.hh"
+#include "DMSShard.hh"
+#ifdef DMS_WITH_MPI
+#include "DMSMPIReducer.hh"
+#include "G4Timer.hh"
+#endif
+
+#include "G4AccumulableManager.hh"
+#include "G4RunManager.hh"
+#include "G4Run.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  const uint32_t kVersion = 3;
+
+  template <class T>
+  void Put(std::ostream& file, T value)
+  {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <class T>
+  G4bool Get(std::istream& file, T& value)
+  {
+    return bool(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+}
+
+G4bool DMSCheckpoint::fgResume = false;
+G4int  DMSCheckpoint::fgEventOffset = 0;
+G4int  DMSCheckpoint::fgChunk = -1;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSCheckpoint::DMSCheckpoint(DMSRunAction* runAction)
+: fRunAction(runAction),
+  fMessenger(0),
+  fInterval(1000000),
+  fFileName("DMSCheckpoint"),
+  fContinuing(false),
+  fFinalRun(true),
+  fPendingScorers()
+{
+  fMessenger = new DMSCheckpointMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSCheckpoint::~DMSCheckpoint()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String DMSCheckpoint::GetFileName() const
+{
+  return fFileName + DMSShard::GetOutputSuffix() + ".chk";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String DMSCheckpoint::GetOutputSuffix()
+{
+  if ( fgChunk < 0 ) return "";
+  std::ostringstream suffix;
+  suffix << "_c" << fgChunk;
+  return suffix.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSCheckpoint::BeamOn(G4int nEvents)
+{
+  // A sharded job runs its slice of the events, the reduction of the
+  // shards runs none
+  const G4int jobEvents = DMSShard::GetJobEvents(nEvents);
+  if ( DMSShard::IsReduce() ) {
+    DMSShard::Reduce(*fRunAction, jobEvents);
+    return;
+  }
+  nEvents = jobEvents;
+  G4int firstEvent = DMSEventSeeder::GetFirstEvent();
+  if ( DMSShard::IsActive() ) {
+    DMSShard::GetRange(jobEvents, firstEvent, nEvents);
+    DMSEventSeeder::SetFirstEvent(firstEvent);
+  }
+
+#ifdef DMS_WITH_MPI
+  // The ranks run their slice in a single run and reduce in memory, a
+  // rank without events still takes part in the reduction
+  if ( DMSShard::IsMPI() ) {
+    G4Timer timer;
+    timer.Start();
+    if ( nEvents > 0 ) G4RunManager::GetRunManager()->BeamOn(nEvents);
+    else               G4AccumulableManager::Instance()->Reset();
+    timer.Stop();
+    DMSMPIReducer::Reduce(*fRunAction, nEvents, timer.GetRealElapsed());
+    return;
+  }
+#endif
+  if ( nEvents == 0 ) {
+    // A shard without events still writes its (empty) scorers, so that
+    // the reduction finds all shards
+    if ( DMSShard::IsActive() ) {
+      G4AccumulableManager::Instance()->Reset();
+      DMSShard::WriteScorers(*fRunAction, jobEvents, firstEvent, nEvents);
+    }
+    return;
+  }
+
+  G4RunManager* runManager = G4RunManager::GetRunManager();
+  const G4int interval = ( fInterval > 0 ) ? fInterval : nEvents;
+
+  G4int completed = 0;
+  G4int chunk = 0;
+  fPendingScorers.clear();
+  if ( fgResume && Read(nEvents, completed, chunk) ) {
+    G4cout << "DMSCheckpoint: resuming after " << completed << " of "
+           << nEvents << " events from " << GetFileName() << G4endl;
+  }
+  fgResume = false;
+
+  // A single run keeps the plain output names
+  const G4bool chunked = ( chunk > 0 || interval < nEvents );
+  fContinuing = false;
+  while ( completed < nEvents ) {
+    const G4int events = std::min(interval, nEvents - completed);
+    fgEventOffset = completed;
+    fgChunk = chunked ? chunk : -1;
+    fFinalRun = ( completed + events == nEvents );
+    runManager->BeamOn(events);
+
+    // An aborted run leaves the last checkpoint in place
+    const G4Run* run = runManager->GetCurrentRun();
+    if ( ! run || run->GetNumberOfEvent() < events ) {
+      G4ExceptionDescription description;
+      description << "Run " << chunk << " was aborted, resume from "
+                  << GetFileName() << " after " << completed << " events.";
+      G4Exception("DMSCheckpoint::BeamOn", "DMSCheckpoint001",
+                  JustWarning, description);
+      break;
+    }
+    completed += events;
+    ++chunk;
+    fContinuing = true;
+    if ( ! fFinalRun ) Write(nEvents, completed, chunk);
+  }
+
+  if ( completed == nEvents ) {
+    if ( DMSShard::IsActive() ) {
+      DMSShard::WriteScorers(*fRunAction, jobEvents, firstEvent, nEvents);
+    }
+    std::remove(GetFileName().c_str());
+    if ( chunked ) {
+      G4cout << "DMSCheckpoint: " << nEvents << " events in " << chunk
+             << " runs, combine the output files with" << G4endl
+             << "   dms-merge -o <output> DMSNeutronEmission" << G4endl;
+    }
+  }
+  fgEventOffset = 0;
+  fgChunk = -1;
+  fContinuing = false;
+  fFinalRun = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSCheckpoint::RestoreScorers()
+{
+  if ( fPendingScorers.empty() ) return;
+  std::istringstream stream(fPendingScorers);
+  fPendingScorers.clear();
+  if ( ! fRunAction->LoadScorers(stream) ) {
+    G4ExceptionDescription description;
+    description << "The scorers in " << GetFileName() << " do not match the"
+                << " current /dms/mesh/ and /dms/nuclides/ settings.";
+    G4Exception("DMSCheckpoint::RestoreScorers", "DMSCheckpoint002",
+                FatalException, description);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSCheckpoint::Write(G4int nEvents, G4int completed, G4int chunk) const
+{
+  // Written next to the checkpoint and renamed, so that an interruption
+  // never leaves a partial file
+  const G4String fileName = GetFileName();
+  const G4String tmpName = fileName + ".tmp";
+  {
+    std::ofstream file(tmpName, std::ios::binary | std::ios::trunc);
+    file.write("DMSC", 4);
+    Put<uint32_t>(file, kVersion);
+    Put<int32_t>(file, nEvents);
+    Put<int32_t>(file, completed);
+    Put<int32_t>(file, chunk);
+
+    const std::vector<unsigned long> state = G4Random::getTheEngine()->put();
+    Put<uint64_t>(file, state.size());
+    for ( const auto value : state ) Put<uint64_t>(file, value);
+
+    std::ostringstream scorers;
+    fRunAction->SaveScorers(scorers);
+    const std::string data = scorers.str();
+    Put<uint64_t>(file, data.size());
+    file.write(data.data(), data.size());
+    file.close();
+    if ( ! file ) {
+      G4ExceptionDescription description;
+      description << "Cannot write " << tmpName << ".";
+      G4Exception("DMSCheckpoint::Write", "DMSCheckpoint003",
+                  JustWarning, description);
+      return false;
+    }
+  }
+  if ( std::rename(tmpName.c_str(), fileName.c_str()) != 0 ) return false;
+
+  G4cout << "DMSCheckpoint: " << completed << " of " << nEvents
+         << " events, written " << fileName << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSCheckpoint::Read(G4int nEvents, G4int& completed, G4int& chunk)
+{
+  const G4String fileName = GetFileName();
+  std::ifstream file(fileName, std::ios::binary);
+  if ( ! file ) {
+    G4cout << "DMSCheckpoint: no " << fileName << ", starting from the"
+           << " first event." << G4endl;
+    return false;
+  }
+
+  char magic[4] = { 0, 0, 0, 0 };
+  uint32_t version = 0;
+  int32_t total = 0;
+  int32_t done = 0;
+  int32_t next = 0;
+  uint64_t size = 0;
+  file.read(magic, 4);
+  G4bool valid = file && std::string(magic, 4) == "DMSC"
+                 && Get(file, version) && version == kVersion
+                 && Get(file, total) && Get(file, done) && Get(file, next)
+                 && Get(file, size);
+  std::vector<unsigned long> state(valid ? size : 0);
+  for ( auto& value : state ) {
+    uint64_t word = 0;
+    valid = valid && Get(file, word);
+    value = word;
+  }
+  valid = valid && Get(file, size);
+  std::string data(valid ? size : 0, '\0');
+  if ( valid ) valid = bool(file.read(&data[0], size));
+
+  if ( ! valid || total != nEvents ) {
+    G4ExceptionDescription description;
+    if ( ! valid ) description << fileName << " is not a valid checkpoint.";
+    else description << fileName << " is for a run of " << total
+                     << " events, not " << nEvents << ".";
+    G4Exception("DMSCheckpoint::Read", "DMSCheckpoint004",
+                FatalException, description);
+    return false;
+  }
+  if ( ! G4Random::getTheEngine()->get(state) ) {
+    G4ExceptionDescription description;
+    description << "The random engine state in " << fileName << " is for"
+                << " another engine than " << G4Random::getTheEngine()->name()
+                << ".";
+    G4Exception("DMSCheckpoint::Read", "DMSCheckpoint005",
+                FatalException, description);
+    return false;
+  }
+
+  completed = done;
+  chunk = next;
+  fPendingScorers = data;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSCheckpointMessenger.cc
+/// \brief Implementation of the DMSCheckpointMessenger class
+
+#include "DMSCheckpointMessenger.hh"
+#include "DMSCheckpoint.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSCheckpointMessenger::DMSCheckpointMessenger(DMSCheckpoint* checkpoint)
+: G4UImessenger(),
+  fCheckpoint(checkpoint),
+  fCheckpointDirectory(0),
+  fBeamOnCmd(0),
+  fIntervalCmd(0),
+  fFileNameCmd(0),
+  fResumeCmd(0)
+{
+  fCheckpointDirectory = new G4UIdirectory("/dms/checkpoint/");
+  fCheckpointDirectory->SetGuidance("Checkpoint and restart of long runs");
+
+  fBeamOnCmd = new G4UIcmdWithAnInteger("/dms/checkpoint/beamOn", this);
+  fBeamOnCmd->SetGuidance("Run the events as runs of /dms/checkpoint/interval");
+  fBeamOnCmd->SetGuidance("events and write a checkpoint after each of them.");
+  fBeamOnCmd->SetParameterName("events", false);
+  fBeamOnCmd->SetRange("events>0");
+  fBeamOnCmd->AvailableForStates(G4State_Idle);
+  fBeamOnCmd->SetToBeBroadcasted(false);
+
+  fIntervalCmd = new G4UIcmdWithAnInteger("/dms/checkpoint/interval", this);
+  fIntervalCmd->SetGuidance("Events between two checkpoints (default 1000000,");
+  fIntervalCmd->SetGuidance("0: a single run without checkpoint).");
+  fIntervalCmd->SetParameterName("events", false);
+  fIntervalCmd->SetRange("events>=0");
+  fIntervalCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fIntervalCmd->SetToBeBroadcasted(false);
+
+  fFileNameCmd = new G4UIcmdWithAString("/dms/checkpoint/fileName", this);
+  fFileNameCmd->SetGuidance("Base name of the checkpoint file (default DMSCheckpoint).");
+  fFileNameCmd->SetParameterName("fileName", false);
+  fFileNameCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fFileNameCmd->SetToBeBroadcasted(false);
+
+  fResumeCmd = new G4UIcmdWithABool("/dms/checkpoint/resume", this);
+  fResumeCmd->SetGuidance("Continue the next /dms/checkpoint/beamOn from the");
+  fResumeCmd->SetGuidance("checkpoint file, as the --resume option does.");
+  fResumeCmd->SetParameterName("resume", true);
+  fResumeCmd->SetDefaultValue(true);
+  fResumeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fResumeCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSCheckpointMessenger::~DMSCheckpointMessenger()
+{
+  delete fBeamOnCmd;
+  delete fIntervalCmd;
+  delete fFileNameCmd;
+  delete fResumeCmd;
+  delete fCheckpointDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSCheckpointMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fBeamOnCmd ) {
+    fCheckpoint->BeamOn(fBeamOnCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fIntervalCmd ) {
+    fCheckpoint->SetInterval(fIntervalCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fFileNameCmd ) {
+    fCheckpoint->SetFileName(newValue);
+  }
+  else if ( command == fResumeCmd ) {
+    DMSCheckpoint::SetResume(fResumeCmd->GetNewBoolValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,206 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSDesignScan.cc
+/// \brief Implementation of the DMSDesignScan class
+
+#include "DMSDesignScan.hh"
+#include "DMSDesignScanMessenger.hh"
+#include "DMSRunAction.hh"
+#include "DMSDetectorConstruction.hh"
+#include "DMSEnergyMesh.hh"
+#include "DMSNuclideInventory.hh"
+#include "DMSActivationSolver.hh"
+
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+G4String DMSDesignScan::fgOutputSuffix;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSDesignScan::DMSDesignScan(DMSRunAction* runAction)
+: fRunAction(runAction),
+  fMessenger(0),
+  fVariants()
+{
+  fMessenger = new DMSDesignScanMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSDesignScan::~DMSDesignScan()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDesignScan::AddVariant(const G4String& name, const G4String& macro)
+{
+  Variant variant = { name, macro };
+  fVariants.push_back(variant);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDesignScan::Run(G4int nEvents)
+{
+  if ( fVariants.empty() ) {
+    G4cerr << "DMSDesignScan: no variants, see /dms/scan/addVariant." << G4endl;
+    return;
+  }
+
+  G4RunManager* runManager = G4RunManager::GetRunManager();
+  DMSDetectorConstruction* detector = const_cast<DMSDetectorConstruction*>(
+    static_cast<const DMSDetectorConstruction*>(
+      runManager->GetUserDetectorConstruction()));
+  const std::vector<DMSLayer> baseline = detector->GetLayers();
+
+  // The power per layer is scored by the mesh; the command reaches the
+  // meshes of the workers too
+  G4UImanager* uiManager = G4UImanager::GetUIpointer();
+  DMSEnergyMesh& mesh = fRunAction->GetEnergyMesh();
+  const G4bool meshActive = mesh.IsActive();
+  if ( ! meshActive ) {
+    G4cout << "DMSDesignScan: /dms/mesh/active is set for the power per layer."
+           << G4endl;
+    uiManager->ApplyCommand("/dms/mesh/active true");
+  }
+  DMSNuclideInventory& nuclides = fRunAction->GetNuclideInventory();
+  DMSActivationSolver& activation = fRunAction->GetActivationSolver();
+  const G4String meshFileName = mesh.GetFileName();
+  const G4String nuclidesFileName = nuclides.GetFileName();
+  const G4String activationFileName = activation.GetFileName();
+
+  std::vector<Result> results;
+  for ( const Variant& variant : fVariants ) {
+    G4cout << G4endl << "==================== Design scan: " << variant.name
+           << " ====================" << G4endl;
+    detector->SetLayers(baseline);
+    if ( variant.macro != "-" ) {
+      uiManager->ApplyCommand("/control/execute " + variant.macro);
+    }
+
+    fgOutputSuffix = "_" + variant.name;
+    mesh.SetFileName(meshFileName + fgOutputSuffix);
+    nuclides.SetFileName(nuclidesFileName + fgOutputSuffix);
+    activation.SetFileName(activationFileName + fgOutputSuffix);
+
+    const std::chrono::steady_clock::time_point start
+      = std::chrono::steady_clock::now();
+    runManager->BeamOn(nEvents);
+    const G4double seconds = std::chrono::duration<G4double>(
+      std::chrono::steady_clock::now() - start).count();
+    results.push_back(Collect(variant, seconds));
+  }
+
+  fgOutputSuffix = "";
+  mesh.SetFileName(meshFileName);
+  nuclides.SetFileName(nuclidesFileName);
+  activation.SetFileName(activationFileName);
+  detector->SetLayers(baseline);
+  if ( ! meshActive ) uiManager->ApplyCommand("/dms/mesh/active false");
+
+  Print(results, nEvents);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSDesignScan::Result DMSDesignScan::Collect(const Variant& variant,
+                                             G4double seconds) const
+{
+  // Merged values of the master, until the next run resets them
+  Result result;
+  result.name = variant.name;
+  result.seconds = seconds;
+  result.leakingNeutrons = fRunAction->GetLeakingNeutrons();
+
+  const DMSEnergyMesh& mesh = fRunAction->GetEnergyMesh();
+  G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+  for ( size_t i = 1; ; ++i ) {
+    const G4LogicalVolume* volume
+      = store->GetVolume("layer" + std::to_string(i), false);
+    if ( ! volume ) break;
+    result.layers.push_back(std::make_pair(volume->GetMaterial()->GetName(),
+      mesh.GetVolumeEnergy(volume) * mesh.GetPowerFactor()));
+  }
+  return result;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDesignScan::Print(const std::vector<Result>& results,
+                          G4int nEvents) const
+{
+  size_t nLayers = 0;
+  for ( const Result& result : results ) {
+    nLayers = std::max(nLayers, result.layers.size());
+  }
+
+  std::ofstream csv("DMSScan.csv");
+  csv << "variant,events,seconds,events_per_s,leaking_neutrons_per_primary,"
+         "layer,material,power_W\n";
+
+  G4cout << G4endl << " Design scan, " << nEvents << " events per variant"
+         << " (power in W for " << fRunAction->GetEnergyMesh().GetBeamPower()
+         << " W of beam):" << G4endl
+         << "  " << std::setw(16) << std::left << "variant" << std::right
+         << std::setw(10) << "events/s" << std::setw(12) << "n/primary";
+  for ( size_t i = 0; i < nLayers; ++i ) {
+    G4cout << std::setw(14) << "layer" + std::to_string(i + 1);
+  }
+  G4cout << G4endl;
+
+  for ( const Result& result : results ) {
+    const G4double rate = result.seconds > 0. ? nEvents / result.seconds : 0.;
+    const G4double leakage
+      = nEvents > 0 ? result.leakingNeutrons / nEvents : 0.;
+    G4cout << "  " << std::setw(16) << std::left << result.name << std::right
+           << std::setw(10) << rate << std::setw(12) << leakage;
+    for ( size_t i = 0; i < result.layers.size(); ++i ) {
+      G4cout << std::setw(14) << result.layers[i].second;
+      csv << result.name << ',' << nEvents << ',' << result.seconds << ','
+          << rate << ',' << leakage << ",layer" << i + 1 << ','
+          << result.layers[i].first << ',' << result.layers[i].second << '\n';
+    }
+    G4cout << G4endl << "  " << std::setw(38) << "";
+    for ( const auto& layer : result.layers ) {
+      G4cout << std::setw(14) << layer.first;
+    }
+    G4cout << G4endl;
+  }
+  G4cout << " Written to DMSScan.csv" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
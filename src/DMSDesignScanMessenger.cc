@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSDesignScanMessenger.cc
+/// \brief Implementation of the DMSDesignScanMessenger class
+
+#include "DMSDesignScanMessenger.hh"
+#include "DMSDesignScan.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSDesignScanMessenger::DMSDesignScanMessenger(DMSDesignScan* scan)
+: G4UImessenger(),
+  fScan(scan),
+  fScanDirectory(0),
+  fAddVariantCmd(0),
+  fClearVariantsCmd(0),
+  fRunCmd(0)
+{
+  fScanDirectory = new G4UIdirectory("/dms/scan/");
+  fScanDirectory->SetGuidance("Scan of dump design variants in one job");
+
+  fAddVariantCmd = new G4UIcommand("/dms/scan/addVariant", this);
+  fAddVariantCmd->SetGuidance("Add a variant: its name (output suffix) and a macro of");
+  fAddVariantCmd->SetGuidance("/dms/geometry/ commands applied to the layers in place");
+  fAddVariantCmd->SetGuidance("when the scan starts; - keeps these layers.");
+  fAddVariantCmd->SetParameter(new G4UIparameter("name", 's', false));
+  auto macro = new G4UIparameter("macro", 's', true);
+  macro->SetDefaultValue("-");
+  fAddVariantCmd->SetParameter(macro);
+  fAddVariantCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fAddVariantCmd->SetToBeBroadcasted(false);
+
+  fClearVariantsCmd = new G4UIcmdWithoutParameter("/dms/scan/clearVariants", this);
+  fClearVariantsCmd->SetGuidance("Remove all variants.");
+  fClearVariantsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fClearVariantsCmd->SetToBeBroadcasted(false);
+
+  fRunCmd = new G4UIcmdWithAnInteger("/dms/scan/run", this);
+  fRunCmd->SetGuidance("Run every variant with the given number of events and");
+  fRunCmd->SetGuidance("compare them (printed and written to DMSScan.csv).");
+  fRunCmd->SetParameterName("events", false);
+  fRunCmd->SetRange("events>0");
+  fRunCmd->AvailableForStates(G4State_Idle);
+  fRunCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSDesignScanMessenger::~DMSDesignScanMessenger()
+{
+  delete fAddVariantCmd;
+  delete fClearVariantsCmd;
+  delete fRunCmd;
+  delete fScanDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDesignScanMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fAddVariantCmd ) {
+    G4String name;
+    G4String macro;
+    std::istringstream is(newValue);
+    is >> name >> macro;
+    fScan->AddVariant(name, macro);
+  }
+  else if ( command == fClearVariantsCmd ) {
+    fScan->ClearVariants();
+  }
+  else if ( command == fRunCmd ) {
+    fScan->Run(fRunCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
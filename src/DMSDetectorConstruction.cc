@@ -26,68 +26,280 @@
 //
 /// \file DMSDetectorConstruction.cc
 /// \brief Implementation of the DMSDetectorConstruction class
+#include <iomanip>
 #include <iostream>
 
 #include "DMSDetectorConstruction.hh"
+#include "DMSDetectorMessenger.hh"
+#include "DMSStartupTimer.hh"
 
 #include "G4RunManager.hh"
 #include "G4NistManager.hh"
 #include "G4SubtractionSolid.hh"
 #include "G4Box.hh"
-#include "G4Cons.hh"
-#include "G4Orb.hh"
-#include "G4Sphere.hh"
-#include "G4Trd.hh"
-#include "G4Tubs.hh"
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
+#include "G4GeometryManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4SolidStore.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
 #include "G4VisAttributes.hh"
 
+G4int DMSDetectorConstruction::fgGeometryVersion = 0;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DMSDetectorConstruction::DMSDetectorConstruction()
-: G4VUserDetectorConstruction()
-{ }
+: G4VUserDetectorConstruction(),
+  fMessenger(0),
+  fLayers(),
+  fMode(kBoolean),
+  fVisAttributes(),
+  fDefaultVisAttributes(0)
+{
+  DefineMaterials();
+
+  //
+  // Dump
+  //
+  // Geometry description by Jeffrey
+  //  Wooyoung,
+
+  // I revisiting the dump concept after receiving feedback from the last meeting. I am still not completely confident in the radiological and thermal aspects, but I think this is the best I can do without simulating anything and under the constraint of 1.2m length.
+
+  //Section 1 is 70cm long
+  //- graphite carbon +/- 10cm wide (i.e. 20cm wide centered)
+  //- surrounded by copper out to +/- 40 cm (i.e. from 10-40cm on either side).
+  //- surrounded by steel (or iron) out to +/- 60cm (i.e. from 40-60cm on either side).
+  //Section 2 is 30cm long (i.e. 70-100cm longitudinally)
+  //- copper, +/- 10cm (i.e. 80cm wide centered, no graphite).
+  //- surrounded by steel (or iron) out to +/- 20cm (i.e. from 40-60cm on either side).
+  //Section 3 is 20cm long (i.e. 100-120cm longitudinally)
+  //- borated concete (25% boron carbide B4C, 75% calcite CaCO3) +/- 60 cm (i.e. 120cm centered, no graphite or copper).
+
+  //Let me know if you have any questions, I can draw a picture if it is unclear. If you can't model the borated concrete, you can try just concrete.
+
+  //Here is the reasoning behind the concept. Proton beams should stop in 0.7m of graphite and 0.15m of copper with similar efficacy of 1m of graphite and 0.9m of aluminum. Not sure how hot the copper will get in this case since it is stopping protons in a shorter distance. However I leave some additional copper to provide some cooling. The 0.4m is essentially to provide some modest neutron shielding, at least 0.2m is necessary to shield the radiation activated copper (including Cu-61, Mn-52, C-11) while avoiding activation itself. The copper will generate more isotopes and spallation then alumnium, but I was able to avoid tungsten.
+
+  //Best,
+  //Jeff
+
+  // Default stack, innermost first; the concrete can be replaced by the
+  // borated concrete above with /dms/geometry/setMaterial 6 BoratedConcrete
+  AddLayer({ "G4_GRAPHITE",  10.*cm,  10.*cm, 0.,  10.*cm });
+  AddLayer({ "G4_Cu",        40.*cm,  40.*cm, 0.,  40.*cm });
+  AddLayer({ "G4_Fe",        70.*cm,  70.*cm, 0.,  70.*cm });
+  AddLayer({ "G4_Cu",        80.*cm,  80.*cm, 0.,  80.*cm });
+  AddLayer({ "G4_Fe",       100.*cm, 100.*cm, 0., 100.*cm });
+  AddLayer({ "G4_CONCRETE", 120.*cm, 120.*cm, 0., 120.*cm });
+
+  // Colours of the layers by material
+  fVisAttributes["G4_GRAPHITE"]     = new G4VisAttributes(G4Colour(0.0, 0.0, 0.0));
+  fVisAttributes["G4_Cu"]           = new G4VisAttributes(G4Colour(0.7, 0.4, 0.1));
+  fVisAttributes["G4_Fe"]           = new G4VisAttributes(G4Colour(1.0, 0.0, 0.0));
+  fVisAttributes["G4_CONCRETE"]     = new G4VisAttributes(G4Colour(0.5, 0.5, 0.5));
+  fVisAttributes["BoratedConcrete"] = new G4VisAttributes(G4Colour(0.5, 0.5, 0.5));
+  fDefaultVisAttributes = new G4VisAttributes(G4Colour(1.0, 1.0, 1.0));
+
+  fMessenger = new DMSDetectorMessenger(this);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DMSDetectorConstruction::~DMSDetectorConstruction()
-{ }
+{
+  delete fMessenger;
+  for ( auto& entry : fVisAttributes ) delete entry.second;
+  delete fDefaultVisAttributes;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-G4VPhysicalVolume* DMSDetectorConstruction::Construct()
+void DMSDetectorConstruction::DefineMaterials()
 {
   G4cout << "Initialize G4NistManager" << G4endl;
   // Get nist material manager
   G4NistManager* nist = G4NistManager::Instance();
 
-  const G4int nlayers = 6;
-
-  std::cout << "Building Materials ... " << std::endl;
-  G4Material* dump_layer_material[nlayers];
-  dump_layer_material[0] = nist->FindOrBuildMaterial("G4_GRAPHITE");
-  dump_layer_material[1] = nist->FindOrBuildMaterial("G4_Cu");
-  dump_layer_material[2] = nist->FindOrBuildMaterial("G4_Fe");
-  dump_layer_material[3] = nist->FindOrBuildMaterial("G4_Cu");
-  dump_layer_material[4] = nist->FindOrBuildMaterial("G4_Fe");
-  dump_layer_material[5] = nist->FindOrBuildMaterial("G4_CONCRETE");
-  std::cout << "DONE." << std::endl;
-
-  G4Colour brown(0.7, 0.4, 0.1);
-  G4Colour red(1.0, 0.0, 0.0);
-  G4Colour black(0.0, 0.0, 0.0);
-  G4Colour grey(0.5, 0.5, 0.5);
-  G4VisAttributes* copperVisAttributes   = new G4VisAttributes(brown);
-  G4VisAttributes* ironVisAttributes     = new G4VisAttributes(red);
-  G4VisAttributes* carbonVisAttributes   = new G4VisAttributes(black);
-  G4VisAttributes* concreteVisAttributes = new G4VisAttributes(grey);
-
-
-  // Option to switch on/off checking of volumes overlaps
+  // Borated concrete: 25% boron carbide and 75% calcite by mass, at the
+  // density of the solid mixture
+  G4Material* boronCarbide = nist->FindOrBuildMaterial("G4_BORON_CARBIDE");
+  G4Material* calcite = nist->FindOrBuildMaterial("G4_CALCIUM_CARBONATE");
+  G4double density = 1. / ( 0.25 / (2.52*g/cm3) + 0.75 / (2.71*g/cm3) );
+  G4Material* boratedConcrete = new G4Material("BoratedConcrete", density, 2);
+  boratedConcrete->AddMaterial(boronCarbide, 0.25);
+  boratedConcrete->AddMaterial(calcite, 0.75);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSDetectorConstruction::CheckMaterial(const G4String& name)
+{
+  return G4Material::GetMaterial(name, false)
+         || G4NistManager::Instance()->FindOrBuildMaterial(name);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDetectorConstruction::ClearLayers()
+{
+  fLayers.clear();
+  GeometryChanged();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDetectorConstruction::SetLayers(const std::vector<DMSLayer>& layers)
+{
+  fLayers = layers;
+  GeometryChanged();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDetectorConstruction::SetMode(Mode mode)
+{
+  fMode = mode;
+  GeometryChanged();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDetectorConstruction::AddLayer(const DMSLayer& layer)
+{
+  fLayers.push_back(layer);
+  GeometryChanged();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSDetectorConstruction::SetLayer(size_t index, const DMSLayer& layer)
+{
+  if ( index >= fLayers.size() ) return false;
+  fLayers[index] = layer;
+  GeometryChanged();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSDetectorConstruction::SetLayerMaterial(size_t index,
+                                                 const G4String& material)
+{
+  if ( index >= fLayers.size() ) return false;
+  fLayers[index].material = material;
+  GeometryChanged();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDetectorConstruction::GeometryChanged()
+{
+  // Before the first construction the stack is simply used by it
+  if ( fgGeometryVersion > 0 ) {
+    G4RunManager::GetRunManager()->ReinitializeGeometry();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDetectorConstruction::PrintLayers() const
+{
+  G4cout << G4endl << " Dump layers (innermost first):" << G4endl;
+  for ( size_t i = 0; i < fLayers.size(); ++i ) {
+    const DMSLayer& layer = fLayers[i];
+    G4cout << "  layer" << i + 1 << std::setw(18) << layer.material
+           << "  x +/-" << G4BestUnit(layer.halfX, "Length")
+           << "  y +/-" << G4BestUnit(layer.halfY, "Length")
+           << "  z " << G4BestUnit(layer.zFront, "Length")
+           << " to " << G4BestUnit(layer.zBack, "Length") << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSDetectorConstruction::CheckLayers() const
+{
+  G4ExceptionDescription description;
+  for ( size_t i = 0; i < fLayers.size(); ++i ) {
+    const DMSLayer& layer = fLayers[i];
+    if ( ! CheckMaterial(layer.material) ) {
+      description << "layer" << i + 1 << " has an unknown material "
+                  << layer.material << ". ";
+    }
+    if ( layer.halfX <= 0. || layer.halfY <= 0. || layer.zBack <= layer.zFront ) {
+      description << "layer" << i + 1 << " has no volume. ";
+    }
+    if ( i == 0 ) continue;
+    const DMSLayer& inner = fLayers[i - 1];
+    if ( layer.halfX < inner.halfX || layer.halfY < inner.halfY
+         || layer.zFront > inner.zFront || layer.zBack < inner.zBack ) {
+      description << "layer" << i + 1 << " does not enclose layer" << i
+                  << ". ";
+    }
+  }
+  if ( description.str().empty() ) return true;
+  G4Exception("DMSDetectorConstruction::Construct", "DMSDetectorConstruction001",
+              FatalErrorInArgument, description);
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DMSDetectorConstruction::GetLayerVolume(const G4LogicalVolume* volume)
+{
+  // G4BooleanSolid::GetCubicVolume() is a random estimate; the inner box
+  // of a shell lies inside its outer box, as CheckLayers() ensures
+  const G4VSolid* solid = volume->GetSolid();
+  G4double cubicVolume = 0.;
+  if ( dynamic_cast<const G4SubtractionSolid*>(solid) ) {
+    cubicVolume
+      = const_cast<G4VSolid*>(solid->GetConstituentSolid(0))->GetCubicVolume()
+      - const_cast<G4VSolid*>(solid->GetConstituentSolid(1))->GetCubicVolume();
+  }
+  else {
+    cubicVolume = const_cast<G4VSolid*>(solid)->GetCubicVolume();
+  }
+  for ( size_t i = 0; i < volume->GetNoDaughters(); ++i ) {
+    cubicVolume -= volume->GetDaughter(i)->GetLogicalVolume()->GetSolid()
+                                         ->GetCubicVolume();
+  }
+  return cubicVolume;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VPhysicalVolume* DMSDetectorConstruction::Construct()
+{
+  // A rebuild replaces the volumes of the previous construction
+  if ( fgGeometryVersion > 0 ) {
+    G4GeometryManager::GetInstance()->OpenGeometry();
+    G4PhysicalVolumeStore::GetInstance()->Clean();
+    G4LogicalVolumeStore::GetInstance()->Clean();
+    G4SolidStore::GetInstance()->Clean();
+  }
+  ++fgGeometryVersion;
+  CheckLayers();
+  PrintLayers();
+
+  G4VPhysicalVolume* physWorld = BuildWorld(fMode, true);
+
+  DMSStartupTimer::Instance()->GeometryDone();
+
+  //always return the physical World
   //
-  G4bool checkOverlaps = true;
+  return physWorld;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VPhysicalVolume* DMSDetectorConstruction::BuildWorld(Mode mode,
+                                                       G4bool checkOverlaps) const
+{
+  G4NistManager* nist = G4NistManager::Instance();
 
   //
   // World
@@ -115,169 +327,52 @@ G4VPhysicalVolume* DMSDetectorConstruction::Construct()
                       0,                     //copy number
                       checkOverlaps);        //overlaps checking
 
-
-  G4Box* box1 = new G4Box("box1", 10.*cm, 10.*cm, 5.*cm);
-  G4Box* box2 = new G4Box("box2", 40.*cm, 40.*cm, 20.*cm);
-  G4Box* box3 = new G4Box("box3", 70.*cm, 70.*cm, 35.*cm);
-  G4Box* box4 = new G4Box("box4", 80.*cm, 80.*cm, 40.*cm);
-  G4Box* box5 = new G4Box("box5", 100.*cm, 100.*cm, 50.*cm);
-  G4Box* box6 = new G4Box("box6", 120.*cm, 120.*cm, 60.*cm);
-
-  G4ThreeVector zTrans1(0., 0., 5.*cm);
-  G4ThreeVector zTrans2(0., 0., -20.*cm);
-  G4ThreeVector zTrans3(0., 0., -35.*cm);
-  G4ThreeVector zTrans4(0., 0., -40.*cm);
-  G4ThreeVector zTrans5(0., 0., -50.*cm);
-  G4ThreeVector zTrans6(0., 0., -60.*cm);
-
-  G4SubtractionSolid* subsolid2 = new G4SubtractionSolid("layer2", box2, box1, 0, zTrans2);
-  G4SubtractionSolid* subsolid3 = new G4SubtractionSolid("layer3", box3, box2, 0, zTrans3);
-  G4SubtractionSolid* subsolid4 = new G4SubtractionSolid("layer4", box4, box3, 0, zTrans4);
-  G4SubtractionSolid* subsolid5 = new G4SubtractionSolid("layer5", box5, box4, 0, zTrans5);
-  G4SubtractionSolid* subsolid6 = new G4SubtractionSolid("layer6", box6, box5, 0, zTrans6);
-
-  G4LogicalVolume* l_layer1 = new G4LogicalVolume(box1, dump_layer_material[0], "layer1");
-  G4LogicalVolume* l_layer2 = new G4LogicalVolume(subsolid2, dump_layer_material[1], "layer2");
-  G4LogicalVolume* l_layer3 = new G4LogicalVolume(subsolid3, dump_layer_material[2], "layer3");
-  G4LogicalVolume* l_layer4 = new G4LogicalVolume(subsolid4, dump_layer_material[3], "layer4");
-  G4LogicalVolume* l_layer5 = new G4LogicalVolume(subsolid5, dump_layer_material[4], "layer5");
-  G4LogicalVolume* l_layer6 = new G4LogicalVolume(subsolid6, dump_layer_material[5], "layer6");
-
-  l_layer1->SetVisAttributes(carbonVisAttributes);
-  l_layer2->SetVisAttributes(copperVisAttributes);
-  l_layer3->SetVisAttributes(ironVisAttributes);
-  l_layer4->SetVisAttributes(copperVisAttributes);
-  l_layer5->SetVisAttributes(ironVisAttributes);
-  l_layer6->SetVisAttributes(concreteVisAttributes);
-
-  // physical volume placement
-  new G4PVPlacement(0, zTrans1, l_layer1, "layer1", logicWorld, false, 0, checkOverlaps);
-  new G4PVPlacement(0, G4ThreeVector(0, 0, 20.*cm), l_layer2, "layer2", logicWorld, false, 0, checkOverlaps);
-  new G4PVPlacement(0, G4ThreeVector(0, 0, 35.*cm), l_layer3, "layer3", logicWorld, false, 0, checkOverlaps);
-  new G4PVPlacement(0, G4ThreeVector(0, 0, 40.*cm), l_layer4, "layer4", logicWorld, false, 0, checkOverlaps);
-  new G4PVPlacement(0, G4ThreeVector(0, 0, 50.*cm), l_layer5, "layer5", logicWorld, false, 0, checkOverlaps);
-  new G4PVPlacement(0, G4ThreeVector(0, 0, 60.*cm), l_layer6, "layer6", logicWorld, false, 0, checkOverlaps);
-
-
   //
-  // Dump
+  // Dump layers, created from the inside out
   //
-  // Geometry description by Jeffrey
-  //  Wooyoung,
-
-  // I revisiting the dump concept after receiving feedback from the last meeting. I am still not completely confident in the radiological and thermal aspects, but I think this is the best I can do without simulating anything and under the constraint of 1.2m length.
-
-  //Section 1 is 70cm long
-  //- graphite carbon +/- 10cm wide (i.e. 20cm wide centered)
-  //- surrounded by copper out to +/- 40 cm (i.e. from 10-40cm on either side).
-  //- surrounded by steel (or iron) out to +/- 60cm (i.e. from 40-60cm on either side).
-  //Section 2 is 30cm long (i.e. 70-100cm longitudinally)
-  //- copper, +/- 10cm (i.e. 80cm wide centered, no graphite).
-  //- surrounded by steel (or iron) out to +/- 20cm (i.e. from 40-60cm on either side).
-  //Section 3 is 20cm long (i.e. 100-120cm longitudinally)
-  //- borated concete (25% boron carbide B4C, 75% calcite CaCO3) +/- 60 cm (i.e. 120cm centered, no graphite or copper).
-
-  //Let me know if you have any questions, I can draw a picture if it is unclear. If you can't model the borated concrete, you can try just concrete.
-
-  //Here is the reasoning behind the concept. Proton beams should stop in 0.7m of graphite and 0.15m of copper with similar efficacy of 1m of graphite and 0.9m of aluminum. Not sure how hot the copper will get in this case since it is stopping protons in a shorter distance. However I leave some additional copper to provide some cooling. The 0.4m is essentially to provide some modest neutron shielding, at least 0.2m is necessary to shield the radiation activated copper (including Cu-61, Mn-52, C-11) while avoiding activation itself. The copper will generate more isotopes and spallation then alumnium, but I was able to avoid tungsten.
-
-  //Best,
-  //Jeff
+  std::vector<G4LogicalVolume*> logicals;
+  std::vector<G4ThreeVector> centres;
+  G4Box* innerBox = 0;
+  for ( size_t i = 0; i < fLayers.size(); ++i ) {
+    const DMSLayer& layer = fLayers[i];
+    const G4String name = "layer" + std::to_string(i + 1);
+    const G4ThreeVector centre(0., 0., 0.5 * ( layer.zFront + layer.zBack ));
+
+    G4Box* box = new G4Box("box" + std::to_string(i + 1), layer.halfX,
+                           layer.halfY, 0.5 * ( layer.zBack - layer.zFront ));
+    // Boolean: the box less the box of the layer inside, where that layer
+    // is placed. Nested: the plain box, the inner layer is its daughter.
+    G4VSolid* solid = box;
+    if ( mode == kBoolean && innerBox ) {
+      solid = new G4SubtractionSolid(name, box, innerBox, 0,
+                                     centres.back() - centre);
+    }
 
-  // Build from outermost one and create innermost one last.
-
-  /*
-
-  G4String dump_box_name[nlayers] = {
-    "dump_box_1",
-    "dump_box_2",
-    "dump_box_3",
-    "dump_box_4",
-    "dump_box_5",
-    "dump_box_6"
-  };
-  G4String dump_layer_name[nlayers] = {
-    "dump_layer_1",
-    "dump_layer_2",
-    "dump_layer_3",
-    "dump_layer_4",
-    "dump_layer_5",
-    "dump_layer_6"
-  };
-  G4String l_dump_layer_name[nlayers] = {
-    "l_dump_layer_1",
-    "l_dump_layer_2",
-    "l_dump_layer_3",
-    "l_dump_layer_4",
-    "l_dump_layer_5",
-    "l_dump_layer_6"
-  };
-  G4double dump_layer_partitions_z[nlayers]  = {
-    10.0 * m,
-    40.0 * m,
-    70.0 * m,
-    80.0 * m,
-    100.0 * m,
-    120.0 * m
-  };
-
-
-  G4Box* dump_box[6];
-
-  for(G4int i = 0; i < 6; ++i)
-  { dump_box[i] = new G4Box(dump_box_name[i],
-      dump_layer_partitions_z[i],
-      dump_layer_partitions_z[i],
-      dump_layer_partitions_z[i]
-      );   // square box
-  std::cout << "Box " << i << " created." << std::endl;
-  }
+    G4Material* material = G4Material::GetMaterial(layer.material, false);
+    if ( ! material ) material = nist->FindOrBuildMaterial(layer.material);
+    G4LogicalVolume* logical = new G4LogicalVolume(solid, material, name);
+    auto visAttributes = fVisAttributes.find(material->GetName());
+    logical->SetVisAttributes(visAttributes != fVisAttributes.end()
+                              ? visAttributes->second : fDefaultVisAttributes);
 
-  G4SubtractionSolid* dump_layer[6];
-  for( G4int i = 6; i > 1; --i )
-  {
-    std::cout << "intersection: " << i << " and " << i-1 << std::endl;
-    dump_layer[i] = new G4SubtractionSolid(dump_layer_name[i], dump_box[i], dump_box[i-1]);
+    logicals.push_back(logical);
+    centres.push_back(centre);
+    innerBox = box;
   }
 
-  G4LogicalVolume* l_dump_layer[6];
-  for( G4int i = 0; i < 6; i++ )
-  {
-    if( i == 0 )
-    {
-      l_dump_layer[0] = new G4LogicalVolume(
-        dump_box[0],
-        dump_layer_material[0],
-        l_dump_layer_name[0]
-        );
+  // physical volume placement, with the same positions in both modes
+  for ( size_t i = 0; i < logicals.size(); ++i ) {
+    const G4String& name = logicals[i]->GetName();
+    if ( mode == kBoolean || i + 1 == logicals.size() ) {
+      new G4PVPlacement(0, centres[i], logicals[i], name, logicWorld,
+                        false, 0, checkOverlaps);
     }
-    else
-    {
-      l_dump_layer[i] = new G4LogicalVolume(
-          dump_layer[i],
-          dump_layer_material[i],
-          l_dump_layer_name[i]
-        );
+    else {
+      new G4PVPlacement(0, centres[i] - centres[i + 1], logicals[i], name,
+                        logicals[i + 1], false, 0, checkOverlaps);
     }
-
-    // physical volume placement
-    new G4PVPlacement(0,
-        G4ThreeVector(),
-        l_dump_layer[i],
-        dump_layer_name[i],
-        logicWorld,
-        false,
-        0,
-        checkOverlaps);
   }
-  */
-
-
 
-
-  //
-  //always return the physical World
-  //
   return physWorld;
 }
 
@@ -0,0 +1,221 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSDetectorMessenger.cc
+/// \brief Implementation of the DMSDetectorMessenger class
+
+#include "DMSDetectorMessenger.hh"
+#include "DMSDetectorConstruction.hh"
+#include "DMSNavigationBenchmark.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSDetectorMessenger::DMSDetectorMessenger(DMSDetectorConstruction* detector)
+: G4UImessenger(),
+  fDetector(detector),
+  fGeometryDirectory(0),
+  fClearLayersCmd(0),
+  fAddLayerCmd(0),
+  fSetLayerCmd(0),
+  fSetMaterialCmd(0),
+  fPrintLayersCmd(0),
+  fModeCmd(0),
+  fBenchmarkCmd(0)
+{
+  fGeometryDirectory = new G4UIdirectory("/dms/geometry/");
+  fGeometryDirectory->SetGuidance("Layer stack of the dump. Changes between runs rebuild");
+  fGeometryDirectory->SetGuidance("the geometry at the next run, the physics tables are kept.");
+
+  fClearLayersCmd = new G4UIcmdWithoutParameter("/dms/geometry/clearLayers", this);
+  fClearLayersCmd->SetGuidance("Remove all layers, before defining a new stack.");
+  fClearLayersCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fClearLayersCmd->SetToBeBroadcasted(false);
+
+  fAddLayerCmd = NewLayerCommand("/dms/geometry/addLayer", false);
+  fAddLayerCmd->SetGuidance("Add a layer around the previous ones: material, half");
+  fAddLayerCmd->SetGuidance("widths in x and y, z of the front and back faces.");
+
+  fSetLayerCmd = NewLayerCommand("/dms/geometry/setLayer", true);
+  fSetLayerCmd->SetGuidance("Replace layer<n> (from 1, innermost): material, half");
+  fSetLayerCmd->SetGuidance("widths in x and y, z of the front and back faces.");
+
+  fSetMaterialCmd = new G4UIcommand("/dms/geometry/setMaterial", this);
+  fSetMaterialCmd->SetGuidance("Change the material of layer<n> (from 1, innermost),");
+  fSetMaterialCmd->SetGuidance("e.g. G4_Al or BoratedConcrete.");
+  auto layer = new G4UIparameter("layer", 'i', false);
+  layer->SetParameterRange("layer>0");
+  fSetMaterialCmd->SetParameter(layer);
+  fSetMaterialCmd->SetParameter(new G4UIparameter("material", 's', false));
+  fSetMaterialCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fSetMaterialCmd->SetToBeBroadcasted(false);
+
+  fPrintLayersCmd = new G4UIcmdWithoutParameter("/dms/geometry/printLayers", this);
+  fPrintLayersCmd->SetGuidance("Print the layer stack.");
+  fPrintLayersCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fPrintLayersCmd->SetToBeBroadcasted(false);
+
+  fModeCmd = new G4UIcmdWithAString("/dms/geometry/mode", this);
+  fModeCmd->SetGuidance("Build the layers as boolean shells side by side in the");
+  fModeCmd->SetGuidance("World, or as plain boxes nested in each other, which are");
+  fModeCmd->SetGuidance("faster to navigate. The material map is the same.");
+  fModeCmd->SetParameterName("mode", false);
+  fModeCmd->SetCandidates("boolean nested");
+  fModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fModeCmd->SetToBeBroadcasted(false);
+
+  fBenchmarkCmd = new G4UIcmdWithAnInteger("/dms/geometry/benchmark", this);
+  fBenchmarkCmd->SetGuidance("Trace random rays through the layers built in both");
+  fBenchmarkCmd->SetGuidance("modes, print the navigation speed of each and check");
+  fBenchmarkCmd->SetGuidance("that they have the same material map.");
+  fBenchmarkCmd->SetParameterName("rays", true);
+  fBenchmarkCmd->SetDefaultValue(100000);
+  fBenchmarkCmd->SetRange("rays > 0");
+  fBenchmarkCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fBenchmarkCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSDetectorMessenger::~DMSDetectorMessenger()
+{
+  delete fClearLayersCmd;
+  delete fAddLayerCmd;
+  delete fSetLayerCmd;
+  delete fSetMaterialCmd;
+  delete fPrintLayersCmd;
+  delete fModeCmd;
+  delete fBenchmarkCmd;
+  delete fGeometryDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4UIcommand* DMSDetectorMessenger::NewLayerCommand(const char* name,
+                                                   G4bool withIndex)
+{
+  G4UIcommand* command = new G4UIcommand(name, this);
+  if ( withIndex ) {
+    auto layer = new G4UIparameter("layer", 'i', false);
+    layer->SetParameterRange("layer>0");
+    command->SetParameter(layer);
+  }
+  command->SetParameter(new G4UIparameter("material", 's', false));
+  auto halfX = new G4UIparameter("halfX", 'd', false);
+  halfX->SetParameterRange("halfX>0.");
+  command->SetParameter(halfX);
+  auto halfY = new G4UIparameter("halfY", 'd', false);
+  halfY->SetParameterRange("halfY>0.");
+  command->SetParameter(halfY);
+  command->SetParameter(new G4UIparameter("zFront", 'd', false));
+  command->SetParameter(new G4UIparameter("zBack", 'd', false));
+  auto unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue("cm");
+  unit->SetParameterCandidates(G4UIcommand::UnitsList(
+    G4UIcommand::CategoryOf("cm")));
+  command->SetParameter(unit);
+  command->AvailableForStates(G4State_PreInit, G4State_Idle);
+  command->SetToBeBroadcasted(false);
+  return command;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSDetectorMessenger::ReadLayer(std::istream& stream,
+                                       DMSLayer& layer) const
+{
+  G4String unit;
+  stream >> layer.material >> layer.halfX >> layer.halfY
+         >> layer.zFront >> layer.zBack >> unit;
+  const G4double value = G4UIcommand::ValueOf(unit);
+  layer.halfX  *= value;
+  layer.halfY  *= value;
+  layer.zFront *= value;
+  layer.zBack  *= value;
+  if ( layer.zBack <= layer.zFront ) {
+    G4cerr << "The back face must be behind the front face." << G4endl;
+    return false;
+  }
+  if ( ! DMSDetectorConstruction::CheckMaterial(layer.material) ) {
+    G4cerr << "Unknown material " << layer.material << G4endl;
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSDetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  std::istringstream is(newValue);
+  if ( command == fClearLayersCmd ) {
+    fDetector->ClearLayers();
+  }
+  else if ( command == fAddLayerCmd ) {
+    DMSLayer layer;
+    if ( ReadLayer(is, layer) ) fDetector->AddLayer(layer);
+  }
+  else if ( command == fSetLayerCmd ) {
+    G4int index = 0;
+    DMSLayer layer;
+    is >> index;
+    if ( ReadLayer(is, layer) && ! fDetector->SetLayer(index - 1, layer) ) {
+      G4cerr << "There is no layer" << index << G4endl;
+    }
+  }
+  else if ( command == fSetMaterialCmd ) {
+    G4int index = 0;
+    G4String material;
+    is >> index >> material;
+    if ( ! DMSDetectorConstruction::CheckMaterial(material) ) {
+      G4cerr << "Unknown material " << material << G4endl;
+    }
+    else if ( ! fDetector->SetLayerMaterial(index - 1, material) ) {
+      G4cerr << "There is no layer" << index << G4endl;
+    }
+  }
+  else if ( command == fPrintLayersCmd ) {
+    fDetector->PrintLayers();
+  }
+  else if ( command == fModeCmd ) {
+    fDetector->SetMode(newValue == "nested" ? DMSDetectorConstruction::kNested
+                                            : DMSDetectorConstruction::kBoolean);
+  }
+  else if ( command == fBenchmarkCmd ) {
+    DMSNavigationBenchmark::Run(fDetector,
+                                fBenchmarkCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,299 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSEnergyMesh.cc
+/// \brief Implementation of the DMSEnergyMesh class
+
+#include "DMSEnergyMesh.hh"
+#include "DMSEnergyMeshMessenger.hh"
+#include "DMSDetectorConstruction.hh"
+
+#include "G4LogicalVolumeStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4VSolid.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+  template <class T>
+  void Put(std::ostream& file, T value)
+  {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <class T>
+  G4bool Get(std::istream& file, T& value)
+  {
+    return bool(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSEnergyMesh::DMSEnergyMesh()
+: G4VAccumulable("DMSEnergyMesh"),
+  fMessenger(0),
+  fActive(false),
+  fType(kCartesian),
+  fLower(-120.*cm, -120.*cm, 0.),
+  fUpper(120.*cm, 120.*cm, 120.*cm),
+  fBeamPower(1.),
+  fFileName("DMSEnergyDeposition"),
+  fOutsideEdep(0.),
+  fPrimaryEnergy(0.),
+  fEvents(0)
+{
+  // 5 cm voxels over the six layers
+  SetBins(48, 48, 24);
+  fMessenger = new DMSEnergyMeshMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSEnergyMesh::~DMSEnergyMesh()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEnergyMesh::SetBins(G4int n1, G4int n2, G4int n3)
+{
+  fBins[0] = n1;
+  fBins[1] = n2;
+  fBins[2] = n3;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEnergyMesh::Reset()
+{
+  fVolumeEdep.clear();
+  fOutsideEdep = 0.;
+  fPrimaryEnergy = 0.;
+  fEvents = 0;
+
+  if ( ! fActive ) {
+    std::vector<G4double>().swap(fEdep);
+    return;
+  }
+
+  fMin[0] = fLower.x(); fMax[0] = fUpper.x();
+  fMin[1] = fLower.y(); fMax[1] = fUpper.y();
+  fMin[2] = fLower.z(); fMax[2] = fUpper.z();
+  if ( fType == kCylindrical ) {
+    // r from the axis, phi over the full circle
+    fMin[0] = std::max(0., fMin[0]);
+    fMin[1] = -pi;
+    fMax[1] = pi;
+  }
+  for ( G4int axis = 0; axis < 3; ++axis ) {
+    fInvWidth[axis] = fBins[axis] / ( fMax[axis] - fMin[axis] );
+  }
+
+  // Each thread allocates (and first touches) its own array
+  size_t size = size_t(fBins[0]) * fBins[1] * fBins[2];
+  if ( fEdep.size() == size ) std::fill(fEdep.begin(), fEdep.end(), 0.);
+  else                        fEdep.assign(size, 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEnergyMesh::Merge(const G4VAccumulable& other)
+{
+  const auto& mesh = static_cast<const DMSEnergyMesh&>(other);
+  if ( mesh.fEdep.size() == fEdep.size() ) {
+    for ( size_t i = 0; i < fEdep.size(); ++i ) fEdep[i] += mesh.fEdep[i];
+  }
+  for ( const auto& entry : mesh.fVolumeEdep ) {
+    fVolumeEdep[entry.first] += entry.second;
+  }
+  fOutsideEdep   += mesh.fOutsideEdep;
+  fPrimaryEnergy += mesh.fPrimaryEnergy;
+  fEvents        += mesh.fEvents;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEnergyMesh::Save(std::ostream& stream, G4bool withVoxels) const
+{
+  if ( withVoxels ) {
+    Put<uint64_t>(stream, fEdep.size());
+    stream.write(reinterpret_cast<const char*>(fEdep.data()),
+                 fEdep.size() * sizeof(G4double));
+  }
+
+  // Logical volumes by name, the pointers change between processes
+  Put<uint32_t>(stream, fVolumeEdep.size());
+  for ( const auto& entry : fVolumeEdep ) {
+    const G4String& name = entry.first->GetName();
+    Put<uint32_t>(stream, name.size());
+    stream.write(name.data(), name.size());
+    Put<G4double>(stream, entry.second);
+  }
+  Put<G4double>(stream, fOutsideEdep);
+  Put<G4double>(stream, fPrimaryEnergy);
+  Put<int64_t>(stream, fEvents);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSEnergyMesh::Load(std::istream& stream, G4bool withVoxels)
+{
+  if ( withVoxels ) {
+    uint64_t size = 0;
+    if ( ! Get(stream, size) || size != fEdep.size() ) return false;
+    std::vector<G4double> edep(size);
+    if ( ! stream.read(reinterpret_cast<char*>(edep.data()),
+                       size * sizeof(G4double)) ) return false;
+    for ( size_t i = 0; i < size; ++i ) fEdep[i] += edep[i];
+  }
+
+  uint32_t nVolumes = 0;
+  if ( ! Get(stream, nVolumes) ) return false;
+  for ( uint32_t n = 0; n < nVolumes; ++n ) {
+    uint32_t length = 0;
+    if ( ! Get(stream, length) ) return false;
+    std::string name(length, ' ');
+    stream.read(&name[0], length);
+    G4double volumeEdep = 0.;
+    if ( ! Get(stream, volumeEdep) ) return false;
+    auto volume = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if ( ! volume ) return false;
+    fVolumeEdep[volume] += volumeEdep;
+  }
+
+  G4double outsideEdep = 0.;
+  G4double primaryEnergy = 0.;
+  int64_t events = 0;
+  if ( ! Get(stream, outsideEdep) || ! Get(stream, primaryEnergy)
+       || ! Get(stream, events) ) return false;
+  fOutsideEdep   += outsideEdep;
+  fPrimaryEnergy += primaryEnergy;
+  fEvents        += events;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEnergyMesh::WriteField(const G4String& fileName,
+                               const std::vector<float>& values) const
+{
+  std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+  file.write("DMSM", 4);
+  Put<uint32_t>(file, 1);
+  Put<uint8_t>(file, fType == kCartesian ? 'C' : 'Y');
+
+  // Lengths in cm, the phi axis in rad
+  G4double unit[3] = { cm, cm, cm };
+  if ( fType == kCylindrical ) unit[1] = rad;
+  for ( G4int axis = 0; axis < 3; ++axis ) Put<uint32_t>(file, fBins[axis]);
+  for ( G4int axis = 0; axis < 3; ++axis ) Put<G4double>(file, fMin[axis]/unit[axis]);
+  for ( G4int axis = 0; axis < 3; ++axis ) Put<G4double>(file, fMax[axis]/unit[axis]);
+  Put<G4double>(file, fBeamPower);
+  Put<G4double>(file, fPrimaryEnergy/MeV);
+  Put<uint64_t>(file, fEvents);
+
+  file.write(reinterpret_cast<const char*>(values.data()),
+             values.size() * sizeof(float));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DMSEnergyMesh::GetVolumeEnergy(const G4LogicalVolume* volume) const
+{
+  auto it = fVolumeEdep.find(volume);
+  return ( it != fVolumeEdep.end() ) ? it->second : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEnergyMesh::Write() const
+{
+  if ( ! fActive || fPrimaryEnergy <= 0. ) return;
+
+  const G4double toWatt = GetPowerFactor();
+
+  G4String fileName = fFileName + ".dmsm";
+  const G4double width[3] = { 1./fInvWidth[0], 1./fInvWidth[1], 1./fInvWidth[2] };
+  std::vector<float> density(fEdep.size());
+  G4double peak = 0.;
+  size_t peakIndex = 0;
+  for ( size_t index = 0; index < fEdep.size(); ++index ) {
+    G4double volume = width[0] * width[1] * width[2];
+    if ( fType == kCylindrical ) {
+      G4int i = index % fBins[0];
+      G4double r = fMin[0] + ( i + 0.5 ) * width[0];
+      volume = r * width[0] * width[1] * width[2];
+    }
+    G4double value = fEdep[index] * toWatt / ( volume / cm3 );
+    density[index] = value;
+    if ( value > peak ) {
+      peak = value;
+      peakIndex = index;
+    }
+  }
+  WriteField(fileName, density);
+
+  // Summary per logical volume
+  std::ofstream csv(fFileName + "_layers.csv");
+  csv << "volume,material,power_W,beam_fraction,mean_density_W_per_cm3\n";
+
+  G4cout << G4endl
+         << " Deposited power for a beam power of " << fBeamPower << " W ("
+         << fEvents << " events):" << G4endl;
+  for ( const auto volume : *G4LogicalVolumeStore::GetInstance() ) {
+    auto it = fVolumeEdep.find(volume);
+    if ( it == fVolumeEdep.end() ) continue;
+    G4double power = it->second * toWatt;
+    // Without the layers inside it, which are daughters in nested mode
+    G4double cubicVolume = DMSDetectorConstruction::GetLayerVolume(volume) / cm3;
+    G4cout << "  " << std::setw(10) << volume->GetName()
+           << std::setw(14) << volume->GetMaterial()->GetName()
+           << std::setw(14) << power << " W"
+           << std::setw(12) << power / fBeamPower
+           << std::setw(14) << power / cubicVolume << " W/cm3" << G4endl;
+    csv << volume->GetName() << ',' << volume->GetMaterial()->GetName() << ','
+        << power << ',' << power / fBeamPower << ',' << power / cubicVolume << '\n';
+  }
+  G4cout << "  Outside of the mesh: " << fOutsideEdep * toWatt << " W" << G4endl;
+
+  G4int i = peakIndex % fBins[0];
+  G4int j = ( peakIndex / fBins[0] ) % fBins[1];
+  G4int k = peakIndex / ( size_t(fBins[0]) * fBins[1] );
+  G4cout << "  Peak power density " << peak << " W/cm3 in voxel ("
+         << i << ", " << j << ", " << k << ")" << G4endl
+         << "  Mesh written to " << fileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
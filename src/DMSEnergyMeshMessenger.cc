@@ -0,0 +1,158 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSEnergyMeshMessenger.cc
+/// \brief Implementation of the DMSEnergyMeshMessenger class
+
+#include "DMSEnergyMeshMessenger.hh"
+#include "DMSEnergyMesh.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSEnergyMeshMessenger::DMSEnergyMeshMessenger(DMSEnergyMesh* mesh)
+: G4UImessenger(),
+  fMesh(mesh),
+  fMeshDirectory(0),
+  fActiveCmd(0),
+  fTypeCmd(0),
+  fBinsCmd(0),
+  fLowerCmd(0),
+  fUpperCmd(0),
+  fBeamPowerCmd(0),
+  fFileNameCmd(0)
+{
+  fMeshDirectory = new G4UIdirectory("/dms/mesh/");
+  fMeshDirectory->SetGuidance("Voxel mesh of the deposited energy (power density)");
+
+  fActiveCmd = new G4UIcmdWithABool("/dms/mesh/active", this);
+  fActiveCmd->SetGuidance("Score the deposited energy in the mesh (default false).");
+  fActiveCmd->SetParameterName("active", true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fTypeCmd = new G4UIcmdWithAString("/dms/mesh/type", this);
+  fTypeCmd->SetGuidance("Select the mesh type.");
+  fTypeCmd->SetGuidance("  cartesian   : x, y, z bins (default)");
+  fTypeCmd->SetGuidance("  cylindrical : r, phi, z bins around the beam axis");
+  fTypeCmd->SetParameterName("type", false);
+  fTypeCmd->SetCandidates("cartesian cylindrical");
+  fTypeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBinsCmd = new G4UIcommand("/dms/mesh/bins", this);
+  fBinsCmd->SetGuidance("Number of bins along x, y, z (cylindrical: r, phi, z).");
+  fBinsCmd->SetGuidance("Default 48 48 24, i.e. 5 cm voxels over the dump.");
+  const char* binNames[]  = { "n1", "n2", "n3" };
+  const char* binRanges[] = { "n1>0", "n2>0", "n3>0" };
+  for ( G4int axis = 0; axis < 3; ++axis ) {
+    auto parameter = new G4UIparameter(binNames[axis], 'i', false);
+    parameter->SetParameterRange(binRanges[axis]);
+    fBinsCmd->SetParameter(parameter);
+  }
+  fBinsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fLowerCmd = new G4UIcmdWith3VectorAndUnit("/dms/mesh/lower", this);
+  fLowerCmd->SetGuidance("Lower mesh edges x y z (cylindrical: r, ignored, z).");
+  fLowerCmd->SetGuidance("Default -120 -120 0 cm.");
+  fLowerCmd->SetParameterName("x", "y", "z", false);
+  fLowerCmd->SetUnitCategory("Length");
+  fLowerCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fUpperCmd = new G4UIcmdWith3VectorAndUnit("/dms/mesh/upper", this);
+  fUpperCmd->SetGuidance("Upper mesh edges x y z (cylindrical: r, ignored, z).");
+  fUpperCmd->SetGuidance("Default 120 120 120 cm.");
+  fUpperCmd->SetParameterName("x", "y", "z", false);
+  fUpperCmd->SetUnitCategory("Length");
+  fUpperCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBeamPowerCmd = new G4UIcmdWithADouble("/dms/mesh/beamPower", this);
+  fBeamPowerCmd->SetGuidance("Beam power in W used to convert the deposited energy");
+  fBeamPowerCmd->SetGuidance("into W/cm3 (default 1, i.e. per W of beam).");
+  fBeamPowerCmd->SetParameterName("watts", false);
+  fBeamPowerCmd->SetRange("watts>0.");
+  fBeamPowerCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fFileNameCmd = new G4UIcmdWithAString("/dms/mesh/fileName", this);
+  fFileNameCmd->SetGuidance("Base name of the mesh output (default DMSEnergyDeposition).");
+  fFileNameCmd->SetParameterName("fileName", false);
+  fFileNameCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSEnergyMeshMessenger::~DMSEnergyMeshMessenger()
+{
+  delete fActiveCmd;
+  delete fTypeCmd;
+  delete fBinsCmd;
+  delete fLowerCmd;
+  delete fUpperCmd;
+  delete fBeamPowerCmd;
+  delete fFileNameCmd;
+  delete fMeshDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEnergyMeshMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fActiveCmd ) {
+    fMesh->SetActive(fActiveCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fTypeCmd ) {
+    fMesh->SetType(newValue == "cylindrical" ? DMSEnergyMesh::kCylindrical
+                                             : DMSEnergyMesh::kCartesian);
+  }
+  else if ( command == fBinsCmd ) {
+    G4int n1, n2, n3;
+    std::istringstream is(newValue);
+    is >> n1 >> n2 >> n3;
+    fMesh->SetBins(n1, n2, n3);
+  }
+  else if ( command == fLowerCmd ) {
+    fMesh->SetLower(fLowerCmd->GetNew3VectorValue(newValue));
+  }
+  else if ( command == fUpperCmd ) {
+    fMesh->SetUpper(fUpperCmd->GetNew3VectorValue(newValue));
+  }
+  else if ( command == fBeamPowerCmd ) {
+    fMesh->SetBeamPower(fBeamPowerCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fFileNameCmd ) {
+    fMesh->SetFileName(newValue);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
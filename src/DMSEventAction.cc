@@ -29,15 +29,32 @@
 
 #include "DMSEventAction.hh"
 #include "DMSRunAction.hh"
+#include "DMSEnergyMesh.hh"
+#include "DMSNuclideInventory.hh"
+#include "DMSScalingMonitor.hh"
+#include "DMSDetectorConstruction.hh"
 
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
 #include "G4RunManager.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VProcess.hh"
+#include "G4SystemOfUnits.hh"
+#include "g4root.hh"
+
+#include <cstdint>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DMSEventAction::DMSEventAction(DMSRunAction* runAction)
 : G4UserEventAction(),
-  fRunAction(runAction)
+  fRunAction(runAction),
+  fBuffer(),
+  fDictionary(),
+  fPendingTracks(),
+  fTriggered(false),
+  fGeometryVersion(0)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -49,12 +66,160 @@ DMSEventAction::~DMSEventAction()
 
 void DMSEventAction::BeginOfEventAction(const G4Event*)
 {
+  DMSScalingMonitor::BeginEvent();
+  // The volume codes are cached by pointer, a rebuilt geometry has new
+  // volumes
+  if ( fGeometryVersion != DMSDetectorConstruction::GetGeometryVersion() ) {
+    fGeometryVersion = DMSDetectorConstruction::GetGeometryVersion();
+    fDictionary.ClearVolumeCache();
+  }
+  fBuffer.Clear();
+  fPendingTracks.clear();
+  fTriggered = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEventAction::EndOfEventAction(const G4Event* event)
+{
+  // The mesh and the nuclide inventory are normalised to the primary
+  // energy, whatever the trigger
+  DMSEnergyMesh& mesh = fRunAction->GetEnergyMesh();
+  DMSNuclideInventory& nuclides = fRunAction->GetNuclideInventory();
+  if ( mesh.IsActive() || nuclides.IsActive() ) {
+    G4double energy = 0.;
+    for ( G4int i = 0; i < event->GetNumberOfPrimaryVertex(); ++i ) {
+      const G4PrimaryVertex* vertex = event->GetPrimaryVertex(i);
+      for ( G4int j = 0; j < vertex->GetNumberOfParticle(); ++j ) {
+        energy += vertex->GetPrimary(j)->GetKineticEnergy();
+      }
+    }
+    if ( mesh.IsActive() ) {
+      mesh.CountEvent();
+      mesh.AddPrimaryEnergy(energy);
+    }
+    if ( nuclides.IsActive() ) nuclides.AddPrimaryEnergy(energy);
+  }
+
+  G4bool keep = fTriggered || ! fRunAction->GetEventTrigger().IsActive();
+  fRunAction->CountEvent(keep);
+  if ( keep ) {
+    Flush();
+    fRunAction->EndOfEventOutput(event->GetEventID(), fBuffer.Size());
+  }
+  fBuffer.Clear();
+  fPendingTracks.clear();
+  DMSScalingMonitor::EndEvent();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEventAction::AssignTrackID(const G4Track* track)
+{
+  auto it = fPendingTracks.find(track);
+  if ( it == fPendingTracks.end() ) return;
+  fBuffer.trackID[it->second] = track->GetTrackID();
+  fPendingTracks.erase(it);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEventAction::Flush()
+{
+  const size_t nRows = fBuffer.Size();
+  if ( nRows == 0 ) return;
+
+  const G4bool fillNtuple = fRunAction->GetFillNtuple();
+  const G4bool useCodes = fRunAction->GetUseNameCodes();
+  const G4bool eventLayout = fRunAction->GetEventLayout();
+  DMSHistoManager* histoManager
+    = fRunAction->GetFillHistograms() ? &fRunAction->GetHistoManager() : 0;
+  DMSOutputBatch* batch
+    = ( fillNtuple && fRunAction->GetAsyncOutput() ) ? fRunAction->GetOutputBatch() : 0;
+
+  for ( size_t i = 0; i < nRows; ++i ) {
+    if ( histoManager ) {
+      histoManager->Fill(fBuffer.particle[i], fBuffer.kinE[i], fBuffer.dirZ[i],
+                         fBuffer.z[i], histoManager->GetVolumeIndex(fBuffer.volume[i]));
+    }
+    if ( batch ) FillBatchRow(batch, i, eventLayout);
+    else if ( fillNtuple ) FillNtupleRow(i, useCodes, eventLayout);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEventAction::FillNtupleRow(size_t i, G4bool useCodes, G4bool eventLayout)
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+
+  G4int column = 0;
+  if ( useCodes ) {
+    analysisManager->FillNtupleIColumn(column++, fDictionary.GetCode(fBuffer.process[i]));
+    analysisManager->FillNtupleIColumn(column++, fDictionary.GetCode(fBuffer.particle[i]));
+    if ( ! eventLayout ) {
+      analysisManager->FillNtupleIColumn(column++, fDictionary.GetCode(fBuffer.mother[i]));
+    }
+    analysisManager->FillNtupleIColumn(column++, fDictionary.GetCode(fBuffer.volume[i]));
+  }
+  else {
+    // Process Name
+    analysisManager->FillNtupleSColumn(column++, fBuffer.process[i]->GetProcessName());
+    // Name of daughter particle
+    analysisManager->FillNtupleSColumn(column++, fBuffer.particle[i]->GetParticleName());
+    // Name of mother particle
+    if ( ! eventLayout ) {
+      analysisManager->FillNtupleSColumn(column++, fBuffer.mother[i]->GetParticleName());
+    }
+    // Name of volume where particle produced
+    analysisManager->FillNtupleSColumn(column++, fBuffer.volume[i]->GetName());
+  }
+  // Genealogy
+  if ( eventLayout ) {
+    analysisManager->FillNtupleIColumn(column++, fBuffer.trackID[i]);
+    analysisManager->FillNtupleIColumn(column++, fBuffer.parentID[i]);
+  }
+  // Kinematics, in the columns and precision selected in DMSRunAction
+  const auto& kinematics = fRunAction->GetKinematics();
+  for ( size_t k = 0; k < kinematics.size(); ++k ) {
+    G4double value = fBuffer.Get(kinematics[k].quantity, i)
+                   / DMSOutputSchema::GetQuantityUnit(kinematics[k].quantity);
+    if ( kinematics[k].type == 'F' ) {
+      analysisManager->FillNtupleFColumn(column + k, value);
+    }
+    else {
+      analysisManager->FillNtupleDColumn(column + k, value);
+    }
+  }
+
+  analysisManager->AddNtupleRow();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void DMSEventAction::EndOfEventAction(const G4Event*)
+void DMSEventAction::FillBatchRow(DMSOutputBatch* batch, size_t i,
+                                  G4bool eventLayout)
 {
+  // Same columns and units as the ntuple with the "codes" encoding
+  size_t column = 0;
+  batch->Append<int32_t>(column++, fDictionary.GetCode(fBuffer.process[i]));
+  batch->Append<int32_t>(column++, fDictionary.GetCode(fBuffer.particle[i]));
+  if ( ! eventLayout ) {
+    batch->Append<int32_t>(column++, fDictionary.GetCode(fBuffer.mother[i]));
+  }
+  batch->Append<int32_t>(column++, fDictionary.GetCode(fBuffer.volume[i]));
+  if ( eventLayout ) {
+    batch->Append<int32_t>(column++, fBuffer.trackID[i]);
+    batch->Append<int32_t>(column++, fBuffer.parentID[i]);
+  }
+  const auto& kinematics = fRunAction->GetKinematics();
+  for ( size_t k = 0; k < kinematics.size(); ++k ) {
+    G4double value = fBuffer.Get(kinematics[k].quantity, i)
+                   / DMSOutputSchema::GetQuantityUnit(kinematics[k].quantity);
+    if ( kinematics[k].type == 'F' ) batch->Append<G4float>(column + k, value);
+    else                             batch->Append<G4double>(column + k, value);
+  }
+  ++batch->rows;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSEventSeeder.cc
+/// \brief Implementation of the DMSEventSeeder class
+
+#include "DMSEventSeeder.hh"
+#include "DMSEventSeederMessenger.hh"
+#include "DMSCheckpoint.hh"
+
+#include "G4RunManager.hh"
+#include "Randomize.hh"
+
+G4long DMSEventSeeder::fgSeed = 1;
+G4int  DMSEventSeeder::fgFirstEvent = 0;
+G4bool DMSEventSeeder::fgActive = true;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSEventSeeder::DMSEventSeeder()
+: fMessenger(0)
+{
+  fMessenger = new DMSEventSeederMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSEventSeeder::~DMSEventSeeder()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSEventSeeder::GetEventNumber(G4int eventID)
+{
+  return fgFirstEvent + DMSCheckpoint::GetEventOffset() + eventID;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEventSeeder::SeedEvent(G4int eventID)
+{
+  if ( ! fgActive ) return;
+
+  // Two 31 bit seeds, never 0, which ends the seed list
+  uint64_t state = uint64_t(fgSeed);
+  state = SplitMix64(state) ^ uint64_t(GetEventNumber(eventID));
+  long seeds[3];
+  seeds[0] = long(SplitMix64(state) >> 33) + 1;
+  seeds[1] = long(SplitMix64(state) >> 33) + 1;
+  seeds[2] = 0;
+  G4Random::setTheSeeds(seeds);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEventSeeder::RerunEvent(G4int eventNumber)
+{
+  if ( ! fgActive ) {
+    G4cerr << "DMSEventSeeder: /dms/random/perEvent is off, the event cannot"
+           << " be reproduced alone." << G4endl;
+    return;
+  }
+  const G4int firstEvent = fgFirstEvent;
+  fgFirstEvent = eventNumber;
+  G4cout << "DMSEventSeeder: running event " << eventNumber << " of seed "
+         << fgSeed << G4endl;
+  G4RunManager::GetRunManager()->BeamOn(1);
+  fgFirstEvent = firstEvent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
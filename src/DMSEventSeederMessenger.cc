@@ -0,0 +1,110 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSEventSeederMessenger.cc
+/// \brief Implementation of the DMSEventSeederMessenger class
+
+#include "DMSEventSeederMessenger.hh"
+#include "DMSEventSeeder.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSEventSeederMessenger::DMSEventSeederMessenger(DMSEventSeeder* seeder)
+: G4UImessenger(),
+  fSeeder(seeder),
+  fRandomDirectory(0),
+  fSeedCmd(0),
+  fFirstEventCmd(0),
+  fPerEventCmd(0),
+  fRerunEventCmd(0)
+{
+  fRandomDirectory = new G4UIdirectory("/dms/random/");
+  fRandomDirectory->SetGuidance("Per-event random seeds");
+
+  fSeedCmd = new G4UIcmdWithAnInteger("/dms/random/seed", this);
+  fSeedCmd->SetGuidance("Run seed the event seeds are derived from (default 1).");
+  fSeedCmd->SetParameterName("seed", false);
+  fSeedCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fSeedCmd->SetToBeBroadcasted(false);
+
+  fFirstEventCmd = new G4UIcmdWithAnInteger("/dms/random/firstEvent", this);
+  fFirstEventCmd->SetGuidance("Number of the first event of the next runs (default 0).");
+  fFirstEventCmd->SetParameterName("event", false);
+  fFirstEventCmd->SetRange("event>=0");
+  fFirstEventCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fFirstEventCmd->SetToBeBroadcasted(false);
+
+  fPerEventCmd = new G4UIcmdWithABool("/dms/random/perEvent", this);
+  fPerEventCmd->SetGuidance("Seed every event from (seed, event number) (default");
+  fPerEventCmd->SetGuidance("true); false keeps the seeding of the run manager.");
+  fPerEventCmd->SetParameterName("perEvent", true);
+  fPerEventCmd->SetDefaultValue(true);
+  fPerEventCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fPerEventCmd->SetToBeBroadcasted(false);
+
+  fRerunEventCmd = new G4UIcmdWithAnInteger("/dms/random/rerunEvent", this);
+  fRerunEventCmd->SetGuidance("Simulate the event with the given number alone, e.g.");
+  fRerunEventCmd->SetGuidance("with /tracking/verbose to look at a slow event.");
+  fRerunEventCmd->SetParameterName("event", false);
+  fRerunEventCmd->SetRange("event>=0");
+  fRerunEventCmd->AvailableForStates(G4State_Idle);
+  fRerunEventCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSEventSeederMessenger::~DMSEventSeederMessenger()
+{
+  delete fSeedCmd;
+  delete fFirstEventCmd;
+  delete fPerEventCmd;
+  delete fRerunEventCmd;
+  delete fRandomDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSEventSeederMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fSeedCmd ) {
+    DMSEventSeeder::SetSeed(fSeedCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fFirstEventCmd ) {
+    DMSEventSeeder::SetFirstEvent(fFirstEventCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fPerEventCmd ) {
+    DMSEventSeeder::SetActive(fPerEventCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fRerunEventCmd ) {
+    fSeeder->RerunEvent(fRerunEventCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,175 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSHistoManager.cc
+/// \brief Implementation of the DMSHistoManager class
+
+#include "DMSHistoManager.hh"
+#include "DMSOutputSchema.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4SystemOfUnits.hh"
+#include "g4root.hh"
+
+#include <algorithm>
+
+namespace
+{
+  // Energy axis, log binned in MeV: thermal neutrons up to the beam energy
+  const G4int    kEnergyBins = 150;
+  const G4double kEnergyMin  = 1.e-11;
+  const G4double kEnergyMax  = 1.e4;
+  const G4int    kMaxVolumes = 16;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSHistoManager::DMSHistoManager()
+: fNeutronEId(-1),
+  fEnergyVolumeId(-1),
+  fCosThetaEnergyId(-1),
+  fZParticleId(-1)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSHistoManager::~DMSHistoManager()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSHistoManager::Book()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  const auto& h1Names = DMSOutputSchema::GetH1Names();
+  const auto& h2Names = DMSOutputSchema::GetH2Names();
+
+  fNeutronEId = analysisManager->CreateH1(h1Names[0],
+    "Neutron kinetic energy [MeV]",
+    kEnergyBins, kEnergyMin, kEnergyMax, "none", "none", "log");
+
+  fEnergyVolumeId = analysisManager->CreateH2(h2Names[0],
+    "Kinetic energy [MeV] vs production volume index",
+    kEnergyBins, kEnergyMin, kEnergyMax, kMaxVolumes, -0.5, kMaxVolumes - 0.5,
+    "none", "none", "none", "none", "log", "linear");
+
+  fCosThetaEnergyId = analysisManager->CreateH2(h2Names[1],
+    "cos(theta) to the beam axis vs kinetic energy [MeV]",
+    100, -1., 1., kEnergyBins, kEnergyMin, kEnergyMax,
+    "none", "none", "none", "none", "linear", "log");
+
+  fZParticleId = analysisManager->CreateH2(h2Names[2],
+    "Production z [cm] vs particle category",
+    140, -10., 130., kNumberOfCategories, -0.5, kNumberOfCategories - 0.5,
+    "none", "none", "none", "none", "linear", "linear");
+
+  // Only written when the histogram mode is selected
+  analysisManager->SetActivation(true);
+  SetActivation(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSHistoManager::SetActivation(G4bool active)
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->SetH1Activation(fNeutronEId, active);
+  analysisManager->SetH2Activation(fEnergyVolumeId, active);
+  analysisManager->SetH2Activation(fCosThetaEnergyId, active);
+  analysisManager->SetH2Activation(fZParticleId, active);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSHistoManager::Reset()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->GetH1(fNeutronEId)->reset();
+  analysisManager->GetH2(fEnergyVolumeId)->reset();
+  analysisManager->GetH2(fCosThetaEnergyId)->reset();
+  analysisManager->GetH2(fZParticleId)->reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSHistoManager::ClearCache()
+{
+  fVolumeIndex.clear();
+  fCategory.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSHistoManager::Fill(const G4ParticleDefinition* particle,
+                           G4double kineticEnergy, G4double cosTheta,
+                           G4double z, G4int volumeIndex)
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+
+  const G4double kinE = kineticEnergy/MeV;
+  const G4int category = GetCategory(particle);
+
+  if ( category == kNeutron ) analysisManager->FillH1(fNeutronEId, kinE);
+  analysisManager->FillH2(fEnergyVolumeId, kinE, volumeIndex);
+  analysisManager->FillH2(fCosThetaEnergyId, cosTheta, kinE);
+  analysisManager->FillH2(fZParticleId, z/cm, category);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSHistoManager::ResolveVolumeIndex(const G4LogicalVolume* volume)
+{
+  auto store = G4LogicalVolumeStore::GetInstance();
+  auto it = std::find(store->begin(), store->end(), volume);
+  G4int index = ( it != store->end() ) ? G4int(it - store->begin()) : -1;
+  fVolumeIndex[volume] = index;
+  return index;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSHistoManager::GetCategory(const G4ParticleDefinition* particle)
+{
+  auto it = fCategory.find(particle);
+  if ( it != fCategory.end() ) return it->second;
+
+  const G4String& name = particle->GetParticleName();
+  G4int category = kOther;
+  if      ( name == "gamma" )   category = kGamma;
+  else if ( name == "e-" )      category = kElectron;
+  else if ( name == "e+" )      category = kPositron;
+  else if ( name == "neutron" ) category = kNeutron;
+  else if ( name == "proton" )  category = kProton;
+  else if ( name == "pi+" || name == "pi-" || name == "pi0" ) category = kPion;
+  else if ( particle->GetParticleType() == "nucleus" ) category = kIon;
+
+  fCategory[particle] = category;
+  return category;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
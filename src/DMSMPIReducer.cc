@@ -0,0 +1,178 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSMPIReducer.cc
+/// \brief Implementation of the DMSMPIReducer class
+
+#ifdef DMS_WITH_MPI
+
+#include "DMSMPIReducer.hh"
+#include "DMSRunAction.hh"
+#include "DMSShard.hh"
+#include "DMSEnergyMesh.hh"
+#include "DMSNuclideInventory.hh"
+
+#include "G4MPIhistoMerger.hh"
+#include "g4root.hh"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // Largest piece of a message, so that the counts fit in an int
+  const uint64_t kChunkSize = 1 << 26;
+
+  // Reads a received buffer in place
+  class BufferStream : public std::streambuf
+  {
+    public:
+      BufferStream(char* data, size_t size) { setg(data, data, data + size); }
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSMPIReducer::Reduce(DMSRunAction& runAction, G4int nEvents,
+                           G4double seconds)
+{
+  const G4int rank = DMSShard::GetIndex();
+  const G4int size = DMSShard::GetCount();
+
+  // Histograms; the other ranks clear theirs so that summing all files
+  // with dms-merge does not count them twice
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4MPIhistoMerger histoMerger(analysisManager);
+  histoMerger.Merge();
+  if ( rank != 0 ) runAction.GetHistoManager().Reset();
+  if ( analysisManager->IsOpenFile() ) {
+    analysisManager->Write();
+    analysisManager->CloseFile();
+  }
+
+  // Counters, summed into rank 0
+  G4double counters[3];
+  runAction.GetCounters(counters);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : counters, counters, 3, MPI_DOUBLE,
+             MPI_SUM, 0, MPI_COMM_WORLD);
+  if ( rank == 0 ) runAction.SetCounters(counters);
+
+  // Voxels of the mesh, summed in place piece by piece; all the ranks
+  // must have the same mesh
+  DMSEnergyMesh& mesh = runAction.GetEnergyMesh();
+  std::vector<G4double>& voxels = mesh.GetEnergy();
+  const uint64_t nVoxels = voxels.size();
+  uint64_t smallest = 0;
+  uint64_t largest = 0;
+  MPI_Allreduce(&nVoxels, &smallest, 1, MPI_UINT64_T, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(&nVoxels, &largest, 1, MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+  G4bool matching = ( smallest == largest );
+  if ( matching ) {
+    for ( uint64_t first = 0; first < nVoxels; first += kChunkSize ) {
+      const G4int count = G4int(std::min(kChunkSize, nVoxels - first));
+      MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &voxels[first], &voxels[first],
+                 count, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    }
+  }
+
+  // The sums per volume and the nuclide inventory, sent rank by rank to
+  // rank 0, which adds them through one buffer
+  std::string buffer;
+  if ( rank != 0 ) {
+    std::ostringstream stream;
+    mesh.Save(stream, false);
+    runAction.GetNuclideInventory().Save(stream);
+    buffer = stream.str();
+    uint64_t bufferSize = buffer.size();
+    MPI_Send(&bufferSize, 1, MPI_UINT64_T, 0, 0, MPI_COMM_WORLD);
+    for ( uint64_t first = 0; first < bufferSize; first += kChunkSize ) {
+      MPI_Send(&buffer[first], G4int(std::min(kChunkSize, bufferSize - first)),
+               MPI_CHAR, 0, 0, MPI_COMM_WORLD);
+    }
+  }
+  else {
+    for ( G4int r = 1; r < size; ++r ) {
+      uint64_t bufferSize = 0;
+      MPI_Recv(&bufferSize, 1, MPI_UINT64_T, r, 0, MPI_COMM_WORLD,
+               MPI_STATUS_IGNORE);
+      buffer.resize(bufferSize);
+      for ( uint64_t first = 0; first < bufferSize; first += kChunkSize ) {
+        MPI_Recv(&buffer[first], G4int(std::min(kChunkSize, bufferSize - first)),
+                 MPI_CHAR, r, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+      }
+      BufferStream data(&buffer[0], bufferSize);
+      std::istream scorers(&data);
+      if ( matching && mesh.Load(scorers, false)
+           && runAction.GetNuclideInventory().Load(scorers) ) continue;
+      matching = false;
+    }
+  }
+
+  G4double stats[2] = { G4double(nEvents), seconds };
+  std::vector<G4double> allStats(2 * size, 0.);
+  MPI_Gather(stats, 2, MPI_DOUBLE, allStats.data(), 2, MPI_DOUBLE, 0,
+             MPI_COMM_WORLD);
+  if ( rank != 0 ) return;
+
+  if ( ! matching ) {
+    G4ExceptionDescription description;
+    description << "The scorers of the ranks do not match those of rank 0.";
+    G4Exception("DMSMPIReducer::Reduce", "DMSMPI001",
+                FatalException, description);
+    return;
+  }
+
+  G4double totalEvents = 0.;
+  G4double longest = 0.;
+  G4cout << G4endl << " Events per rank:" << G4endl;
+  for ( G4int r = 0; r < size; ++r ) {
+    const G4double events = allStats[2*r];
+    const G4double time = allStats[2*r + 1];
+    G4cout << "  rank " << std::setw(4) << r
+           << std::setw(12) << G4long(events) << " events"
+           << std::setw(10) << time << " s"
+           << std::setw(12) << ( time > 0. ? events / time : 0. ) << " events/s"
+           << G4endl;
+    totalEvents += events;
+    longest = std::max(longest, time);
+  }
+  G4cout << "  total " << G4long(totalEvents) << " events in " << longest
+         << " s, " << ( longest > 0. ? totalEvents / longest : 0. )
+         << " events/s" << G4endl;
+
+  runAction.WriteResults(G4int(totalEvents));
+}
+
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
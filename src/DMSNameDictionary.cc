@@ -0,0 +1,116 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSNameDictionary.cc
+/// \brief Implementation of the DMSNameDictionary class
+
+#include "DMSNameDictionary.hh"
+
+#include "G4VProcess.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4LogicalVolume.hh"
+#include "G4AutoLock.hh"
+
+#include <map>
+
+namespace
+{
+  G4Mutex dictionaryMutex = G4MUTEX_INITIALIZER;
+
+  // Global tables, guarded by dictionaryMutex
+  std::map<G4String, G4int> codeOfName[DMSNameDictionary::kNumberOfKinds];
+  std::vector<G4String> nameOfCode[DMSNameDictionary::kNumberOfKinds];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSNameDictionary::DMSNameDictionary()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSNameDictionary::~DMSNameDictionary()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSNameDictionary::Insert(Kind kind, const void* key)
+{
+  // Cache miss: resolve the name once and register it globally
+  G4String name = "none";
+  if ( key ) {
+    switch ( kind ) {
+      case kProcess:
+        name = static_cast<const G4VProcess*>(key)->GetProcessName();
+        break;
+      case kParticle:
+        name = static_cast<const G4ParticleDefinition*>(key)->GetParticleName();
+        break;
+      case kVolume:
+        name = static_cast<const G4LogicalVolume*>(key)->GetName();
+        break;
+      default:
+        break;
+    }
+  }
+
+  G4int code = Register(kind, name);
+  fCache[kind][key] = code;
+  return code;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSNameDictionary::Register(Kind kind, const G4String& name)
+{
+  G4AutoLock lock(&dictionaryMutex);
+
+  auto it = codeOfName[kind].find(name);
+  if ( it != codeOfName[kind].end() ) return it->second;
+
+  G4int code = nameOfCode[kind].size();
+  codeOfName[kind][name] = code;
+  nameOfCode[kind].push_back(name);
+  return code;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4String> DMSNameDictionary::GetNames(Kind kind)
+{
+  G4AutoLock lock(&dictionaryMutex);
+  return nameOfCode[kind];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* DMSNameDictionary::GetKindName(Kind kind)
+{
+  static const char* names[kNumberOfKinds] = { "process", "particle", "volume" };
+  return names[kind];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,269 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSNavigationBenchmark.cc
+/// \brief Implementation of the DMSNavigationBenchmark class
+
+#include "DMSNavigationBenchmark.hh"
+#include "DMSDetectorConstruction.hh"
+
+#include "G4GeometryManager.hh"
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Material.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4UnitsTable.hh"
+#include "geomdefs.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace {
+  // Bounding box of the layers
+  struct Extent
+  {
+    G4double halfX;
+    G4double halfY;
+    G4double zMin;
+    G4double zMax;
+  };
+
+  Extent GetExtent(const std::vector<DMSLayer>& layers)
+  {
+    Extent extent = { 0., 0., DBL_MAX, -DBL_MAX };
+    for ( const DMSLayer& layer : layers ) {
+      extent.halfX = std::max(extent.halfX, layer.halfX);
+      extent.halfY = std::max(extent.halfY, layer.halfY);
+      extent.zMin  = std::min(extent.zMin, layer.zFront);
+      extent.zMax  = std::max(extent.zMax, layer.zBack);
+    }
+    return extent;
+  }
+
+  G4ThreeVector RandomPoint(std::mt19937_64& engine, const Extent& extent)
+  {
+    std::uniform_real_distribution<G4double> flat(0., 1.);
+    return G4ThreeVector(extent.halfX * ( 2. * flat(engine) - 1. ),
+                         extent.halfY * ( 2. * flat(engine) - 1. ),
+                         extent.zMin + ( extent.zMax - extent.zMin ) * flat(engine));
+  }
+
+  G4ThreeVector RandomDirection(std::mt19937_64& engine)
+  {
+    std::uniform_real_distribution<G4double> flat(0., 1.);
+    const G4double cosTheta = 2. * flat(engine) - 1.;
+    const G4double sinTheta = std::sqrt(1. - cosTheta * cosTheta);
+    const G4double phi = twopi * flat(engine);
+    return G4ThreeVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi),
+                         cosTheta);
+  }
+
+  const G4int kMaxSteps = 10000;
+  const std::mt19937_64::result_type kSeed = 20240601;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSNavigationBenchmark::Run(const DMSDetectorConstruction* detector,
+                                 G4int nRays)
+{
+  const std::vector<DMSLayer>& layers = detector->GetLayers();
+  if ( layers.empty() || nRays <= 0 ) return;
+  const Extent extent = GetExtent(layers);
+
+  G4GeometryManager* geometryManager = G4GeometryManager::GetInstance();
+  const G4bool wasClosed = geometryManager->IsGeometryClosed();
+
+  // Everything created from here on is deleted at the end
+  G4PhysicalVolumeStore* physicalStore = G4PhysicalVolumeStore::GetInstance();
+  G4LogicalVolumeStore* logicalStore = G4LogicalVolumeStore::GetInstance();
+  G4SolidStore* solidStore = G4SolidStore::GetInstance();
+  const size_t nPhysical = physicalStore->size();
+  const size_t nLogical = logicalStore->size();
+  const size_t nSolid = solidStore->size();
+
+  const DMSDetectorConstruction::Mode modes[2]
+    = { DMSDetectorConstruction::kBoolean, DMSDetectorConstruction::kNested };
+  const char* modeNames[2] = { "boolean", "nested" };
+  G4VPhysicalVolume* worlds[2];
+  std::vector<const G4LogicalVolume*> layerVolumes[2];
+  for ( G4int m = 0; m < 2; ++m ) {
+    const size_t first = logicalStore->size();
+    worlds[m] = detector->BuildWorld(modes[m], false);
+    for ( size_t i = first; i < logicalStore->size(); ++i ) {
+      if ( (*logicalStore)[i] != worlds[m]->GetLogicalVolume() ) {
+        layerVolumes[m].push_back((*logicalStore)[i]);
+      }
+    }
+  }
+
+  G4cout << G4endl
+         << "--------------------Navigation benchmark--------------------"
+         << G4endl
+         << " " << nRays << " rays from random points in the dump" << G4endl
+         << std::setw(10) << "geometry" << std::setw(12) << "steps"
+         << std::setw(12) << "seconds" << std::setw(14) << "steps/s"
+         << std::setw(14) << "ns/step" << G4endl;
+
+  for ( G4int m = 0; m < 2; ++m ) {
+    // The flag of the manager is global: opening a world without
+    // optimisations only clears it, the voxels of the runs stay
+    geometryManager->OpenGeometry(worlds[m]);
+    geometryManager->CloseGeometry(true, false, worlds[m]);
+
+    G4Navigator navigator;
+    navigator.SetWorldVolume(worlds[m]);
+    std::mt19937_64 engine(kSeed);
+    G4long steps = 0;
+
+    const std::chrono::steady_clock::time_point start
+      = std::chrono::steady_clock::now();
+    for ( G4int i = 0; i < nRays; ++i ) {
+      G4ThreeVector position = RandomPoint(engine, extent);
+      const G4ThreeVector direction = RandomDirection(engine);
+      G4VPhysicalVolume* volume
+        = navigator.LocateGlobalPointAndSetup(position, &direction, false, false);
+      for ( G4int n = 0; n < kMaxSteps && volume && volume != worlds[m]; ++n ) {
+        G4double safety = 0.;
+        const G4double step
+          = navigator.ComputeStep(position, direction, kInfinity, safety);
+        if ( step == kInfinity ) break;
+        position += step * direction;
+        navigator.SetGeometricallyLimitedStep();
+        volume = navigator.LocateGlobalPointAndSetup(position, &direction, true);
+        ++steps;
+      }
+    }
+    const G4double seconds = std::chrono::duration<G4double>(
+      std::chrono::steady_clock::now() - start).count();
+
+    geometryManager->OpenGeometry(worlds[m]);
+
+    G4cout << std::setw(10) << modeNames[m] << std::setw(12) << steps
+           << std::setw(12) << std::setprecision(4) << seconds
+           << std::setw(14) << std::setprecision(4)
+           << ( seconds > 0. ? steps / seconds : 0. )
+           << std::setw(14) << std::setprecision(4)
+           << ( steps > 0 ? 1.e9 * seconds / steps : 0. ) << G4endl;
+  }
+
+  // Equivalence: the material at the same points, in a box 10% larger
+  // than the dump so that the outer faces are sampled too
+  Extent sampled = extent;
+  const G4double margin = 0.1 * ( extent.zMax - extent.zMin );
+  sampled.halfX *= 1.1;
+  sampled.halfY *= 1.1;
+  sampled.zMin  -= margin;
+  sampled.zMax  += margin;
+
+  G4Navigator navigators[2];
+  navigators[0].SetWorldVolume(worlds[0]);
+  navigators[1].SetWorldVolume(worlds[1]);
+  std::mt19937_64 engine(kSeed + 1);
+  G4int mismatches = 0;
+  for ( G4int i = 0; i < nRays; ++i ) {
+    const G4ThreeVector point = RandomPoint(engine, sampled);
+    const G4VPhysicalVolume* volumes[2];
+    for ( G4int m = 0; m < 2; ++m ) {
+      volumes[m] = navigators[m].LocateGlobalPointAndSetup(point, 0, false);
+    }
+    const G4Material* material0
+      = volumes[0] ? volumes[0]->GetLogicalVolume()->GetMaterial() : 0;
+    const G4Material* material1
+      = volumes[1] ? volumes[1]->GetLogicalVolume()->GetMaterial() : 0;
+    if ( material0 != material1 ) {
+      if ( mismatches < 10 ) {
+        G4cout << " Mismatch at " << G4BestUnit(point, "Length") << ": "
+               << ( volumes[0] ? volumes[0]->GetName() : "none" ) << " / "
+               << ( volumes[1] ? volumes[1]->GetName() : "none" ) << G4endl;
+      }
+      ++mismatches;
+    }
+  }
+  G4cout << " Material map: " << mismatches << " of " << nRays
+         << " random points differ between the geometries"
+         << ( mismatches == 0 ? " (equivalent)" : "" ) << G4endl;
+
+  // The volume and mass of every layer, as used for the W/cm3 of the
+  // energy mesh and the Bq/g of the activation, in both geometries
+  G4cout << " Layer volumes and masses:" << G4endl
+         << std::setw(10) << "layer" << std::setw(16) << "boolean cm3"
+         << std::setw(16) << "nested cm3" << std::setw(14) << "boolean kg"
+         << std::setw(14) << "nested kg" << G4endl;
+  G4int differences = 0;
+  for ( size_t i = 0; i < layerVolumes[0].size(); ++i ) {
+    G4double cubicVolume[2];
+    G4double mass[2];
+    for ( G4int m = 0; m < 2; ++m ) {
+      const G4LogicalVolume* volume = layerVolumes[m][i];
+      cubicVolume[m] = DMSDetectorConstruction::GetLayerVolume(volume);
+      mass[m] = cubicVolume[m] * volume->GetMaterial()->GetDensity();
+    }
+    if ( std::abs(cubicVolume[0] - cubicVolume[1]) > 1.e-9 * cubicVolume[0] ) {
+      ++differences;
+    }
+    G4cout << std::setw(10) << layerVolumes[0][i]->GetName()
+           << std::setw(16) << std::setprecision(8) << cubicVolume[0] / cm3
+           << std::setw(16) << std::setprecision(8) << cubicVolume[1] / cm3
+           << std::setw(14) << std::setprecision(6) << mass[0] / kg
+           << std::setw(14) << std::setprecision(6) << mass[1] / kg << G4endl;
+  }
+  G4cout << " Layer volumes: " << differences << " of "
+         << layerVolumes[0].size() << " layers differ between the geometries"
+         << G4endl
+         << "------------------------------------------------------------"
+         << G4endl;
+
+  // Delete the benchmark volumes, daughters first
+  std::vector<G4VPhysicalVolume*> physicals(physicalStore->begin() + nPhysical,
+                                            physicalStore->end());
+  std::vector<G4LogicalVolume*> logicals(logicalStore->begin() + nLogical,
+                                         logicalStore->end());
+  std::vector<G4VSolid*> solids(solidStore->begin() + nSolid, solidStore->end());
+  for ( auto physical : physicals ) delete physical;
+  for ( auto logical : logicals ) delete logical;
+  for ( auto solid : solids ) delete solid;
+
+  // Restore the flag, with the optimisations of the geometry of the runs
+  if ( wasClosed ) {
+    G4VPhysicalVolume* world = G4TransportationManager::GetTransportationManager()
+                                 ->GetNavigatorForTracking()->GetWorldVolume();
+    geometryManager->CloseGeometry(true, false, world);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,229 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSNuclideInventory.cc
+/// \brief Implementation of the DMSNuclideInventory class
+
+#include "DMSNuclideInventory.hh"
+#include "DMSNuclideInventoryMessenger.hh"
+
+#include "G4IonTable.hh"
+#include "G4PhysicalVolumeStore.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <iomanip>
+#include <map>
+#include <string>
+
+namespace
+{
+  template <class T>
+  void Put(std::ostream& file, T value)
+  {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <class T>
+  G4bool Get(std::istream& file, T& value)
+  {
+    return bool(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSNuclideInventory::DMSNuclideInventory()
+: G4VAccumulable("DMSNuclideInventory"),
+  fMessenger(0),
+  fActive(false),
+  fDecayProducts(false),
+  fPrintLimit(20),
+  fFileName("DMSNuclides"),
+  fMap(),
+  fPrimaryEnergy(0.)
+{
+  fMessenger = new DMSNuclideInventoryMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSNuclideInventory::~DMSNuclideInventory()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSNuclideInventory::Reset()
+{
+  fMap.Clear();
+  fPrimaryEnergy = 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSNuclideInventory::Merge(const G4VAccumulable& other)
+{
+  const DMSNuclideInventory& inventory
+    = static_cast<const DMSNuclideInventory&>(other);
+  for ( const auto& slot : inventory.fMap.GetSlots() ) {
+    if ( slot.key ) fMap.Add(slot.key, slot.value);
+  }
+  fPrimaryEnergy += inventory.fPrimaryEnergy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSNuclideInventory::Save(std::ostream& stream) const
+{
+  // Entries by volume; the instance IDs of the keys change between
+  // processes, so the volumes are saved by name
+  std::map<G4int, std::vector<DMSNuclideMap::Slot> > volumes;
+  for ( const auto& slot : fMap.GetSlots() ) {
+    if ( slot.key ) volumes[Nuclide(slot.key).volumeID].push_back(slot);
+  }
+  std::map<G4int, G4String> volumeNames;
+  for ( const auto volume : *G4PhysicalVolumeStore::GetInstance() ) {
+    volumeNames[volume->GetInstanceID()] = volume->GetName();
+  }
+
+  Put<uint32_t>(stream, volumes.size());
+  for ( const auto& volume : volumes ) {
+    const G4String& name = volumeNames[volume.first];
+    Put<uint32_t>(stream, name.size());
+    stream.write(name.data(), name.size());
+    Put<uint64_t>(stream, volume.second.size());
+    stream.write(reinterpret_cast<const char*>(volume.second.data()),
+                 volume.second.size() * sizeof(DMSNuclideMap::Slot));
+  }
+  Put<G4double>(stream, fPrimaryEnergy);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSNuclideInventory::Load(std::istream& stream)
+{
+  // Read everything before adding, so that a bad stream adds nothing
+  std::vector<DMSNuclideMap::Slot> entries;
+  uint32_t nVolumes = 0;
+  if ( ! Get(stream, nVolumes) ) return false;
+  for ( uint32_t n = 0; n < nVolumes; ++n ) {
+    uint32_t length = 0;
+    if ( ! Get(stream, length) ) return false;
+    std::string name(length, ' ');
+    stream.read(&name[0], length);
+    uint64_t size = 0;
+    if ( ! Get(stream, size) ) return false;
+    const G4VPhysicalVolume* volume
+      = G4PhysicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if ( ! volume ) return false;
+
+    // Keyed again with the instance ID of the volume in this process
+    std::vector<DMSNuclideMap::Slot> slots(size);
+    stream.read(reinterpret_cast<char*>(slots.data()),
+                size * sizeof(DMSNuclideMap::Slot));
+    if ( ! stream ) return false;
+    for ( auto& slot : slots ) {
+      Nuclide nuclide(slot.key);
+      slot.key = Key(nuclide.Z, nuclide.A, nuclide.isomer,
+                     volume->GetInstanceID(), nuclide.copyNumber);
+      entries.push_back(slot);
+    }
+  }
+  G4double primaryEnergy = 0.;
+  if ( ! Get(stream, primaryEnergy) ) return false;
+
+  for ( const auto& slot : entries ) fMap.Add(slot.key, slot.value);
+  fPrimaryEnergy += primaryEnergy;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSNuclideInventory::Write(G4int nPrimaries) const
+{
+  if ( ! fActive || nPrimaries <= 0 ) return;
+
+  // The key order is volume, copy number, Z, A, isomer level
+  std::vector<DMSNuclideMap::Slot> entries;
+  entries.reserve(fMap.Size());
+  for ( const auto& slot : fMap.GetSlots() ) {
+    if ( slot.key ) entries.push_back(slot);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const DMSNuclideMap::Slot& a, const DMSNuclideMap::Slot& b)
+            { return a.key < b.key; });
+
+  std::map<G4int, G4String> volumeNames;
+  for ( const auto volume : *G4PhysicalVolumeStore::GetInstance() ) {
+    volumeNames[volume->GetInstanceID()] = volume->GetName();
+  }
+  G4IonTable* ionTable = G4IonTable::GetIonTable();
+
+  std::ofstream csv(fFileName + ".csv");
+  csv << "volume,copy,Z,A,isomer,nuclide,count,per_primary\n";
+  std::map<std::pair<G4int, G4int>, std::pair<G4int, G4double> > layers;
+  for ( const auto& entry : entries ) {
+    Nuclide nuclide(entry.key);
+    csv << volumeNames[nuclide.volumeID] << ',' << nuclide.copyNumber << ','
+        << nuclide.Z << ',' << nuclide.A << ',' << nuclide.isomer << ','
+        << ionTable->GetIonName(nuclide.Z, nuclide.A, nuclide.isomer) << ','
+        << entry.value << ',' << entry.value / nPrimaries << '\n';
+    auto& layer = layers[std::make_pair(nuclide.volumeID, nuclide.copyNumber)];
+    ++layer.first;
+    layer.second += entry.value;
+  }
+
+  G4cout << G4endl
+         << " Residual nuclides per primary (" << nPrimaries << " primaries, "
+         << entries.size() << " entries):" << G4endl;
+  for ( const auto& layer : layers ) {
+    G4cout << "  " << std::setw(10) << volumeNames[layer.first.first]
+           << " copy " << std::setw(3) << layer.first.second
+           << std::setw(8) << layer.second.first << " nuclides"
+           << std::setw(14) << layer.second.second / nPrimaries << G4endl;
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const DMSNuclideMap::Slot& a, const DMSNuclideMap::Slot& b)
+            { return a.value > b.value; });
+  const size_t printed = std::min(entries.size(), size_t(fPrintLimit));
+  if ( printed ) G4cout << "  Most produced:" << G4endl;
+  for ( size_t index = 0; index < printed; ++index ) {
+    Nuclide nuclide(entries[index].key);
+    G4cout << "  " << std::setw(10) << volumeNames[nuclide.volumeID]
+           << " copy " << std::setw(3) << nuclide.copyNumber
+           << std::setw(12)
+           << ionTable->GetIonName(nuclide.Z, nuclide.A, nuclide.isomer)
+           << std::setw(14) << entries[index].value / nPrimaries << G4endl;
+  }
+  G4cout << "  Inventory written to " << fFileName << ".csv" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
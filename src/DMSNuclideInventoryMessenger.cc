@@ -0,0 +1,107 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSNuclideInventoryMessenger.cc
+/// \brief Implementation of the DMSNuclideInventoryMessenger class
+
+#include "DMSNuclideInventoryMessenger.hh"
+#include "DMSNuclideInventory.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSNuclideInventoryMessenger::DMSNuclideInventoryMessenger(DMSNuclideInventory* inventory)
+: G4UImessenger(),
+  fInventory(inventory),
+  fNuclidesDirectory(0),
+  fActiveCmd(0),
+  fDecayProductsCmd(0),
+  fPrintCmd(0),
+  fFileNameCmd(0)
+{
+  fNuclidesDirectory = new G4UIdirectory("/dms/nuclides/");
+  fNuclidesDirectory->SetGuidance("Residual nuclide inventory per layer");
+
+  fActiveCmd = new G4UIcmdWithABool("/dms/nuclides/active", this);
+  fActiveCmd->SetGuidance("Count the produced nuclei per volume (default false).");
+  fActiveCmd->SetParameterName("active", true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fDecayProductsCmd = new G4UIcmdWithABool("/dms/nuclides/decayProducts", this);
+  fDecayProductsCmd->SetGuidance("Also count the products of radioactive decays");
+  fDecayProductsCmd->SetGuidance("(default false: only what the beam produces).");
+  fDecayProductsCmd->SetParameterName("decayProducts", true);
+  fDecayProductsCmd->SetDefaultValue(true);
+  fDecayProductsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPrintCmd = new G4UIcmdWithAnInteger("/dms/nuclides/print", this);
+  fPrintCmd->SetGuidance("Number of most produced nuclides printed at the end of");
+  fPrintCmd->SetGuidance("the run (default 20); the file always has all of them.");
+  fPrintCmd->SetParameterName("entries", false);
+  fPrintCmd->SetRange("entries>=0");
+  fPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fFileNameCmd = new G4UIcmdWithAString("/dms/nuclides/fileName", this);
+  fFileNameCmd->SetGuidance("Base name of the inventory output (default DMSNuclides).");
+  fFileNameCmd->SetParameterName("fileName", false);
+  fFileNameCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSNuclideInventoryMessenger::~DMSNuclideInventoryMessenger()
+{
+  delete fActiveCmd;
+  delete fDecayProductsCmd;
+  delete fPrintCmd;
+  delete fFileNameCmd;
+  delete fNuclidesDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSNuclideInventoryMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fActiveCmd ) {
+    fInventory->SetActive(fActiveCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fDecayProductsCmd ) {
+    fInventory->SetDecayProducts(fDecayProductsCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fPrintCmd ) {
+    fInventory->SetPrintLimit(fPrintCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fFileNameCmd ) {
+    fInventory->SetFileName(newValue);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,272 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSOutputSchema.cc
+/// \brief Implementation of the DMSOutputSchema class
+
+#include "DMSOutputSchema.hh"
+#include "DMSNameDictionary.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "g4root.hh"
+
+#include <sstream>
+
+namespace
+{
+  struct CodeColumn
+  {
+    const char* codeName;
+    const char* nameName;
+    G4int       kind;
+  };
+
+  const CodeColumn kCodeColumns[] = {
+    { "procID",     "procName",     DMSNameDictionary::kProcess },
+    { "particleID", "particleName", DMSNameDictionary::kParticle },
+    { "motherID",   "motherName",   DMSNameDictionary::kParticle },
+    { "volumeID",   "volumeName",   DMSNameDictionary::kVolume }
+  };
+
+  const char* kQuantityNames[DMSOutputSchema::kNumberOfQuantities] = {
+    "kinE", "x", "y", "z", "global_t", "local_t",
+    "px", "py", "pz", "pdir_x", "pdir_y", "pdir_z"
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<DMSNtupleColumn>
+DMSOutputSchema::GetSecondaryColumns(G4bool useCodes,
+                                     const std::vector<DMSKinematicColumn>& kinematics,
+                                     G4bool eventLayout)
+{
+  // The name columns hold either the names or their DMSNameDictionary
+  // codes; in the event layout the mother follows from the parentID
+  std::vector<DMSNtupleColumn> columns;
+  for ( const auto& column : kCodeColumns ) {
+    if ( eventLayout && G4String(column.codeName) == "motherID" ) continue;
+    if ( useCodes ) columns.push_back({ column.codeName, 'I' });
+    else            columns.push_back({ column.nameName, 'S' });
+  }
+  if ( eventLayout ) {
+    columns.push_back({ "trackID", 'I' });
+    columns.push_back({ "parentID", 'I' });
+  }
+  for ( const auto& column : kinematics ) {
+    columns.push_back({ GetQuantityName(column.quantity), column.type });
+  }
+  return columns;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<DMSNtupleColumn> DMSOutputSchema::GetDictionaryColumns()
+{
+  // kind is a DMSNameDictionary::Kind
+  return { { "kind", 'I' }, { "code", 'I' }, { "name", 'S' } };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<DMSNtupleColumn> DMSOutputSchema::GetSchemaColumns()
+{
+  // type is the DMSNtupleColumn type character
+  return { { "index", 'I' }, { "column", 'S' }, { "type", 'I' } };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<DMSNtupleColumn> DMSOutputSchema::GetEventColumns()
+{
+  // The secondaries of an event follow those of the previous row
+  return { { "eventID", 'I' }, { "nSecondaries", 'I' } };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* DMSOutputSchema::GetQuantityName(G4int quantity)
+{
+  return kQuantityNames[quantity];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DMSOutputSchema::GetQuantityUnit(G4int quantity)
+{
+  switch ( quantity ) {
+    case kKinE: case kPx: case kPy: case kPz:  return MeV;
+    case kX: case kY: case kZ:                 return cm;
+    case kGlobalTime: case kLocalTime:         return ns;
+    default:                                   return 1.;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<DMSKinematicColumn> DMSOutputSchema::GetDefaultKinematics(char type)
+{
+  return { { kKinE, type }, { kX, type }, { kY, type }, { kZ, type },
+           { kGlobalTime, type },
+           { kDirX, type }, { kDirY, type }, { kDirZ, type } };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<DMSKinematicColumn> DMSOutputSchema::GetAllKinematics(char type)
+{
+  std::vector<DMSKinematicColumn> kinematics;
+  for ( G4int quantity = 0; quantity < kNumberOfQuantities; ++quantity ) {
+    kinematics.push_back({ quantity, type });
+  }
+  return kinematics;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSOutputSchema::ParseKinematics(const G4String& list, char defaultType,
+                                        std::vector<DMSKinematicColumn>& kinematics,
+                                        G4String* error)
+{
+  std::vector<DMSKinematicColumn> result;
+  // A quantity selected twice would book two columns of the same name
+  auto add = [&](const DMSKinematicColumn& column) {
+    for ( const auto& selected : result ) {
+      if ( selected.quantity != column.quantity ) continue;
+      if ( error ) {
+        *error = G4String(kQuantityNames[column.quantity]) + " is selected twice";
+      }
+      return false;
+    }
+    result.push_back(column);
+    return true;
+  };
+
+  std::istringstream is(list);
+  G4String token;
+  while ( is >> token ) {
+    if ( token == "default" || token == "all" ) {
+      auto selection = ( token == "all" ) ? GetAllKinematics(defaultType)
+                                          : GetDefaultKinematics(defaultType);
+      for ( const auto& column : selection ) {
+        if ( ! add(column) ) return false;
+      }
+      continue;
+    }
+
+    char type = defaultType;
+    auto colon = token.find(':');
+    if ( colon != std::string::npos ) {
+      G4String suffix = token.substr(colon + 1);
+      token = token.substr(0, colon);
+      if ( suffix == "F" || suffix == "f" )      type = 'F';
+      else if ( suffix == "D" || suffix == "d" ) type = 'D';
+      else {
+        if ( error ) *error = "unknown suffix :" + suffix;
+        return false;
+      }
+    }
+
+    G4int quantity = 0;
+    while ( quantity < kNumberOfQuantities && token != kQuantityNames[quantity] ) {
+      ++quantity;
+    }
+    if ( quantity == kNumberOfQuantities ) {
+      if ( error ) *error = "unknown column " + token;
+      return false;
+    }
+    if ( ! add({ quantity, type }) ) return false;
+  }
+  if ( result.empty() ) {
+    if ( error ) *error = "no columns";
+    return false;
+  }
+
+  kinematics = result;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSOutputSchema::GetCodeKind(const G4String& column)
+{
+  for ( const auto& codeColumn : kCodeColumns ) {
+    if ( column == codeColumn.codeName ) return codeColumn.kind;
+  }
+  return -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String DMSOutputSchema::GetNameColumn(const G4String& codeColumn)
+{
+  for ( const auto& column : kCodeColumns ) {
+    if ( codeColumn == column.codeName ) return column.nameName;
+  }
+  return codeColumn;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSOutputSchema::CreateNtuple(const G4String& name, const G4String& title,
+                                    const std::vector<DMSNtupleColumn>& columns)
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+
+  G4int id = analysisManager->CreateNtuple(name, title);
+  for ( const auto& column : columns ) {
+    switch ( column.type ) {
+      case 'I': analysisManager->CreateNtupleIColumn(column.name); break;
+      case 'F': analysisManager->CreateNtupleFColumn(column.name); break;
+      case 'D': analysisManager->CreateNtupleDColumn(column.name); break;
+      case 'S': analysisManager->CreateNtupleSColumn(column.name); break;
+      default:
+        G4Exception("DMSOutputSchema::CreateNtuple", "DMSOutput001",
+                    FatalException, "Unknown column type");
+    }
+  }
+  analysisManager->FinishNtuple();
+  return id;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<G4String>& DMSOutputSchema::GetH1Names()
+{
+  static const std::vector<G4String> names = { "neutronE" };
+  return names;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<G4String>& DMSOutputSchema::GetH2Names()
+{
+  static const std::vector<G4String> names
+    = { "kinE_volume", "cosTheta_kinE", "z_particle" };
+  return names;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,182 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhaseSpaceFile.cc
+/// \brief Implementation of the DMSPhaseSpaceFile class
+
+#include "DMSPhaseSpaceFile.hh"
+
+#include "G4AutoLock.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <ostream>
+
+namespace
+{
+  const uint32_t kVersion = 1;
+  const size_t kHeaderSize = 16;
+
+  G4Mutex phaseSpaceMutex = G4MUTEX_INITIALIZER;
+
+  int64_t ModificationTime(const struct stat& status)
+  {
+    return int64_t(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+  }
+}
+
+DMSPhaseSpaceFile::Registry DMSPhaseSpaceFile::fgRegistry;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhaseSpaceFile::Registry::~Registry()
+{
+  for ( auto& entry : files ) {
+    for ( auto file : entry.second ) delete file;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const DMSPhaseSpaceFile* DMSPhaseSpaceFile::Open(const G4String& fileName)
+{
+  G4AutoLock lock(&phaseSpaceMutex);
+
+  struct stat status;
+  if ( ::stat(fileName.c_str(), &status) != 0 ) {
+    G4ExceptionDescription description;
+    description << "Cannot read the phase-space file " << fileName;
+    G4Exception("DMSPhaseSpaceFile::Open", "DMSPhaseSpace001",
+                JustWarning, description);
+    return 0;
+  }
+
+  // The last mapping of the file, if it is still current
+  std::vector<DMSPhaseSpaceFile*>& mappings = fgRegistry.files[fileName];
+  if ( ! mappings.empty()
+       && mappings.back()->fMapSize == size_t(status.st_size)
+       && mappings.back()->fModified == ModificationTime(status) ) {
+    return mappings.back();
+  }
+
+  DMSPhaseSpaceFile* file = new DMSPhaseSpaceFile(fileName);
+  if ( ! file->fRecords ) {
+    delete file;
+    return 0;
+  }
+  mappings.push_back(file);
+  return file;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhaseSpaceFile::DMSPhaseSpaceFile(const G4String& fileName)
+: fFileName(fileName),
+  fMap(0),
+  fMapSize(0),
+  fModified(0),
+  fRecords(0),
+  fNumberOfRecords(0),
+  fNumberOfPrimaries(0)
+{
+  G4ExceptionDescription description;
+  const int descriptor = ::open(fileName.c_str(), O_RDONLY);
+  struct stat status;
+  if ( descriptor < 0 || ::fstat(descriptor, &status) != 0 ) {
+    description << "Cannot read the phase-space file " << fileName;
+  }
+  else if ( size_t(status.st_size) < kHeaderSize ) {
+    description << fileName << " is not a phase-space file";
+  }
+  else {
+    fMapSize = status.st_size;
+    fModified = ModificationTime(status);
+    fMap = ::mmap(0, fMapSize, PROT_READ, MAP_SHARED, descriptor, 0);
+    if ( fMap == MAP_FAILED ) {
+      fMap = 0;
+      description << "Cannot map the phase-space file " << fileName;
+    }
+  }
+  // The mapping stays valid after the descriptor is closed
+  if ( descriptor >= 0 ) ::close(descriptor);
+
+  if ( fMap ) {
+    const char* data = static_cast<const char*>(fMap);
+    uint32_t header[4];
+    std::memcpy(header, data, kHeaderSize);
+    if ( std::memcmp(data, "DMSP", 4) != 0 || header[1] != kVersion
+         || header[2] != sizeof(DMSPhaseSpaceRecord) ) {
+      description << fileName << " is not a phase-space file of version "
+                  << kVersion;
+    }
+    else {
+      fNumberOfRecords = ( fMapSize - kHeaderSize ) / sizeof(DMSPhaseSpaceRecord);
+      fNumberOfPrimaries = header[3];
+      if ( fNumberOfRecords == 0 ) {
+        description << "The phase-space file " << fileName << " is empty";
+      }
+      else {
+        fRecords = reinterpret_cast<const DMSPhaseSpaceRecord*>(data + kHeaderSize);
+      }
+    }
+  }
+
+  if ( ! fRecords ) {
+    G4Exception("DMSPhaseSpaceFile::DMSPhaseSpaceFile", "DMSPhaseSpace001",
+                JustWarning, description);
+  }
+  else {
+    G4cout << "Phase-space file " << fileName << ": " << fNumberOfRecords
+           << " particles";
+    if ( fNumberOfPrimaries > 0 ) {
+      G4cout << " from " << fNumberOfPrimaries << " primaries";
+    }
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhaseSpaceFile::~DMSPhaseSpaceFile()
+{
+  if ( fMap ) ::munmap(fMap, fMapSize);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPhaseSpaceFile::WriteHeader(std::ostream& file, uint32_t nPrimaries)
+{
+  const uint32_t header[3]
+    = { kVersion, uint32_t(sizeof(DMSPhaseSpaceRecord)), nPrimaries };
+  file.write("DMSP", 4);
+  file.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
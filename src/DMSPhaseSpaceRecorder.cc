@@ -0,0 +1,211 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhaseSpaceRecorder.cc
+/// \brief Implementation of the DMSPhaseSpaceRecorder class
+
+#include "DMSPhaseSpaceRecorder.hh"
+#include "DMSPhaseSpaceRecorderMessenger.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4AutoLock.hh"
+
+#include <cstdio>
+
+namespace
+{
+  G4Mutex recorderMutex = G4MUTEX_INITIALIZER;
+
+  // Records buffered by a thread before they are written
+  const size_t kBufferSize = 4096;
+}
+
+G4ThreadLocal std::vector<DMSPhaseSpaceRecord>*
+  DMSPhaseSpaceRecorder::fgBuffer = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhaseSpaceRecorder* DMSPhaseSpaceRecorder::Instance()
+{
+  static DMSPhaseSpaceRecorder instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhaseSpaceRecorder::DMSPhaseSpaceRecorder()
+: fMessenger(0),
+  fVolumeName(""),
+  fFileName("DMSPhaseSpace"),
+  fKill(false),
+  fVolume(0),
+  fOutputName(""),
+  fFile(),
+  fRecords(0)
+{
+  fMessenger = new DMSPhaseSpaceRecorderMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhaseSpaceRecorder::~DMSPhaseSpaceRecorder()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPhaseSpaceRecorder::SetVolumeName(const G4String& name)
+{
+  fVolumeName = ( name == "none" ) ? G4String("") : name;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPhaseSpaceRecorder::Open(const G4String& suffix)
+{
+  fVolume = 0;
+  if ( ! IsActive() ) return;
+
+  // The volume of the current geometry
+  fVolume = G4LogicalVolumeStore::GetInstance()->GetVolume(fVolumeName, false);
+  if ( ! fVolume ) {
+    G4ExceptionDescription description;
+    description << "There is no volume " << fVolumeName
+                << "; no phase-space file is written.";
+    G4Exception("DMSPhaseSpaceRecorder::Open", "DMSPhaseSpace004",
+                JustWarning, description);
+    return;
+  }
+
+  fOutputName = fFileName + suffix + ".dmsps";
+  const G4String tmpName = fOutputName + ".tmp";
+  fFile.open(tmpName, std::ios::binary | std::ios::trunc);
+  if ( ! fFile ) {
+    G4ExceptionDescription description;
+    description << "Cannot write " << tmpName;
+    G4Exception("DMSPhaseSpaceRecorder::Open", "DMSPhaseSpace005",
+                JustWarning, description);
+    fVolume = 0;
+    return;
+  }
+  // The number of primaries is known at the end of the run, see Close()
+  DMSPhaseSpaceFile::WriteHeader(fFile, 0);
+  fRecords = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPhaseSpaceRecorder::Close(G4int nEvents)
+{
+  if ( ! fVolume ) return;
+
+  // The buffer of the master, in sequential mode
+  Flush();
+  fVolume = 0;
+
+  fFile.seekp(0);
+  DMSPhaseSpaceFile::WriteHeader(fFile, uint32_t(nEvents));
+  fFile.close();
+  const G4String tmpName = fOutputName + ".tmp";
+  if ( ! fFile || std::rename(tmpName.c_str(), fOutputName.c_str()) != 0 ) {
+    G4ExceptionDescription description;
+    description << "Cannot write " << fOutputName;
+    G4Exception("DMSPhaseSpaceRecorder::Close", "DMSPhaseSpace005",
+                JustWarning, description);
+    return;
+  }
+
+  G4cout << G4endl
+         << " Phase-space file " << fOutputName << ": " << fRecords
+         << " particles into " << fVolumeName;
+  if ( nEvents > 0 ) {
+    G4cout << ", " << G4double(fRecords) / nEvents << " per primary";
+  }
+  G4cout << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSPhaseSpaceRecorder::Record(const G4Step* step)
+{
+  if ( ! fVolume ) return false;
+
+  const G4StepPoint* postStepPoint = step->GetPostStepPoint();
+  if ( postStepPoint->GetStepStatus() != fGeomBoundary ) return false;
+  const G4VPhysicalVolume* post = postStepPoint->GetPhysicalVolume();
+  if ( ! post || post->GetLogicalVolume() != fVolume ) return false;
+  if ( step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()
+       == fVolume ) return false;
+
+  const G4Track* track = step->GetTrack();
+  const G4ThreeVector& position = postStepPoint->GetPosition();
+  const G4ThreeVector& direction = postStepPoint->GetMomentumDirection();
+
+  DMSPhaseSpaceRecord record;
+  record.pdg    = track->GetDefinition()->GetPDGEncoding();
+  record.weight = postStepPoint->GetWeight();
+  record.x  = position.x() / mm;
+  record.y  = position.y() / mm;
+  record.z  = position.z() / mm;
+  record.ux = direction.x();
+  record.uy = direction.y();
+  record.uz = direction.z();
+  record.kineticEnergy = postStepPoint->GetKineticEnergy() / MeV;
+  record.time = postStepPoint->GetGlobalTime() / ns;
+
+  if ( ! fgBuffer ) {
+    fgBuffer = new std::vector<DMSPhaseSpaceRecord>;
+    fgBuffer->reserve(kBufferSize);
+  }
+  fgBuffer->push_back(record);
+  if ( fgBuffer->size() == kBufferSize ) Flush();
+
+  return fKill;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPhaseSpaceRecorder::Flush()
+{
+  if ( ! fgBuffer || fgBuffer->empty() ) return;
+
+  G4AutoLock lock(&recorderMutex);
+  if ( fFile.is_open() ) {
+    fFile.write(reinterpret_cast<const char*>(fgBuffer->data()),
+                fgBuffer->size() * sizeof(DMSPhaseSpaceRecord));
+    fRecords += fgBuffer->size();
+  }
+  fgBuffer->clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
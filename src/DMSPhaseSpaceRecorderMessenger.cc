@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhaseSpaceRecorderMessenger.cc
+/// \brief Implementation of the DMSPhaseSpaceRecorderMessenger class
+
+#include "DMSPhaseSpaceRecorderMessenger.hh"
+#include "DMSPhaseSpaceRecorder.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhaseSpaceRecorderMessenger::DMSPhaseSpaceRecorderMessenger(
+  DMSPhaseSpaceRecorder* recorder)
+: G4UImessenger(),
+  fRecorder(recorder),
+  fPhaseSpaceDirectory(0),
+  fRecordCmd(0),
+  fFileNameCmd(0),
+  fKillCmd(0)
+{
+  fPhaseSpaceDirectory = new G4UIdirectory("/dms/phaseSpace/");
+  fPhaseSpaceDirectory->SetGuidance("Recording of the particles crossing into a volume");
+
+  fRecordCmd = new G4UIcmdWithAString("/dms/phaseSpace/record", this);
+  fRecordCmd->SetGuidance("Record the particles entering the logical volume, e.g.");
+  fRecordCmd->SetGuidance("layer5, or none (default).");
+  fRecordCmd->SetParameterName("volume", false);
+  fRecordCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fRecordCmd->SetToBeBroadcasted(false);
+
+  fFileNameCmd = new G4UIcmdWithAString("/dms/phaseSpace/fileName", this);
+  fFileNameCmd->SetGuidance("Base name of the phase-space file (default DMSPhaseSpace).");
+  fFileNameCmd->SetParameterName("fileName", false);
+  fFileNameCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fFileNameCmd->SetToBeBroadcasted(false);
+
+  fKillCmd = new G4UIcmdWithABool("/dms/phaseSpace/kill", this);
+  fKillCmd->SetGuidance("Stop the recorded particles (default false).");
+  fKillCmd->SetParameterName("kill", true);
+  fKillCmd->SetDefaultValue(true);
+  fKillCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fKillCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhaseSpaceRecorderMessenger::~DMSPhaseSpaceRecorderMessenger()
+{
+  delete fRecordCmd;
+  delete fFileNameCmd;
+  delete fKillCmd;
+  delete fPhaseSpaceDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPhaseSpaceRecorderMessenger::SetNewValue(G4UIcommand* command,
+                                                 G4String newValue)
+{
+  if ( command == fRecordCmd ) {
+    fRecorder->SetVolumeName(newValue);
+  }
+  else if ( command == fFileNameCmd ) {
+    fRecorder->SetFileName(newValue);
+  }
+  else if ( command == fKillCmd ) {
+    fRecorder->SetKill(fKillCmd->GetNewBoolValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,250 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhysicsTableCache.cc
+/// \brief Implementation of the DMSPhysicsTableCache class
+
+#include "DMSPhysicsTableCache.hh"
+#include "DMSPhysicsTableCacheMessenger.hh"
+#include "DMSStartupTimer.hh"
+
+#include "G4VModularPhysicsList.hh"
+#include "G4VPhysicsConstructor.hh"
+#include "G4StateManager.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4Version.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+// Written last into a table directory, its presence marks complete tables
+const char* const kInfoFileName = "DMSPhysicsTableCache.txt";
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhysicsTableCache::DMSPhysicsTableCache(G4VModularPhysicsList* physicsList)
+: G4VStateDependent(),
+  fPhysicsList(physicsList),
+  fMessenger(0),
+  fDirectory("physicsTables"),
+  fEnabled(true),
+  fKey(0),
+  fMode(kNone),
+  fTableDirectory(),
+  fDescription(),
+  fBuildSeconds(0.)
+{
+  fMessenger = new DMSPhysicsTableCacheMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhysicsTableCache::~DMSPhysicsTableCache()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSPhysicsTableCache::Notify(G4ApplicationState requestedState)
+{
+  const G4ApplicationState state
+    = G4StateManager::GetStateManager()->GetCurrentState();
+
+  if ( state == G4State_Idle && requestedState == G4State_Init ) {
+    // Every run initialization; the tables are (re)built after this only
+    // when the physics or the material-cuts couples have changed
+    if ( ! fEnabled ) {
+      if ( fKey != 0 ) fPhysicsList->ResetPhysicsTableRetrieved();
+      fKey = 0;
+      return true;
+    }
+    std::string description;
+    const uint64_t key = ComputeKey(description);
+    if ( key == fKey && GetTableDirectory(key) == fTableDirectory ) {
+      return true;
+    }
+    fKey = key;
+    fTableDirectory = GetTableDirectory(key);
+
+    std::ifstream info(fTableDirectory + "/" + kInfoFileName);
+    G4String word;
+    if ( info >> word >> fBuildSeconds ) {
+      fPhysicsList->SetPhysicsTableRetrieved(fTableDirectory);
+      fMode = kRetrieve;
+    }
+    else {
+      fPhysicsList->ResetPhysicsTableRetrieved();
+      fMode = kStore;
+      fDescription = description;
+    }
+  }
+  else if ( state == G4State_Idle && requestedState == G4State_GeomClosed
+            && fMode != kNone ) {
+    // The tables of the run are built
+    const G4double seconds = DMSStartupTimer::Instance()->GetTablesSeconds();
+    if ( fMode == kRetrieve ) {
+      G4cout << " Physics tables retrieved from " << fTableDirectory
+             << " in " << seconds << " s (built in " << fBuildSeconds
+             << " s when cached)" << G4endl;
+    }
+    else {
+      fBuildSeconds = seconds;
+      Store();
+    }
+    fMode = kNone;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+uint64_t DMSPhysicsTableCache::ComputeKey(std::string& description) const
+{
+  std::ostringstream text;
+  text << std::setprecision(17);
+  text << "geant4 " << G4VERSION_NUMBER << "\n";
+
+  for ( G4int i = 0; fPhysicsList->GetPhysics(i); ++i ) {
+    text << "physics " << fPhysicsList->GetPhysics(i)->GetPhysicsName() << "\n";
+  }
+
+  for ( const G4Material* material : *G4Material::GetMaterialTable() ) {
+    text << "material " << material->GetName()
+         << ' ' << material->GetDensity()
+         << ' ' << material->GetState()
+         << ' ' << material->GetTemperature()
+         << ' ' << material->GetPressure();
+    const G4double* fractions = material->GetFractionVector();
+    for ( size_t i = 0; i < material->GetNumberOfElements(); ++i ) {
+      const G4Element* element = material->GetElement(i);
+      text << ' ' << element->GetName() << ' ' << element->GetZ()
+           << ' ' << element->GetN() << ' ' << fractions[i];
+    }
+    text << "\n";
+  }
+
+  for ( const G4LogicalVolume* volume : *G4LogicalVolumeStore::GetInstance() ) {
+    text << "volume " << volume->GetName()
+         << ' ' << volume->GetMaterial()->GetName()
+         << ' ' << ( volume->GetRegion() ? volume->GetRegion()->GetName()
+                                         : G4String("-") ) << "\n";
+  }
+
+  for ( const G4Region* region : *G4RegionStore::GetInstance() ) {
+    text << "region " << region->GetName();
+    const G4ProductionCuts* cuts = region->GetProductionCuts();
+    if ( cuts ) {
+      for ( G4int i = 0; i < 4; ++i ) text << ' ' << cuts->GetProductionCut(i);
+    }
+    text << "\n";
+  }
+  description = text.str();
+
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for ( unsigned char c : description ) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String DMSPhysicsTableCache::GetTableDirectory(uint64_t key) const
+{
+  std::ostringstream name;
+  name << fDirectory << '/' << std::hex << std::setw(16) << std::setfill('0')
+       << key;
+  return name.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPhysicsTableCache::Store()
+{
+  // Stored under a name of this job and renamed when complete, so that
+  // jobs sharing the cache never retrieve partial tables
+  std::ostringstream tmpName;
+  tmpName << fTableDirectory << ".tmp" << getpid() << '_'
+          << std::chrono::system_clock::now().time_since_epoch().count();
+  const G4String tmpDirectory = tmpName.str();
+
+  const std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  G4bool stored = fPhysicsList->StorePhysicsTable(tmpDirectory);
+  if ( stored ) {
+    std::ofstream info(tmpDirectory + "/" + kInfoFileName);
+    info << "buildSeconds " << fBuildSeconds << "\n" << fDescription;
+    info.close();
+    stored = info.good();
+  }
+  if ( stored && std::rename(tmpDirectory.c_str(),
+                             fTableDirectory.c_str()) != 0 ) {
+    // Another job has cached the same tables meanwhile
+    stored = false;
+    std::ifstream info(fTableDirectory + "/" + kInfoFileName);
+    if ( ! info ) {
+      G4ExceptionDescription description;
+      description << "Cannot rename " << tmpDirectory << " to "
+                  << fTableDirectory << ".";
+      G4Exception("DMSPhysicsTableCache::Store", "DMSPhysicsTableCache001",
+                  JustWarning, description);
+    }
+  }
+  if ( ! stored ) {
+    // Geant4 itself creates the directory with "mkdir -p"
+    std::error_code error;
+    std::filesystem::remove_all(tmpDirectory.c_str(), error);
+    if ( error ) {
+      G4cerr << "Cannot remove " << tmpDirectory << ": " << error.message()
+             << G4endl;
+    }
+    return;
+  }
+  const G4double seconds = std::chrono::duration<G4double>(
+    std::chrono::steady_clock::now() - start).count();
+  G4cout << " Physics tables built in " << fBuildSeconds << " s, cached in "
+         << fTableDirectory << " (" << seconds << " s)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,88 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPhysicsTableCacheMessenger.cc
+/// \brief Implementation of the DMSPhysicsTableCacheMessenger class
+
+#include "DMSPhysicsTableCacheMessenger.hh"
+#include "DMSPhysicsTableCache.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhysicsTableCacheMessenger::DMSPhysicsTableCacheMessenger(
+  DMSPhysicsTableCache* cache)
+: G4UImessenger(),
+  fCache(cache),
+  fCacheDirectory(0),
+  fEnableCmd(0),
+  fDirectoryCmd(0)
+{
+  fCacheDirectory = new G4UIdirectory("/dms/physicsCache/");
+  fCacheDirectory->SetGuidance("Cache of the physics tables between jobs");
+
+  fEnableCmd = new G4UIcmdWithABool("/dms/physicsCache/enable", this);
+  fEnableCmd->SetGuidance("Retrieve the physics tables from the cache, or build");
+  fEnableCmd->SetGuidance("and store them there (default true).");
+  fEnableCmd->SetParameterName("enable", true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fEnableCmd->SetToBeBroadcasted(false);
+
+  fDirectoryCmd = new G4UIcmdWithAString("/dms/physicsCache/directory", this);
+  fDirectoryCmd->SetGuidance("Directory of the cache (default physicsTables);");
+  fDirectoryCmd->SetGuidance("it can be shared by concurrent jobs.");
+  fDirectoryCmd->SetParameterName("directory", false);
+  fDirectoryCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fDirectoryCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPhysicsTableCacheMessenger::~DMSPhysicsTableCacheMessenger()
+{
+  delete fEnableCmd;
+  delete fDirectoryCmd;
+  delete fCacheDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPhysicsTableCacheMessenger::SetNewValue(G4UIcommand* command,
+                                                G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fCache->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fDirectoryCmd ) {
+    fCache->SetDirectory(newValue);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
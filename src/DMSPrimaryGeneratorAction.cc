@@ -28,23 +28,75 @@
 /// \brief Implementation of the DMSPrimaryGeneratorAction class
 
 #include "DMSPrimaryGeneratorAction.hh"
+#include "DMSPrimaryGeneratorMessenger.hh"
+#include "DMSPhaseSpaceFile.hh"
+#include "DMSEventSeeder.hh"
 
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
-#include "G4Box.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4VisExtent.hh"
 #include "G4RunManager.hh"
+#include "G4Run.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
+#include "G4IonTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4AutoLock.hh"
 #include "Randomize.hh"
 
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+  // The beam starts this far in front of the dump face
+  const G4double kFaceGap = 1.*mm;
+
+  G4Mutex sourceMutex = G4MUTEX_INITIALIZER;
+
+  // Triangular sweep between -1 and 1 with a period of the given events
+  G4double Sweep(G4int eventNumber, G4int period)
+  {
+    if ( period <= 0 ) return 0.;
+    const G4double phase = ( eventNumber % period + 0.5 ) / period;
+    return 4. * std::abs(phase - 0.5) - 1.;
+  }
+}
+
+G4double DMSPrimaryGeneratorAction::fgSourcePrimariesPerEvent = 0.;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DMSPrimaryGeneratorAction::DMSPrimaryGeneratorAction()
 : G4VUserPrimaryGeneratorAction(),
   fParticleGun(0),
-  fEnvelopeBox(0)
+  fMessenger(0),
+  fSigmaX(0.),
+  fSigmaY(0.),
+  fDivergenceX(0.),
+  fDivergenceY(0.),
+  fRasterX(0.),
+  fRasterY(0.),
+  fRasterPeriodX(1000),
+  fRasterPeriodY(997),
+  fCentre(),
+  fStartAtFace(true),
+  fFaceZ(0.),
+  fPhaseSpaceName(""),
+  fPhaseSpace(0),
+  fParticlesPerEvent(1),
+  fRecycle(1),
+  fRotation(kNoRotation),
+  fCursor(0),
+  fDefinitions(),
+  fRunID(-1)
 {
   G4int n_particle = 1;
   fParticleGun  = new G4ParticleGun(n_particle);
@@ -57,34 +109,201 @@ DMSPrimaryGeneratorAction::DMSPrimaryGeneratorAction()
   fParticleGun->SetParticleDefinition(particle);
   fParticleGun->SetParticleMomentumDirection(G4ThreeVector(0.,0.,1.));
   fParticleGun->SetParticleEnergy(600.*MeV);
+
+  fMessenger = new DMSPrimaryGeneratorMessenger(this);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DMSPrimaryGeneratorAction::~DMSPrimaryGeneratorAction()
 {
+  delete fMessenger;
   delete fParticleGun;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void DMSPrimaryGeneratorAction::SetPhaseSpaceFile(const G4String& fileName)
+{
+  fPhaseSpaceName = ( fileName == "none" ) ? G4String("") : fileName;
+  // Mapped at the next run
+  fPhaseSpace = 0;
+  fRunID = -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void DMSPrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
   //this function is called at the begining of each event
   //
 
+  // Random stream of this event, before anything is sampled
+  DMSEventSeeder::SeedEvent(anEvent->GetEventID());
+
+  const G4int runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+  if ( runID != fRunID ) {
+    fRunID = runID;
+    BeginRun();
+  }
+
+  const G4int eventNumber = DMSEventSeeder::GetEventNumber(anEvent->GetEventID());
+  if ( fPhaseSpace ) GeneratePhaseSpace(anEvent, eventNumber);
+  else GenerateBeam(anEvent, eventNumber);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPrimaryGeneratorAction::BeginRun()
+{
   // In order to avoid dependence of PrimaryGeneratorAction
-  // on DetectorConstruction class we get Envelope volume
-  // from G4LogicalVolumeStore.
+  // on DetectorConstruction class we get the dump face
+  // from G4LogicalVolumeStore: the geometry may change between runs.
+  fFaceZ = DBL_MAX;
+  G4LogicalVolume* world
+    = G4LogicalVolumeStore::GetInstance()->GetVolume("World", false);
+  for ( size_t i = 0; world && i < world->GetNoDaughters(); ++i ) {
+    const G4VPhysicalVolume* daughter = world->GetDaughter(i);
+    const G4double zMin = daughter->GetTranslation().z()
+                        + daughter->GetLogicalVolume()->GetSolid()->GetExtent().GetZmin();
+    fFaceZ = std::min(fFaceZ, zMin - kFaceGap);
+  }
+  if ( fFaceZ == DBL_MAX ) fFaceZ = fCentre.z();
+
+  if ( ! fPhaseSpaceName.empty() ) {
+    fPhaseSpace = DMSPhaseSpaceFile::Open(fPhaseSpaceName);
+    if ( ! fPhaseSpace ) {
+      G4ExceptionDescription description;
+      description << "No primaries: the phase-space file " << fPhaseSpaceName
+                  << " cannot be used.";
+      G4Exception("DMSPrimaryGeneratorAction::BeginRun", "DMSPhaseSpace002",
+                  FatalException, description);
+    }
+  }
+
+  // An event replays a group of fParticlesPerEvent records, which stands
+  // for the same primaries however often it is recycled
+  G4double primariesPerEvent = 0.;
+  if ( fPhaseSpace ) {
+    primariesPerEvent = G4double(fPhaseSpace->GetNumberOfPrimaries())
+                      * fParticlesPerEvent
+                      / G4double(fPhaseSpace->GetNumberOfRecords());
+  }
+  G4AutoLock lock(&sourceMutex);
+  fgSourcePrimariesPerEvent = primariesPerEvent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DMSPrimaryGeneratorAction::GetSourcePrimariesPerEvent()
+{
+  G4AutoLock lock(&sourceMutex);
+  return fgSourcePrimariesPerEvent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  G4double x0 = 0.;
-  G4double y0 = 0.;
-  G4double z0 = -8000.;
+void DMSPrimaryGeneratorAction::GenerateBeam(G4Event* anEvent,
+                                             G4int eventNumber)
+{
+  G4double x0 = fCentre.x() + fRasterX * Sweep(eventNumber, fRasterPeriodX);
+  G4double y0 = fCentre.y() + fRasterY * Sweep(eventNumber, fRasterPeriodY);
+  G4double z0 = fStartAtFace ? fFaceZ : fCentre.z();
+  if ( fSigmaX > 0. ) x0 += G4RandGauss::shoot(0., fSigmaX);
+  if ( fSigmaY > 0. ) y0 += G4RandGauss::shoot(0., fSigmaY);
+
+  G4double thetaX = 0.;
+  G4double thetaY = 0.;
+  if ( fDivergenceX > 0. ) thetaX = G4RandGauss::shoot(0., fDivergenceX);
+  if ( fDivergenceY > 0. ) thetaY = G4RandGauss::shoot(0., fDivergenceY);
 
   fParticleGun->SetParticlePosition(G4ThreeVector(x0,y0,z0));
+  fParticleGun->SetParticleMomentumDirection(
+    G4ThreeVector(std::tan(thetaX), std::tan(thetaY), 1.).unit());
 
   fParticleGun->GeneratePrimaryVertex(anEvent);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void DMSPrimaryGeneratorAction::GeneratePhaseSpace(G4Event* anEvent,
+                                                   G4int eventNumber)
+{
+  // Each group of particles is used in fRecycle consecutive events
+  const uint64_t nRecords = fPhaseSpace->GetNumberOfRecords();
+  const uint64_t group = uint64_t(eventNumber) / fRecycle;
+  fCursor = group * fParticlesPerEvent % nRecords;
+
+  // One turn about the z axis for all the particles of the event
+  G4int quarterTurns = 0;
+  G4bool reflect = false;
+  G4double angle = 0.;
+  if ( fRotation == kSquare ) {
+    quarterTurns = G4int(4. * G4UniformRand()) % 4;
+    reflect = G4UniformRand() < 0.5;
+  }
+  else if ( fRotation == kFree ) {
+    angle = twopi * G4UniformRand();
+  }
+
+  for ( G4int i = 0; i < fParticlesPerEvent; ++i ) {
+    const DMSPhaseSpaceRecord& record = fPhaseSpace->GetRecord(fCursor);
+    if ( ++fCursor == nRecords ) fCursor = 0;
+
+    G4ParticleDefinition* definition = GetDefinition(record.pdg);
+    if ( ! definition ) continue;
+
+    G4ThreeVector position(record.x*mm, record.y*mm, record.z*mm);
+    G4ThreeVector direction
+      = G4ThreeVector(record.ux, record.uy, record.uz).unit();
+    if ( reflect ) {
+      position.setX(-position.x());
+      direction.setX(-direction.x());
+    }
+    for ( G4int turn = 0; turn < quarterTurns; ++turn ) {
+      position = G4ThreeVector(-position.y(), position.x(), position.z());
+      direction = G4ThreeVector(-direction.y(), direction.x(), direction.z());
+    }
+    if ( angle != 0. ) {
+      position.rotateZ(angle);
+      direction.rotateZ(angle);
+    }
+    if ( fStartAtFace && position.z() < fFaceZ && direction.z() > 0. ) {
+      position += ( fFaceZ - position.z() ) / direction.z() * direction;
+    }
+
+    G4PrimaryParticle* particle = new G4PrimaryParticle(definition);
+    particle->SetKineticEnergy(record.kineticEnergy*MeV);
+    particle->SetMomentumDirection(direction);
+    particle->SetWeight(record.weight);
+
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(position, record.time*ns);
+    vertex->SetPrimary(particle);
+    anEvent->AddPrimaryVertex(vertex);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ParticleDefinition* DMSPrimaryGeneratorAction::GetDefinition(G4int pdg)
+{
+  auto cached = fDefinitions.find(pdg);
+  if ( cached != fDefinitions.end() ) return cached->second;
+
+  G4ParticleDefinition* definition
+    = G4ParticleTable::GetParticleTable()->FindParticle(pdg);
+  if ( ! definition && pdg > 1000000000 ) {
+    definition = G4IonTable::GetIonTable()->GetIon(pdg);
+  }
+  if ( ! definition ) {
+    G4ExceptionDescription description;
+    description << "Unknown particle " << pdg << " in " << fPhaseSpaceName
+                << "; its records are skipped.";
+    G4Exception("DMSPrimaryGeneratorAction::GetDefinition", "DMSPhaseSpace003",
+                JustWarning, description);
+  }
+  fDefinitions[pdg] = definition;
+  return definition;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
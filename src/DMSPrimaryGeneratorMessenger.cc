@@ -0,0 +1,231 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSPrimaryGeneratorMessenger.cc
+/// \brief Implementation of the DMSPrimaryGeneratorMessenger class
+
+#include "DMSPrimaryGeneratorMessenger.hh"
+#include "DMSPrimaryGeneratorAction.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPrimaryGeneratorMessenger::DMSPrimaryGeneratorMessenger(
+  DMSPrimaryGeneratorAction* generator)
+: G4UImessenger(),
+  fGenerator(generator),
+  fBeamDirectory(0),
+  fSpotCmd(0),
+  fDivergenceCmd(0),
+  fRasterCmd(0),
+  fRasterPeriodsCmd(0),
+  fCentreCmd(0),
+  fStartAtFaceCmd(0),
+  fPhaseSpaceCmd(0),
+  fParticlesPerEventCmd(0),
+  fRecycleCmd(0),
+  fRotationCmd(0)
+{
+  fBeamDirectory = new G4UIdirectory("/dms/beam/");
+  fBeamDirectory->SetGuidance("Beam profile and phase-space source of the primaries");
+
+  fSpotCmd = NewPairCommand("/dms/beam/spot", "mm");
+  fSpotCmd->SetGuidance("Rms width of the Gaussian beam spot in x and y");
+  fSpotCmd->SetGuidance("(default 0 0, a pencil beam).");
+
+  fDivergenceCmd = NewPairCommand("/dms/beam/divergence", "mrad");
+  fDivergenceCmd->SetGuidance("Rms angle of the Gaussian beam divergence in x and y");
+  fDivergenceCmd->SetGuidance("(default 0 0).");
+
+  fRasterCmd = NewPairCommand("/dms/beam/raster", "mm");
+  fRasterCmd->SetGuidance("Half widths in x and y of the raster of the beam centre");
+  fRasterCmd->SetGuidance("(default 0 0, no raster).");
+
+  fRasterPeriodsCmd = new G4UIcommand("/dms/beam/rasterPeriods", this);
+  fRasterPeriodsCmd->SetGuidance("Events per period of the raster sweeps in x and y");
+  fRasterPeriodsCmd->SetGuidance("(default 1000 997).");
+  auto periodX = new G4UIparameter("eventsX", 'i', false);
+  periodX->SetParameterRange("eventsX>0");
+  fRasterPeriodsCmd->SetParameter(periodX);
+  auto periodY = new G4UIparameter("eventsY", 'i', false);
+  periodY->SetParameterRange("eventsY>0");
+  fRasterPeriodsCmd->SetParameter(periodY);
+  fRasterPeriodsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fCentreCmd = new G4UIcmdWith3VectorAndUnit("/dms/beam/centre", this);
+  fCentreCmd->SetGuidance("Centre of the beam spot (default 0 0 0); z is only used");
+  fCentreCmd->SetGuidance("with /dms/beam/startAtFace false.");
+  fCentreCmd->SetParameterName("x", "y", "z", false);
+  fCentreCmd->SetUnitCategory("Length");
+  fCentreCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fStartAtFaceCmd = new G4UIcmdWithABool("/dms/beam/startAtFace", this);
+  fStartAtFaceCmd->SetGuidance("Start the primaries just in front of the dump face,");
+  fStartAtFaceCmd->SetGuidance("instead of tracking them through the vacuum (default true).");
+  fStartAtFaceCmd->SetParameterName("startAtFace", true);
+  fStartAtFaceCmd->SetDefaultValue(true);
+  fStartAtFaceCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPhaseSpaceCmd = new G4UIcmdWithAString("/dms/beam/phaseSpace", this);
+  fPhaseSpaceCmd->SetGuidance("Read the primaries from a phase-space file, or none");
+  fPhaseSpaceCmd->SetGuidance("for the beam of the gun (default none).");
+  fPhaseSpaceCmd->SetParameterName("fileName", false);
+  fPhaseSpaceCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fParticlesPerEventCmd = new G4UIcmdWithAnInteger("/dms/beam/particlesPerEvent", this);
+  fParticlesPerEventCmd->SetGuidance("Phase-space particles per event (default 1).");
+  fParticlesPerEventCmd->SetParameterName("particles", false);
+  fParticlesPerEventCmd->SetRange("particles>0");
+  fParticlesPerEventCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRecycleCmd = new G4UIcmdWithAnInteger("/dms/beam/recycle", this);
+  fRecycleCmd->SetGuidance("Use every group of phase-space particles in this number");
+  fRecycleCmd->SetGuidance("of consecutive events (default 1).");
+  fRecycleCmd->SetParameterName("events", false);
+  fRecycleCmd->SetRange("events>0");
+  fRecycleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRotationCmd = new G4UIcmdWithAString("/dms/beam/rotation", this);
+  fRotationCmd->SetGuidance("Turn the phase-space particles of each event about z:");
+  fRotationCmd->SetGuidance("  none   : as recorded (default)");
+  fRotationCmd->SetGuidance("  square : by a random multiple of 90 deg, with a random");
+  fRotationCmd->SetGuidance("           reflection; for square layers on the axis");
+  fRotationCmd->SetGuidance("  free   : by a random angle; for a geometry symmetric");
+  fRotationCmd->SetGuidance("           about the axis");
+  fRotationCmd->SetParameterName("rotation", false);
+  fRotationCmd->SetCandidates("none square free");
+  fRotationCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSPrimaryGeneratorMessenger::~DMSPrimaryGeneratorMessenger()
+{
+  delete fSpotCmd;
+  delete fDivergenceCmd;
+  delete fRasterCmd;
+  delete fRasterPeriodsCmd;
+  delete fCentreCmd;
+  delete fStartAtFaceCmd;
+  delete fPhaseSpaceCmd;
+  delete fParticlesPerEventCmd;
+  delete fRecycleCmd;
+  delete fRotationCmd;
+  delete fBeamDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4UIcommand* DMSPrimaryGeneratorMessenger::NewPairCommand(const char* name,
+                                                          const char* defaultUnit)
+{
+  G4UIcommand* command = new G4UIcommand(name, this);
+  auto x = new G4UIparameter("x", 'd', false);
+  x->SetParameterRange("x>=0.");
+  command->SetParameter(x);
+  auto y = new G4UIparameter("y", 'd', false);
+  y->SetParameterRange("y>=0.");
+  command->SetParameter(y);
+  auto unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue(defaultUnit);
+  unit->SetParameterCandidates(G4UIcommand::UnitsList(
+    G4UIcommand::CategoryOf(defaultUnit)));
+  command->SetParameter(unit);
+  command->AvailableForStates(G4State_PreInit, G4State_Idle);
+  return command;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSPrimaryGeneratorMessenger::ReadPair(const G4String& value,
+                                              G4double& x, G4double& y) const
+{
+  std::istringstream is(value);
+  G4String unit;
+  if ( ! ( is >> x >> y >> unit ) ) return false;
+  x *= G4UIcommand::ValueOf(unit);
+  y *= G4UIcommand::ValueOf(unit);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSPrimaryGeneratorMessenger::SetNewValue(G4UIcommand* command,
+                                               G4String newValue)
+{
+  G4double x = 0.;
+  G4double y = 0.;
+  if ( command == fSpotCmd ) {
+    if ( ReadPair(newValue, x, y) ) fGenerator->SetSpot(x, y);
+  }
+  else if ( command == fDivergenceCmd ) {
+    if ( ReadPair(newValue, x, y) ) fGenerator->SetDivergence(x, y);
+  }
+  else if ( command == fRasterCmd ) {
+    if ( ReadPair(newValue, x, y) ) fGenerator->SetRaster(x, y);
+  }
+  else if ( command == fRasterPeriodsCmd ) {
+    G4int eventsX = 0;
+    G4int eventsY = 0;
+    std::istringstream is(newValue);
+    is >> eventsX >> eventsY;
+    fGenerator->SetRasterPeriods(eventsX, eventsY);
+  }
+  else if ( command == fCentreCmd ) {
+    fGenerator->SetCentre(fCentreCmd->GetNew3VectorValue(newValue));
+  }
+  else if ( command == fStartAtFaceCmd ) {
+    fGenerator->SetStartAtFace(fStartAtFaceCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fPhaseSpaceCmd ) {
+    fGenerator->SetPhaseSpaceFile(newValue);
+  }
+  else if ( command == fParticlesPerEventCmd ) {
+    fGenerator->SetParticlesPerEvent(
+      fParticlesPerEventCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fRecycleCmd ) {
+    fGenerator->SetRecycle(fRecycleCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fRotationCmd ) {
+    DMSPrimaryGeneratorAction::Rotation rotation
+      = DMSPrimaryGeneratorAction::kNoRotation;
+    if ( newValue == "square" )    rotation = DMSPrimaryGeneratorAction::kSquare;
+    else if ( newValue == "free" ) rotation = DMSPrimaryGeneratorAction::kFree;
+    fGenerator->SetRotation(rotation);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
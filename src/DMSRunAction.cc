@@ -28,6 +28,19 @@
 /// \brief Implementation of the DMSRunAction class
 
 #include "DMSRunAction.hh"
+#include "DMSRunActionMessenger.hh"
+#include "DMSEnergyMesh.hh"
+#include "DMSThermalSolver.hh"
+#include "DMSNuclideInventory.hh"
+#include "DMSActivationSolver.hh"
+#include "DMSCheckpoint.hh"
+#include "DMSEventSeeder.hh"
+#include "DMSShard.hh"
+#include "DMSScalingMonitor.hh"
+#include "DMSPhaseSpaceRecorder.hh"
+#include "DMSDesignScan.hh"
+#include "DMSNameDictionary.hh"
+#include "DMSOutputSchema.hh"
 #include "DMSPrimaryGeneratorAction.hh"
 #include "DMSDetectorConstruction.hh"
 // #include "DMSRun.hh"
@@ -39,14 +52,62 @@
 #include "G4LogicalVolume.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
 #include "g4root.hh"
+
+#include <istream>
+#include <ostream>
 //#include "g4analysis.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DMSRunAction::DMSRunAction()
-: G4UserRunAction()
+: G4UserRunAction(),
+  fMessenger(0),
+  fUseNameCodes(false),
+  fEventLayout(false),
+  fColumnList("default"),
+  fPrecision('F'),
+  fKinematics(DMSOutputSchema::GetDefaultKinematics()),
+  fFillNtuple(true),
+  fFillHistograms(false),
+  fPerThreadFiles(false),
+  fAsyncOutput(false),
+  fAsyncFormat(DMSAsyncWriter::kBinary),
+  fBatchRows(8192),
+  fBatchEvents(0),
+  fQueueDepth(64),
+  fOutputBatch(0),
+  fNtuplesBooked(false),
+  fSchemaNtupleId(-1),
+  fDictionaryNtupleId(-1),
+  fEventsNtupleId(-1),
+  fSecondaryFilter(),
+  fEventTrigger(),
+  fHistoManager(),
+  fEnergyMesh(0),
+  fThermalSolver(0),
+  fNuclideInventory(0),
+  fActivationSolver(0),
+  fCheckpoint(0),
+  fEventSeeder(0),
+  fDesignScan(0),
+  fKeptEvents(0),
+  fRejectedEvents(0),
+  fLeakingNeutrons(0.)
 {
+  fMessenger = new DMSRunActionMessenger(this);
+  fEnergyMesh = new DMSEnergyMesh;
+  fThermalSolver = new DMSThermalSolver;
+  fNuclideInventory = new DMSNuclideInventory;
+  fActivationSolver = new DMSActivationSolver;
+  fCheckpoint = new DMSCheckpoint(this);
+  fEventSeeder = new DMSEventSeeder;
+  fDesignScan = new DMSDesignScan(this);
+  // Shared by all threads, created with the /dms/phaseSpace/ commands by
+  // the first run action
+  DMSPhaseSpaceRecorder::Instance();
+
   // Analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
   G4cout << "Using " << analysisManager->GetType() << G4endl;
@@ -55,31 +116,318 @@ DMSRunAction::DMSRunAction()
   analysisManager->SetNtupleMerging(true);
   analysisManager->SetVerboseLevel(1);
 
-  // Create an Ntuple
-  analysisManager->CreateNtuple("DMSDumpSim", "DMS Dump Simulation");
-  analysisManager->CreateNtupleSColumn("procName");
-  analysisManager->CreateNtupleSColumn("particleName");
-  analysisManager->CreateNtupleSColumn("motherName");
-  analysisManager->CreateNtupleSColumn("volumeName");
-  analysisManager->CreateNtupleDColumn("kinE");
-  analysisManager->CreateNtupleDColumn("x");
-  analysisManager->CreateNtupleDColumn("y");
-  analysisManager->CreateNtupleDColumn("z");
-  analysisManager->CreateNtupleDColumn("global_t");
-  analysisManager->CreateNtupleDColumn("local_t");
-  analysisManager->CreateNtupleDColumn("px");
-  analysisManager->CreateNtupleDColumn("py");
-  analysisManager->CreateNtupleDColumn("pz");
-  analysisManager->CreateNtupleDColumn("pdir_x");
-  analysisManager->CreateNtupleDColumn("pdir_y");
-  analysisManager->CreateNtupleDColumn("pdir_z");
-  analysisManager->FinishNtuple();
+  // Histograms are booked here so that /analysis/h*/set can rebin them,
+  // they stay inactive unless selected with /dms/record/mode
+  fHistoManager.Book();
+
+  // Register accumulables to the manager
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(fKeptEvents);
+  accumulableManager->RegisterAccumulable(fRejectedEvents);
+  accumulableManager->RegisterAccumulable(fLeakingNeutrons);
+  accumulableManager->RegisterAccumulable(fEnergyMesh);
+  accumulableManager->RegisterAccumulable(fNuclideInventory);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DMSRunAction::~DMSRunAction()
-{}
+{
+  delete fMessenger;
+  delete fOutputBatch;
+  delete fEnergyMesh;
+  delete fThermalSolver;
+  delete fNuclideInventory;
+  delete fActivationSolver;
+  delete fCheckpoint;
+  delete fEventSeeder;
+  delete fDesignScan;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSRunAction::CheckNotBooked(const G4String& command) const
+{
+  if ( fNtuplesBooked ) {
+    G4cerr << "DMSRunAction: the output layout is fixed at the first run, "
+           << command << " is ignored." << G4endl;
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SetUseNameCodes(G4bool value)
+{
+  if ( value == fUseNameCodes ) return;
+  if ( ! CheckNotBooked("/dms/record/encoding") ) return;
+  fUseNameCodes = value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SetColumns(const G4String& list)
+{
+  if ( ! CheckNotBooked("/dms/record/columns") ) return;
+
+  std::vector<DMSKinematicColumn> kinematics;
+  G4String error;
+  if ( ! DMSOutputSchema::ParseKinematics(list, fPrecision, kinematics, &error) ) {
+    G4cerr << "DMSRunAction: invalid column list \"" << list << "\" ("
+           << error << "), the columns are not changed." << G4endl;
+    return;
+  }
+  fColumnList = list;
+  fKinematics = kinematics;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SetPrecision(const G4String& precision)
+{
+  char type = ( precision == "double" ) ? 'D' : 'F';
+  if ( type == fPrecision ) return;
+  if ( ! CheckNotBooked("/dms/record/precision") ) return;
+
+  // Applies to the columns without an explicit :F or :D suffix
+  fPrecision = type;
+  DMSOutputSchema::ParseKinematics(fColumnList, fPrecision, fKinematics);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SetLayout(const G4String& layout)
+{
+  G4bool eventLayout = ( layout == "event" );
+  if ( eventLayout == fEventLayout ) return;
+  if ( ! CheckNotBooked("/dms/record/layout") ) return;
+  fEventLayout = eventLayout;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SetRecordMode(const G4String& mode)
+{
+  G4bool fillNtuple     = ( mode == "ntuple" || mode == "both" );
+  G4bool fillHistograms = ( mode == "histograms" || mode == "both" );
+  if ( fillNtuple == fFillNtuple && fillHistograms == fFillHistograms ) return;
+  if ( ! CheckNotBooked("/dms/record/mode") ) return;
+  fFillNtuple = fillNtuple;
+  fFillHistograms = fillHistograms;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SetPerThreadFiles(G4bool value)
+{
+  if ( value == fPerThreadFiles ) return;
+  if ( ! CheckNotBooked("/dms/output/perThreadFiles") ) return;
+  fPerThreadFiles = value;
+
+  // Histograms are still merged on the master
+  G4AnalysisManager::Instance()->SetNtupleMerging(! fPerThreadFiles);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SetOutputFormat(const G4String& format)
+{
+  if ( format == "arrow" && ! DMSAsyncWriter::HasArrow() ) {
+    G4cerr << "DMSRunAction: built without Arrow support (WITH_ARROW), "
+           << "/dms/output/format arrow is ignored." << G4endl;
+    return;
+  }
+
+  G4bool async = ( format != "root" );
+  auto asyncFormat
+    = ( format == "arrow" ) ? DMSAsyncWriter::kArrow : DMSAsyncWriter::kBinary;
+  if ( async == fAsyncOutput && asyncFormat == fAsyncFormat ) return;
+  if ( ! CheckNotBooked("/dms/output/format") ) return;
+  fAsyncOutput = async;
+  fAsyncFormat = asyncFormat;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::EndOfEventOutput(G4int eventID, size_t nRows)
+{
+  if ( ! fFillNtuple ) return;
+
+  // Event numbers of the whole job, see DMSEventSeeder
+  eventID = DMSEventSeeder::GetEventNumber(eventID);
+
+  if ( ! fAsyncOutput ) {
+    if ( fEventLayout ) {
+      auto analysisManager = G4AnalysisManager::Instance();
+      analysisManager->FillNtupleIColumn(fEventsNtupleId, 0, eventID);
+      analysisManager->FillNtupleIColumn(fEventsNtupleId, 1, nRows);
+      analysisManager->AddNtupleRow(fEventsNtupleId);
+    }
+    return;
+  }
+
+  auto batch = GetOutputBatch();
+  ++batch->events;
+  if ( fEventLayout ) {
+    batch->eventIDs.push_back(eventID);
+    batch->eventEnds.push_back(batch->rows);
+  }
+  if ( batch->rows >= size_t(fBatchRows)
+       || ( fBatchEvents > 0 && batch->events >= size_t(fBatchEvents) ) ) {
+    DMSAsyncWriter::Instance()->Push(batch);
+    fOutputBatch = 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::CountEvent(G4bool kept)
+{
+  if ( kept ) fKeptEvents += 1;
+  else        fRejectedEvents += 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::GetCounters(G4double counters[3]) const
+{
+  counters[0] = fKeptEvents.GetValue();
+  counters[1] = fRejectedEvents.GetValue();
+  counters[2] = fLeakingNeutrons.GetValue();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SetCounters(const G4double counters[3])
+{
+  fKeptEvents = G4int(counters[0]);
+  fRejectedEvents = G4int(counters[1]);
+  fLeakingNeutrons = counters[2];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::SaveScorers(std::ostream& stream) const
+{
+  const G4int counts[2] = { fKeptEvents.GetValue(), fRejectedEvents.GetValue() };
+  stream.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+  const G4double leakingNeutrons = fLeakingNeutrons.GetValue();
+  stream.write(reinterpret_cast<const char*>(&leakingNeutrons),
+               sizeof(leakingNeutrons));
+  fEnergyMesh->Save(stream);
+  fNuclideInventory->Save(stream);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSRunAction::LoadScorers(std::istream& stream)
+{
+  G4int counts[2] = { 0, 0 };
+  if ( ! stream.read(reinterpret_cast<char*>(counts), sizeof(counts)) ) return false;
+  fKeptEvents += counts[0];
+  fRejectedEvents += counts[1];
+  G4double leakingNeutrons = 0.;
+  if ( ! stream.read(reinterpret_cast<char*>(&leakingNeutrons),
+                     sizeof(leakingNeutrons)) ) return false;
+  fLeakingNeutrons += leakingNeutrons;
+  return fEnergyMesh->Load(stream) && fNuclideInventory->Load(stream);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::WriteResults(G4int nEvents)
+{
+  fEnergyMesh->Write();
+  fThermalSolver->Solve(*fEnergyMesh);
+  fNuclideInventory->Write(nEvents);
+  fActivationSolver->Solve(*fNuclideInventory);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::BookNtuples()
+{
+  fNtuplesBooked = true;
+  if ( ! fFillNtuple || fAsyncOutput ) return;
+
+  // Merged ntuples interleave the rows of the workers, the event index
+  // needs the rows of each thread in its own file
+  if ( fEventLayout && ! fPerThreadFiles ) {
+    if ( IsMaster() ) {
+      G4cout << "DMSRunAction: the event layout writes the ntuples per thread,"
+             << " /dms/output/perThreadFiles is set." << G4endl;
+    }
+    fPerThreadFiles = true;
+    G4AnalysisManager::Instance()->SetNtupleMerging(false);
+  }
+
+  // Create the Ntuples, the secondaries first (id 0), then the dictionary
+  // and the schema
+  DMSOutputSchema::CreateNtuple(DMSOutputSchema::GetSecondaryNtupleName(),
+                                "DMS Dump Simulation",
+                                DMSOutputSchema::GetSecondaryColumns(fUseNameCodes,
+                                                                     fKinematics,
+                                                                     fEventLayout));
+  if ( fUseNameCodes ) {
+    fDictionaryNtupleId
+      = DMSOutputSchema::CreateNtuple(DMSOutputSchema::GetDictionaryNtupleName(),
+                                      "DMS name dictionary",
+                                      DMSOutputSchema::GetDictionaryColumns());
+  }
+  fSchemaNtupleId
+    = DMSOutputSchema::CreateNtuple(DMSOutputSchema::GetSchemaNtupleName(),
+                                    "DMS secondary ntuple layout",
+                                    DMSOutputSchema::GetSchemaColumns());
+  if ( fEventLayout ) {
+    fEventsNtupleId
+      = DMSOutputSchema::CreateNtuple(DMSOutputSchema::GetEventsNtupleName(),
+                                      "DMS event index",
+                                      DMSOutputSchema::GetEventColumns());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::FillDictionary()
+{
+  // The rows are written by the threads that fill DMSDumpSim, i.e. by each
+  // worker in MT mode. Every worker writes the full table known at its end
+  // of run, so each code it used is covered; duplicated rows in a merged
+  // file carry identical values.
+  if ( IsMaster() && G4Threading::IsMultithreadedApplication() ) return;
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  for ( G4int kind = 0; kind < DMSNameDictionary::kNumberOfKinds; ++kind ) {
+    auto names
+      = DMSNameDictionary::GetNames(static_cast<DMSNameDictionary::Kind>(kind));
+    for ( size_t code = 0; code < names.size(); ++code ) {
+      analysisManager->FillNtupleIColumn(fDictionaryNtupleId, 0, kind);
+      analysisManager->FillNtupleIColumn(fDictionaryNtupleId, 1, code);
+      analysisManager->FillNtupleSColumn(fDictionaryNtupleId, 2, names[code]);
+      analysisManager->AddNtupleRow(fDictionaryNtupleId);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunAction::FillSchema()
+{
+  // Written by the same threads as the dictionary; the index column lets
+  // readers drop the duplicated rows of a merged file
+  if ( IsMaster() && G4Threading::IsMultithreadedApplication() ) return;
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  auto columns
+    = DMSOutputSchema::GetSecondaryColumns(fUseNameCodes, fKinematics, fEventLayout);
+  for ( size_t index = 0; index < columns.size(); ++index ) {
+    analysisManager->FillNtupleIColumn(fSchemaNtupleId, 0, index);
+    analysisManager->FillNtupleSColumn(fSchemaNtupleId, 1, columns[index].name);
+    analysisManager->FillNtupleIColumn(fSchemaNtupleId, 2, columns[index].type);
+    analysisManager->AddNtupleRow(fSchemaNtupleId);
+  }
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -88,20 +436,69 @@ void DMSRunAction::BeginOfRunAction(const G4Run*)
   // inform the runManager to save random number seed
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
 
-  // reset accumulables to their initial values
+  // reset accumulables to their initial values; the master keeps them
+  // between the runs of a checkpointed sequence and restores them once
+  // when resuming
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
-  accumulableManager->Reset();
+  if ( ! IsMaster() || ! fCheckpoint->IsContinuing() ) {
+    accumulableManager->Reset();
+  }
+  if ( IsMaster() ) fCheckpoint->RestoreScorers();
+
+  if ( IsMaster() ) DMSScalingMonitor::BeginRun();
+  else              DMSScalingMonitor::BeginWorkerRun();
+
+  // Book the ntuples with the layout selected by /dms/record/ commands
+  if ( ! fNtuplesBooked ) BookNtuples();
+
+  fSecondaryFilter.ClearCache();
+  fEventTrigger.ClearCache();
+  if ( IsMaster() ) {
+    fSecondaryFilter.Print("Recording");
+    if ( fEventTrigger.IsActive() ) fEventTrigger.Print("Event trigger");
+  }
+
+  fHistoManager.SetActivation(fFillHistograms);
+  fHistoManager.ClearCache();
 
   // Set output file name and open it.
   auto analysisManager = G4AnalysisManager::Instance();
-  analysisManager->SetFileName("DMSNeutronEmission");
-  analysisManager->OpenFile();
+  const G4String baseName = "DMSNeutronEmission" + DMSShard::GetOutputSuffix()
+                            + DMSCheckpoint::GetOutputSuffix()
+                            + DMSDesignScan::GetOutputSuffix();
+  analysisManager->SetFileName(baseName);
+  // Without ntuples only rank 0 of the MPI mode writes a file
+  if ( ! IsMaster() || ! DMSShard::IsMPI() || DMSShard::GetIndex() == 0
+       || ( fFillNtuple && ! fAsyncOutput ) ) {
+    analysisManager->OpenFile();
+  }
+
+  // The binary and arrow output is written by one writer thread for all
+  // workers
+  if ( IsMaster() && fFillNtuple && fAsyncOutput ) {
+    G4String fileName = baseName;
+    fileName += ( fAsyncFormat == DMSAsyncWriter::kArrow ) ? ".arrow" : ".dmsb";
+    DMSAsyncWriter::Instance()->Open(fileName,
+                                     DMSOutputSchema::GetSecondaryColumns(true, fKinematics,
+                                                                          fEventLayout),
+                                     fQueueDepth, fAsyncFormat, fEventLayout);
+  }
+
+  if ( IsMaster() ) {
+    DMSPhaseSpaceRecorder::Instance()->Open(DMSShard::GetOutputSuffix()
+                                            + DMSCheckpoint::GetOutputSuffix()
+                                            + DMSDesignScan::GetOutputSuffix());
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void DMSRunAction::EndOfRunAction(const G4Run* /*run*/)
+void DMSRunAction::EndOfRunAction(const G4Run* run)
 {
+  // Merge accumulables
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->Merge();
+
   // Print
   //
   if (IsMaster()) {
@@ -114,9 +511,69 @@ void DMSRunAction::EndOfRunAction(const G4Run* /*run*/)
      << G4endl
      << "--------------------End of Local Run------------------------";
   }
+  if ( fEventTrigger.IsActive() ) {
+    G4cout
+     << G4endl
+     << " Events kept by the trigger: " << fKeptEvents.GetValue()
+     << " of " << fKeptEvents.GetValue() + fRejectedEvents.GetValue();
+  }
+  if ( run->GetNumberOfEvent() > 0 ) {
+    G4cout
+     << G4endl
+     << " Neutrons leaving the dump: " << fLeakingNeutrons.GetValue()
+     << " (" << fLeakingNeutrons.GetValue() / run->GetNumberOfEvent()
+     << " per primary";
+    // The second stage of a two-stage simulation, see DMSPhaseSpaceRecorder
+    const G4double sourcePrimaries
+      = DMSPrimaryGeneratorAction::GetSourcePrimariesPerEvent();
+    if ( sourcePrimaries > 0. ) {
+      G4cout << ", " << fLeakingNeutrons.GetValue()
+                        / ( run->GetNumberOfEvent() * sourcePrimaries )
+             << " per stage-1 primary";
+    }
+    G4cout << ")";
+  }
+  G4cout << G4endl;
+
+  if ( IsMaster() ) DMSScalingMonitor::Print();
+  else              DMSScalingMonitor::EndWorkerRun();
+
+  // A shard writes its scorers instead, see DMSShard
+  if ( IsMaster() && fCheckpoint->IsFinalRun() && ! DMSShard::IsActive() ) {
+    WriteResults(DMSCheckpoint::GetEventOffset() + run->GetNumberOfEvent());
+  }
+
+  if ( fFillNtuple && ! fAsyncOutput ) {
+    FillSchema();
+    if ( fUseNameCodes ) FillDictionary();
+  }
+
+  // Hand the last, partial batch to the writer; the master closes the
+  // writer once all workers are done
+  if ( fOutputBatch ) {
+    DMSAsyncWriter::Instance()->Push(fOutputBatch);
+    fOutputBatch = 0;
+  }
+  if ( IsMaster() ) DMSAsyncWriter::Instance()->Close();
+
+  // Likewise for the phase-space records
+  if ( IsMaster() ) DMSPhaseSpaceRecorder::Instance()->Close(run->GetNumberOfEvent());
+  else              DMSPhaseSpaceRecorder::Instance()->Flush();
+
+  // In the MPI mode the master writes after the histograms are summed
+  // over the ranks, see DMSMPIReducer
   auto analysisManager = G4AnalysisManager::Instance();
-  analysisManager->Write();
-  analysisManager->CloseFile();
+  if ( ! IsMaster() || ! DMSShard::IsMPI() ) {
+    analysisManager->Write();
+    analysisManager->CloseFile();
+  }
+
+  if ( IsMaster() && fPerThreadFiles && fFillNtuple && ! fAsyncOutput ) {
+    G4cout << G4endl
+           << " Ntuples were written per thread, combine them with:" << G4endl
+           << "   dms-merge -o <output> " << analysisManager->GetFileName()
+           << G4endl;
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
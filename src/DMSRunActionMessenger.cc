@@ -0,0 +1,296 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSRunActionMessenger.cc
+/// \brief Implementation of the DMSRunActionMessenger class
+
+#include "DMSRunActionMessenger.hh"
+#include "DMSRunAction.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSRunActionMessenger::DMSRunActionMessenger(DMSRunAction* runAction)
+: G4UImessenger(),
+  fRunAction(runAction),
+  fDMSDirectory(0),
+  fRecordDirectory(0),
+  fModeCmd(0),
+  fEncodingCmd(0),
+  fColumnsCmd(0),
+  fPrecisionCmd(0),
+  fLayoutCmd(0),
+  fParticlesCmd(0),
+  fVolumesCmd(0),
+  fMinEnergyCmd(0),
+  fTriggerDirectory(0),
+  fTriggerParticlesCmd(0),
+  fTriggerVolumesCmd(0),
+  fTriggerMinEnergyCmd(0),
+  fOutputDirectory(0),
+  fPerThreadFilesCmd(0),
+  fFormatCmd(0),
+  fBatchRowsCmd(0),
+  fBatchEventsCmd(0),
+  fQueueDepthCmd(0)
+{
+  fDMSDirectory = new G4UIdirectory("/dms/");
+  fDMSDirectory->SetGuidance("UI commands of the DMS dump simulation");
+
+  fRecordDirectory = new G4UIdirectory("/dms/record/");
+  fRecordDirectory->SetGuidance("Recording of secondaries into the DMSDumpSim ntuple");
+
+  fModeCmd = new G4UIcmdWithAString("/dms/record/mode", this);
+  fModeCmd->SetGuidance("Select what is filled for the recorded secondaries.");
+  fModeCmd->SetGuidance("  ntuple     : one DMSDumpSim row per secondary (default)");
+  fModeCmd->SetGuidance("  histograms : spectra only, see DMSHistoManager");
+  fModeCmd->SetGuidance("  both       : ntuple rows and spectra");
+  fModeCmd->SetGuidance("The output layout is fixed at the first /run/beamOn.");
+  fModeCmd->SetParameterName("mode", false);
+  fModeCmd->SetCandidates("ntuple histograms both");
+  fModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEncodingCmd = new G4UIcmdWithAString("/dms/record/encoding", this);
+  fEncodingCmd->SetGuidance("Select how process, particle and volume names are stored.");
+  fEncodingCmd->SetGuidance("  names : one string column per name (default)");
+  fEncodingCmd->SetGuidance("  codes : int code columns plus a DMSDictionary ntuple");
+  fEncodingCmd->SetGuidance("The ntuple layout is fixed at the first /run/beamOn.");
+  fEncodingCmd->SetParameterName("encoding", false);
+  fEncodingCmd->SetCandidates("names codes");
+  fEncodingCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fColumnsCmd = new G4UIcmdWithAString("/dms/record/columns", this);
+  fColumnsCmd->SetGuidance("Select the kinematic columns of DMSDumpSim, in order.");
+  fColumnsCmd->SetGuidance("Available: kinE x y z global_t local_t px py pz");
+  fColumnsCmd->SetGuidance("           pdir_x pdir_y pdir_z");
+  fColumnsCmd->SetGuidance("A \":F\" or \":D\" suffix stores one column as float or double,");
+  fColumnsCmd->SetGuidance("e.g. \"kinE:D x y z\". \"default\" is kinE x y z global_t");
+  fColumnsCmd->SetGuidance("pdir_x pdir_y pdir_z, \"all\" selects every column.");
+  fColumnsCmd->SetGuidance("Every column may be selected only once.");
+  fColumnsCmd->SetGuidance("The ntuple layout is fixed at the first /run/beamOn.");
+  fColumnsCmd->SetParameterName("columns", false);
+  fColumnsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPrecisionCmd = new G4UIcmdWithAString("/dms/record/precision", this);
+  fPrecisionCmd->SetGuidance("Storage of the kinematic columns without a suffix:");
+  fPrecisionCmd->SetGuidance("  float  : 32-bit (default)");
+  fPrecisionCmd->SetGuidance("  double : 64-bit");
+  fPrecisionCmd->SetParameterName("precision", false);
+  fPrecisionCmd->SetCandidates("float double");
+  fPrecisionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fLayoutCmd = new G4UIcmdWithAString("/dms/record/layout", this);
+  fLayoutCmd->SetGuidance("Select how the rows are organised.");
+  fLayoutCmd->SetGuidance("  flat  : one independent row per secondary (default)");
+  fLayoutCmd->SetGuidance("  event : rows carry trackID and parentID instead of the");
+  fLayoutCmd->SetGuidance("          mother, and an event index (DMSEvents ntuple, or");
+  fLayoutCmd->SetGuidance("          event blocks/lists of the binary and arrow formats)");
+  fLayoutCmd->SetGuidance("          gives the contiguous rows of each event. The root");
+  fLayoutCmd->SetGuidance("          format then writes per-thread files.");
+  fLayoutCmd->SetGuidance("The output layout is fixed at the first /run/beamOn.");
+  fLayoutCmd->SetParameterName("layout", false);
+  fLayoutCmd->SetCandidates("flat event");
+  fLayoutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fParticlesCmd = new G4UIcmdWithAString("/dms/record/particles", this);
+  fParticlesCmd->SetGuidance("Record only secondaries of the listed particles,");
+  fParticlesCmd->SetGuidance("e.g. \"neutron gamma\". \"all\" removes the selection.");
+  fParticlesCmd->SetParameterName("particles", false);
+  fParticlesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fVolumesCmd = new G4UIcmdWithAString("/dms/record/volumes", this);
+  fVolumesCmd->SetGuidance("Record only secondaries produced in the listed logical");
+  fVolumesCmd->SetGuidance("volumes, e.g. \"layer5 layer6\". \"all\" removes the selection.");
+  fVolumesCmd->SetParameterName("volumes", false);
+  fVolumesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fMinEnergyCmd = new G4UIcmdWithADoubleAndUnit("/dms/record/minEnergy", this);
+  fMinEnergyCmd->SetGuidance("Record only secondaries above this kinetic energy.");
+  fMinEnergyCmd->SetParameterName("minEnergy", false);
+  fMinEnergyCmd->SetRange("minEnergy>=0.");
+  fMinEnergyCmd->SetUnitCategory("Energy");
+  fMinEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fTriggerDirectory = new G4UIdirectory("/dms/record/trigger/");
+  fTriggerDirectory->SetGuidance("Event trigger: the recorded secondaries of an event are");
+  fTriggerDirectory->SetGuidance("written only if one of its secondaries passes this selection.");
+  fTriggerDirectory->SetGuidance("Without any selection every event is written.");
+
+  fTriggerParticlesCmd = new G4UIcmdWithAString("/dms/record/trigger/particles", this);
+  fTriggerParticlesCmd->SetGuidance("Trigger on secondaries of the listed particles.");
+  fTriggerParticlesCmd->SetGuidance("\"all\" removes the selection.");
+  fTriggerParticlesCmd->SetParameterName("particles", false);
+  fTriggerParticlesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fTriggerVolumesCmd = new G4UIcmdWithAString("/dms/record/trigger/volumes", this);
+  fTriggerVolumesCmd->SetGuidance("Trigger on secondaries produced in the listed volumes.");
+  fTriggerVolumesCmd->SetGuidance("\"all\" removes the selection.");
+  fTriggerVolumesCmd->SetParameterName("volumes", false);
+  fTriggerVolumesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fTriggerMinEnergyCmd = new G4UIcmdWithADoubleAndUnit("/dms/record/trigger/minEnergy", this);
+  fTriggerMinEnergyCmd->SetGuidance("Trigger on secondaries above this kinetic energy.");
+  fTriggerMinEnergyCmd->SetParameterName("minEnergy", false);
+  fTriggerMinEnergyCmd->SetRange("minEnergy>=0.");
+  fTriggerMinEnergyCmd->SetUnitCategory("Energy");
+  fTriggerMinEnergyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fOutputDirectory = new G4UIdirectory("/dms/output/");
+  fOutputDirectory->SetGuidance("Output file handling");
+
+  fPerThreadFilesCmd = new G4UIcmdWithABool("/dms/output/perThreadFiles", this);
+  fPerThreadFilesCmd->SetGuidance("Write the ntuples of each worker into its own file");
+  fPerThreadFilesCmd->SetGuidance("(<name>_t<N>.root) instead of merging them on the master.");
+  fPerThreadFilesCmd->SetGuidance("Histograms are still merged into <name>.root.");
+  fPerThreadFilesCmd->SetGuidance("Use dms-merge to combine the files after the run.");
+  fPerThreadFilesCmd->SetParameterName("perThreadFiles", true);
+  fPerThreadFilesCmd->SetDefaultValue(true);
+  fPerThreadFilesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fFormatCmd = new G4UIcmdWithAString("/dms/output/format", this);
+  fFormatCmd->SetGuidance("Select the format of the secondary rows.");
+  fFormatCmd->SetGuidance("  root   : DMSDumpSim ntuple of the analysis manager (default)");
+  fFormatCmd->SetGuidance("  binary : DMSNeutronEmission.dmsb, compressed column blocks");
+  fFormatCmd->SetGuidance("           written by a dedicated writer thread");
+  fFormatCmd->SetGuidance("  arrow  : DMSNeutronEmission.arrow, Arrow IPC file (Feather V2)");
+  fFormatCmd->SetGuidance("           with dictionary-encoded name columns, written by the");
+  fFormatCmd->SetGuidance("           same thread; requires building WITH_ARROW");
+  fFormatCmd->SetGuidance("The output layout is fixed at the first /run/beamOn.");
+  fFormatCmd->SetParameterName("format", false);
+  fFormatCmd->SetCandidates("root binary arrow");
+  fFormatCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBatchRowsCmd = new G4UIcmdWithAnInteger("/dms/output/batchRows", this);
+  fBatchRowsCmd->SetGuidance("Rows collected by a worker before its batch is handed");
+  fBatchRowsCmd->SetGuidance("to the binary/arrow writer (events are never split).");
+  fBatchRowsCmd->SetParameterName("rows", false);
+  fBatchRowsCmd->SetRange("rows>0");
+  fBatchRowsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBatchEventsCmd = new G4UIcmdWithAnInteger("/dms/output/batchEvents", this);
+  fBatchEventsCmd->SetGuidance("Events collected by a worker before its batch is handed");
+  fBatchEventsCmd->SetGuidance("to the binary/arrow writer, whichever of batchRows and");
+  fBatchEventsCmd->SetGuidance("batchEvents is reached first; 0 uses batchRows only.");
+  fBatchEventsCmd->SetParameterName("events", false);
+  fBatchEventsCmd->SetRange("events>=0");
+  fBatchEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fQueueDepthCmd = new G4UIcmdWithAnInteger("/dms/output/queueDepth", this);
+  fQueueDepthCmd->SetGuidance("Batches the output writer queue can hold; workers wait");
+  fQueueDepthCmd->SetGuidance("when it is full, which caps the memory of pending output.");
+  fQueueDepthCmd->SetParameterName("depth", false);
+  fQueueDepthCmd->SetRange("depth>0");
+  fQueueDepthCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSRunActionMessenger::~DMSRunActionMessenger()
+{
+  delete fModeCmd;
+  delete fEncodingCmd;
+  delete fColumnsCmd;
+  delete fPrecisionCmd;
+  delete fLayoutCmd;
+  delete fParticlesCmd;
+  delete fVolumesCmd;
+  delete fMinEnergyCmd;
+  delete fTriggerParticlesCmd;
+  delete fTriggerVolumesCmd;
+  delete fTriggerMinEnergyCmd;
+  delete fTriggerDirectory;
+  delete fPerThreadFilesCmd;
+  delete fFormatCmd;
+  delete fBatchRowsCmd;
+  delete fBatchEventsCmd;
+  delete fQueueDepthCmd;
+  delete fOutputDirectory;
+  delete fRecordDirectory;
+  delete fDMSDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSRunActionMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fModeCmd ) {
+    fRunAction->SetRecordMode(newValue);
+  }
+  else if ( command == fEncodingCmd ) {
+    fRunAction->SetUseNameCodes(newValue == "codes");
+  }
+  else if ( command == fColumnsCmd ) {
+    fRunAction->SetColumns(newValue);
+  }
+  else if ( command == fPrecisionCmd ) {
+    fRunAction->SetPrecision(newValue);
+  }
+  else if ( command == fLayoutCmd ) {
+    fRunAction->SetLayout(newValue);
+  }
+  else if ( command == fParticlesCmd ) {
+    fRunAction->GetSecondaryFilter().SetParticles(newValue);
+  }
+  else if ( command == fVolumesCmd ) {
+    fRunAction->GetSecondaryFilter().SetVolumes(newValue);
+  }
+  else if ( command == fMinEnergyCmd ) {
+    fRunAction->GetSecondaryFilter()
+      .SetMinEnergy(fMinEnergyCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fTriggerParticlesCmd ) {
+    fRunAction->GetEventTrigger().SetParticles(newValue);
+  }
+  else if ( command == fTriggerVolumesCmd ) {
+    fRunAction->GetEventTrigger().SetVolumes(newValue);
+  }
+  else if ( command == fTriggerMinEnergyCmd ) {
+    fRunAction->GetEventTrigger()
+      .SetMinEnergy(fTriggerMinEnergyCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fPerThreadFilesCmd ) {
+    fRunAction->SetPerThreadFiles(fPerThreadFilesCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fFormatCmd ) {
+    fRunAction->SetOutputFormat(newValue);
+  }
+  else if ( command == fBatchRowsCmd ) {
+    fRunAction->SetBatchRows(fBatchRowsCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fBatchEventsCmd ) {
+    fRunAction->SetBatchEvents(fBatchEventsCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fQueueDepthCmd ) {
+    fRunAction->SetQueueDepth(fQueueDepthCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,143 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSScalingMonitor.cc
+/// \brief Implementation of the DMSScalingMonitor class
+
+#include "DMSScalingMonitor.hh"
+
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+  G4Mutex scalingMutex = G4MUTEX_INITIALIZER;
+}
+
+DMSScalingMonitor::Clock::time_point DMSScalingMonitor::fgRunStart;
+std::vector<DMSScalingMonitor::WorkerRecord> DMSScalingMonitor::fgWorkers;
+G4ThreadLocal DMSScalingMonitor::EventClock*
+  DMSScalingMonitor::fgEventClock = 0;
+G4ThreadLocal G4int    DMSScalingMonitor::fgEvents = 0;
+G4ThreadLocal G4double DMSScalingMonitor::fgBusySeconds = 0.;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSScalingMonitor::BeginRun()
+{
+  // Before the workers start their runs
+  G4AutoLock lock(&scalingMutex);
+  fgWorkers.clear();
+  fgRunStart = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSScalingMonitor::BeginWorkerRun()
+{
+  if ( fgEventClock ) fgEventClock->end = fgRunStart;
+  fgEvents = 0;
+  fgBusySeconds = 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSScalingMonitor::EndWorkerRun()
+{
+  WorkerRecord record;
+  record.threadID = G4Threading::G4GetThreadId();
+  record.events = fgEvents;
+  record.busySeconds = fgBusySeconds;
+  // With tasks the workers end their runs together, after the last event
+  record.end = fgEventClock ? fgEventClock->end : fgRunStart;
+
+  G4AutoLock lock(&scalingMutex);
+  fgWorkers.push_back(record);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSScalingMonitor::BeginEvent()
+{
+  // G4ThreadLocal may be __thread, which needs a trivial type
+  if ( ! fgEventClock ) fgEventClock = new EventClock;
+  fgEventClock->start = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSScalingMonitor::EndEvent()
+{
+  if ( ! fgEventClock ) return;
+  fgEventClock->end = Clock::now();
+  fgBusySeconds += std::chrono::duration<G4double>(
+    fgEventClock->end - fgEventClock->start).count();
+  ++fgEvents;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSScalingMonitor::Print()
+{
+  // Sequential runs have no workers
+  G4AutoLock lock(&scalingMutex);
+  if ( fgWorkers.empty() ) return;
+
+  const G4double wall
+    = std::chrono::duration<G4double>(Clock::now() - fgRunStart).count();
+  std::sort(fgWorkers.begin(), fgWorkers.end(),
+            [](const WorkerRecord& a, const WorkerRecord& b)
+            { return a.threadID < b.threadID; });
+
+  G4double busy = 0.;
+  Clock::time_point firstEnd = fgWorkers.front().end;
+  Clock::time_point lastEnd = firstEnd;
+  G4cout << G4endl << " Scaling over " << fgWorkers.size() << " threads:"
+         << G4endl
+         << "  thread    events   busy [s]   last event done [s]" << G4endl;
+  for ( const WorkerRecord& record : fgWorkers ) {
+    busy += record.busySeconds;
+    firstEnd = std::min(firstEnd, record.end);
+    lastEnd = std::max(lastEnd, record.end);
+    G4cout << std::setw(8) << record.threadID
+           << std::setw(10) << record.events
+           << std::setw(11) << record.busySeconds
+           << std::setw(11)
+           << std::chrono::duration<G4double>(record.end - fgRunStart).count()
+           << G4endl;
+  }
+  const G4double efficiency
+    = ( wall > 0. ) ? busy / ( wall * fgWorkers.size() ) : 0.;
+  G4cout << "  wall time " << wall << " s, busy " << busy
+         << " s, efficiency " << 100. * efficiency << " %" << G4endl
+         << "  tail (first to last thread done) "
+         << std::chrono::duration<G4double>(lastEnd - firstEnd).count()
+         << " s" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
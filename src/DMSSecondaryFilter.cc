@@ -0,0 +1,125 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSSecondaryFilter.cc
+/// \brief Implementation of the DMSSecondaryFilter class
+
+#include "DMSSecondaryFilter.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4LogicalVolume.hh"
+#include "G4UnitsTable.hh"
+
+#include <sstream>
+
+namespace
+{
+  // Split a blank separated list; "all" selects everything
+  std::set<G4String> ParseNames(const G4String& names)
+  {
+    std::set<G4String> result;
+    std::istringstream is(names);
+    G4String name;
+    while ( is >> name ) {
+      if ( name == "all" ) return std::set<G4String>();
+      result.insert(name);
+    }
+    return result;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSSecondaryFilter::DMSSecondaryFilter()
+: fMinEnergy(0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSSecondaryFilter::~DMSSecondaryFilter()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSSecondaryFilter::SetParticles(const G4String& names)
+{
+  fParticleNames = ParseNames(names);
+  fParticleCache.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSSecondaryFilter::SetVolumes(const G4String& names)
+{
+  fVolumeNames = ParseNames(names);
+  fVolumeCache.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSSecondaryFilter::ClearCache()
+{
+  // Geometry or ions may have been rebuilt since the last run
+  fParticleCache.clear();
+  fVolumeCache.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSSecondaryFilter::Resolve(const G4ParticleDefinition* particle)
+{
+  G4bool accept = fParticleNames.count(particle->GetParticleName()) > 0;
+  fParticleCache[particle] = accept;
+  return accept;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSSecondaryFilter::Resolve(const G4LogicalVolume* volume)
+{
+  G4bool accept = fVolumeNames.count(volume->GetName()) > 0;
+  fVolumeCache[volume] = accept;
+  return accept;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSSecondaryFilter::Print(const G4String& what) const
+{
+  if ( ! IsActive() ) {
+    G4cout << what << ": all secondaries" << G4endl;
+    return;
+  }
+  G4cout << what << ": secondaries with particles:";
+  if ( fParticleNames.empty() ) G4cout << " all";
+  for ( const auto& name : fParticleNames ) G4cout << " " << name;
+  G4cout << ", volumes:";
+  if ( fVolumeNames.empty() ) G4cout << " all";
+  for ( const auto& name : fVolumeNames ) G4cout << " " << name;
+  G4cout << ", E > " << G4BestUnit(fMinEnergy, "Energy") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
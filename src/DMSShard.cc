@@ -0,0 +1,242 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSShard.cc
+/// \brief Implementation of the DMSShard class
+
+#include "DMSShard.hh"
+#include "DMSRunAction.hh"
+#include "DMSEventSeeder.hh"
+
+#include "G4AccumulableManager.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  const uint32_t kVersion = 3;
+
+  template <class T>
+  void Put(std::ostream& file, T value)
+  {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <class T>
+  G4bool Get(std::istream& file, T& value)
+  {
+    return bool(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  // Header of a scorer file
+  struct ShardHeader
+  {
+    int64_t seed;
+    int32_t jobEvents;
+    int32_t index;
+    int32_t count;
+    int32_t firstEvent;
+    int32_t events;
+  };
+}
+
+G4int  DMSShard::fgIndex = 0;
+G4int  DMSShard::fgCount = 1;
+G4int  DMSShard::fgJobEvents = 0;
+G4bool DMSShard::fgReduce = false;
+G4bool DMSShard::fgMPI = false;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSShard::SetShard(const G4String& value)
+{
+  size_t slash = value.find('/');
+  if ( slash == std::string::npos ) return false;
+  G4int index = std::atoi(value.substr(0, slash).c_str());
+  G4int count = std::atoi(value.substr(slash + 1).c_str());
+  if ( count < 1 || index < 0 || index >= count ) return false;
+  fgIndex = index;
+  fgCount = count;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSShard::SetMPIRank(G4int rank, G4int size)
+{
+  fgIndex = rank;
+  fgCount = size;
+  fgMPI = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSShard::GetRange(G4int jobEvents, G4int& firstEvent, G4int& nEvents)
+{
+  const int64_t begin = int64_t(jobEvents) * fgIndex / fgCount;
+  const int64_t end   = int64_t(jobEvents) * ( fgIndex + 1 ) / fgCount;
+  firstEvent = begin;
+  nEvents = end - begin;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String DMSShard::GetOutputSuffix()
+{
+  if ( ! IsActive() || ( IsMPI() && fgIndex == 0 ) ) return "";
+  std::ostringstream suffix;
+  suffix << "_s" << fgIndex;
+  return suffix.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String DMSShard::GetScorerFileName(G4int index)
+{
+  std::ostringstream fileName;
+  fileName << "DMSScorers_s" << index << ".dmss";
+  return fileName.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSShard::WriteScorers(const DMSRunAction& runAction, G4int jobEvents,
+                              G4int firstEvent, G4int nEvents)
+{
+  // Written under a temporary name, so that the reduction never picks up
+  // a partial file
+  const G4String fileName = GetScorerFileName(fgIndex);
+  const G4String tmpName = fileName + ".tmp";
+  {
+    std::ofstream file(tmpName, std::ios::binary | std::ios::trunc);
+    file.write("DMSS", 4);
+    Put<uint32_t>(file, kVersion);
+    ShardHeader header = { DMSEventSeeder::GetSeed(), jobEvents, fgIndex,
+                           fgCount, firstEvent, nEvents };
+    Put(file, header);
+
+    std::ostringstream scorers;
+    runAction.SaveScorers(scorers);
+    const std::string data = scorers.str();
+    Put<uint64_t>(file, data.size());
+    file.write(data.data(), data.size());
+    file.close();
+    if ( ! file ) {
+      G4ExceptionDescription description;
+      description << "Cannot write " << tmpName << ".";
+      G4Exception("DMSShard::WriteScorers", "DMSShard001",
+                  JustWarning, description);
+      return false;
+    }
+  }
+  if ( std::rename(tmpName.c_str(), fileName.c_str()) != 0 ) return false;
+
+  G4cout << "DMSShard: shard " << fgIndex << " of " << fgCount << ", events "
+         << firstEvent << " to " << firstEvent + nEvents - 1 << " of "
+         << jobEvents << ", scorers written to " << fileName << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSShard::Reduce(DMSRunAction& runAction, G4int jobEvents)
+{
+  G4AccumulableManager::Instance()->Reset();
+
+  // The shard count is read from the first file found
+  G4int count = fgCount;
+  G4int nEvents = 0;
+  G4int nShards = 0;
+  std::vector<G4int> missing;
+  for ( G4int index = 0; index < count; ++index ) {
+    const G4String fileName = GetScorerFileName(index);
+    std::ifstream file(fileName, std::ios::binary);
+    char magic[4] = { 0, 0, 0, 0 };
+    uint32_t version = 0;
+    ShardHeader header;
+    uint64_t size = 0;
+    file.read(magic, 4);
+    G4bool valid = file && std::string(magic, 4) == "DMSS"
+                   && Get(file, version) && version == kVersion
+                   && Get(file, header) && Get(file, size);
+    if ( ! valid ) {
+      missing.push_back(index);
+      continue;
+    }
+
+    // The first shard found fixes the job
+    if ( nShards == 0 ) count = header.count;
+    if ( header.count != count || header.jobEvents != jobEvents
+         || header.seed != DMSEventSeeder::GetSeed() ) {
+      G4ExceptionDescription description;
+      description << fileName << " is shard " << header.index << " of "
+                  << header.count << " of a job of " << header.jobEvents
+                  << " events with seed " << header.seed << ", not of this"
+                  << " job of " << jobEvents << " events with seed "
+                  << DMSEventSeeder::GetSeed() << "; it is skipped.";
+      G4Exception("DMSShard::Reduce", "DMSShard002", JustWarning, description);
+      missing.push_back(index);
+      continue;
+    }
+    std::string data(size, '\0');
+    file.read(&data[0], size);
+    std::istringstream scorers(data);
+    if ( ! file || ! runAction.LoadScorers(scorers) ) {
+      G4ExceptionDescription description;
+      description << "The scorers in " << fileName << " do not match the"
+                  << " current /dms/mesh/ and /dms/nuclides/ settings.";
+      G4Exception("DMSShard::Reduce", "DMSShard003",
+                  FatalException, description);
+      return;
+    }
+    nEvents += header.events;
+    ++nShards;
+  }
+
+  if ( nShards == 0 ) {
+    G4Exception("DMSShard::Reduce", "DMSShard004", JustWarning,
+                "No scorer file DMSScorers_s<i>.dmss of this job found"
+                " (give --shard 0/N if shard 0 is missing).");
+    return;
+  }
+  G4cout << G4endl << "DMSShard: reduced " << nShards << " of " << count
+         << " shards, " << nEvents << " of " << jobEvents << " events"
+         << G4endl;
+  if ( ! missing.empty() ) {
+    G4cout << "  Missing shards:";
+    for ( const auto index : missing ) G4cout << ' ' << index;
+    G4cout << G4endl
+           << "  The results are normalised to the events found." << G4endl;
+  }
+  runAction.WriteResults(nEvents);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,193 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSStartupTimer.cc
+/// \brief Implementation of the DMSStartupTimer class
+
+#include "DMSStartupTimer.hh"
+
+#include "G4StateManager.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ProcessManager.hh"
+#include "G4Threading.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <set>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSStartupTimer* DMSStartupTimer::Instance()
+{
+  static DMSStartupTimer* instance = new DMSStartupTimer;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSStartupTimer::DMSStartupTimer()
+: G4VStateDependent(),
+  fStart(Clock::now()),
+  fInitStart(fStart),
+  fGeometryEnd(fStart),
+  fInitEnd(fStart),
+  fTablesStart(fStart),
+  fLastTable(fStart),
+  fRunStart(fStart),
+  fTableTimes(),
+  fPrinted(false)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DMSStartupTimer::Seconds(Clock::time_point from, Clock::time_point to)
+{
+  return std::chrono::duration<G4double>(to - from).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSStartupTimer::Notify(G4ApplicationState requestedState)
+{
+  if ( fPrinted ) return true;
+  const G4ApplicationState state
+    = G4StateManager::GetStateManager()->GetCurrentState();
+  if ( state == G4State_PreInit && requestedState == G4State_Init ) {
+    fInitStart = Clock::now();
+    fGeometryEnd = fInitStart;
+  }
+  else if ( state == G4State_Init && requestedState == G4State_Idle
+            && fInitEnd == fStart ) {
+    // Only at /run/initialize, the run initialization passes Init too
+    fInitEnd = Clock::now();
+  }
+  else if ( state == G4State_Idle && requestedState == G4State_GeomClosed ) {
+    fRunStart = Clock::now();
+    Print();
+    fPrinted = true;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSStartupTimer::GeometryDone()
+{
+  fGeometryEnd = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSStartupTimer::TablesPrepared()
+{
+  // All particles are prepared before the first table is built
+  fTablesStart = Clock::now();
+  fLastTable = fTablesStart;
+  fTableTimes.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSStartupTimer::TableBuilt(const G4ParticleDefinition& particle)
+{
+  const Clock::time_point now = Clock::now();
+  fTableTimes.push_back(std::make_pair(particle.GetParticleName(),
+                                       Seconds(fLastTable, now)));
+  fLastTable = now;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSStartupTimer::Print() const
+{
+  const std::set<G4String> hpParticles
+    = { "neutron", "proton", "deuteron", "triton", "He3", "alpha" };
+  G4double hpTime = 0.;
+  for ( const auto& entry : fTableTimes ) {
+    if ( hpParticles.count(entry.first) ) hpTime += entry.second;
+  }
+  std::vector<std::pair<G4String, G4double> > slowest(fTableTimes);
+  std::sort(slowest.begin(), slowest.end(),
+            [](const std::pair<G4String, G4double>& a,
+               const std::pair<G4String, G4double>& b)
+            { return a.second > b.second; });
+
+  const G4bool tables = ! fTableTimes.empty();
+  G4cout << G4endl << " Startup time [s]:" << G4endl
+         << "  setup before /run/initialize " << std::setw(10)
+         << Seconds(fStart, fInitStart) << G4endl
+         << "  geometry                     " << std::setw(10)
+         << Seconds(fInitStart, fGeometryEnd) << G4endl
+         << "  physics construction         " << std::setw(10)
+         << Seconds(fGeometryEnd, fInitEnd) << G4endl;
+  if ( tables ) {
+    G4cout << "  physics tables               " << std::setw(10)
+           << GetTablesSeconds() << G4endl
+           << "    HP particles (n p d t He3 alpha) " << hpTime << G4endl
+           << "    slowest:";
+    for ( size_t i = 0; i < std::min(slowest.size(), size_t(5)); ++i ) {
+      G4cout << ' ' << slowest[i].first << ' ' << slowest[i].second;
+    }
+    G4cout << G4endl;
+  }
+  G4cout << "  total until the first run    " << std::setw(10)
+         << Seconds(fStart, fRunStart) << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSTableTimer::PreparePhysicsTable(const G4ParticleDefinition&)
+{
+  if ( G4Threading::IsMasterThread() ) {
+    DMSStartupTimer::Instance()->TablesPrepared();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSTableTimer::BuildPhysicsTable(const G4ParticleDefinition& particle)
+{
+  if ( G4Threading::IsMasterThread() ) {
+    DMSStartupTimer::Instance()->TableBuilt(particle);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSTimingPhysics::ConstructProcess()
+{
+  // One instance per thread for all particles; inactive in all loops
+  DMSTableTimer* timer = new DMSTableTimer;
+  auto particleIterator = GetParticleIterator();
+  particleIterator->reset();
+  while ( (*particleIterator)() ) {
+    G4ParticleDefinition* particle = particleIterator->value();
+    G4ProcessManager* processManager = particle->GetProcessManager();
+    if ( processManager ) processManager->AddProcess(timer, -1, -1, -1);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -29,19 +29,27 @@
 
 #include "DMSSteppingAction.hh"
 #include "DMSEventAction.hh"
+#include "DMSRunAction.hh"
 #include "DMSDetectorConstruction.hh"
+#include "DMSEnergyMesh.hh"
+#include "DMSNuclideInventory.hh"
+#include "DMSPhaseSpaceRecorder.hh"
 
 #include "G4Step.hh"
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VTouchable.hh"
 #include "G4ParticleTypes.hh"
-#include "g4root.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-DMSSteppingAction::DMSSteppingAction()
-: G4UserSteppingAction()
+DMSSteppingAction::DMSSteppingAction(DMSRunAction* runAction,
+                                     DMSEventAction* eventAction)
+: G4UserSteppingAction(),
+  fRunAction(runAction),
+  fEventAction(eventAction)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -53,40 +61,80 @@ DMSSteppingAction::~DMSSteppingAction()
 
 void DMSSteppingAction::UserSteppingAction(const G4Step* step)
 {
-  auto analysisManager = G4AnalysisManager::Instance();
+  // Deposited energy, scored at the middle of the step
+  DMSEnergyMesh& mesh = fRunAction->GetEnergyMesh();
+  if ( mesh.IsActive() ) {
+    G4double edep = step->GetTotalEnergyDeposit();
+    if ( edep > 0. ) {
+      const G4StepPoint* preStepPoint = step->GetPreStepPoint();
+      G4ThreeVector position
+        = 0.5 * ( preStepPoint->GetPosition() + step->GetPostStepPoint()->GetPosition() );
+      mesh.Fill(position, edep,
+                preStepPoint->GetPhysicalVolume()->GetLogicalVolume());
+    }
+  }
+
+  // Neutrons leaving the dump: the union of the nested layers is convex,
+  // so a neutron in the vacuum of the World never comes back
+  const G4StepPoint* postStepPoint = step->GetPostStepPoint();
+  if ( postStepPoint->GetStepStatus() == fGeomBoundary
+       && step->GetTrack()->GetDefinition() == G4Neutron::Definition()
+       && postStepPoint->GetTouchable()->GetHistoryDepth() == 0 ) {
+    fRunAction->CountLeakingNeutron();
+  }
 
-  // Record all photons and neutrons kinematic information.
+  // Particles crossing into the volume of the phase-space recording
+  DMSPhaseSpaceRecorder* recorder = DMSPhaseSpaceRecorder::Instance();
+  if ( recorder->IsActive() && recorder->Record(step) ) {
+    step->GetTrack()->SetTrackStatus(fStopAndKill);
+  }
+
+  // Buffer the kinematic information of the secondaries accepted by the
+  // /dms/record/ selection (all secondaries by default).
   const std::vector<const G4Track*>* secondaries = step->GetSecondaryInCurrentStep();
+  if ( secondaries->empty() ) return;
+
+  // Residual nuclides, in the volume and copy where they are produced
+  DMSNuclideInventory& nuclides = fRunAction->GetNuclideInventory();
+  if ( nuclides.IsActive() ) {
+    const G4VTouchable* touchable = step->GetPreStepPoint()->GetTouchable();
+    const G4VPhysicalVolume* physical = touchable->GetVolume();
+    const G4int copyNumber = touchable->GetCopyNumber();
+    for ( const G4Track* secondary : *secondaries ) {
+      nuclides.Fill(secondary, physical, copyNumber);
+    }
+  }
+
+  // Mother particle and production volume are common to all secondaries
+  const G4LogicalVolume* volume
+    = step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume();
+  const G4ParticleDefinition* mother = step->GetTrack()->GetParticleDefinition();
+
+  // Event trigger, evaluated on all secondaries until it fires
+  DMSSecondaryFilter& trigger = fRunAction->GetEventTrigger();
+  if ( trigger.IsActive() && ! fEventAction->IsTriggered()
+       && trigger.AcceptVolume(volume) ) {
+    for ( const G4Track* secondary : *secondaries ) {
+      if ( trigger.Accept(secondary->GetDefinition(),
+                          secondary->GetKineticEnergy()) ) {
+        fEventAction->SetTriggered();
+        break;
+      }
+    }
+  }
+
+  DMSSecondaryFilter& filter = fRunAction->GetSecondaryFilter();
+  if ( ! filter.AcceptVolume(volume) ) return;
 
-  for( size_t lp = 0; lp < (*secondaries).size(); ++lp )
-  {
-    // Process Name
-    analysisManager->FillNtupleSColumn(0, (*secondaries)[lp]->GetCreatorProcess()->GetProcessName());
-    // Name of daughter particle
-    analysisManager->FillNtupleSColumn(1, (*secondaries)[lp]->GetDefinition()->GetParticleName());
-    // Name of mother particle
-    analysisManager->FillNtupleSColumn(2, step->GetTrack()->GetParticleDefinition()->GetParticleName());
-    // Name of volume where particle produced
-    analysisManager->FillNtupleSColumn(3, step->GetPreStepPoint()->GetTouchableHandle()->GetVolume()->GetLogicalVolume()->GetName());
-    // Energy of daughter particle
-    analysisManager->FillNtupleDColumn(4, (G4double)(*secondaries)[lp]->GetKineticEnergy()/CLHEP::MeV);
-    // Position of particle production
-    analysisManager->FillNtupleDColumn(5, (G4double)(*secondaries)[lp]->GetPosition().getX()/CLHEP::cm);
-    analysisManager->FillNtupleDColumn(6, (G4double)(*secondaries)[lp]->GetPosition().getY()/CLHEP::cm);
-    analysisManager->FillNtupleDColumn(7, (G4double)(*secondaries)[lp]->GetPosition().getZ()/CLHEP::cm);
-    // Time of particle production
-    analysisManager->FillNtupleDColumn(8, (G4double)(*secondaries)[lp]->GetGlobalTime()/CLHEP::ns);
-    analysisManager->FillNtupleDColumn(9, (G4double)(*secondaries)[lp]->GetLocalTime()/CLHEP::ns);
-    // Momentum of daughter particle
-    analysisManager->FillNtupleDColumn(10, (G4double)(*secondaries)[lp]->GetMomentum().getX()/CLHEP::MeV);
-    analysisManager->FillNtupleDColumn(11, (G4double)(*secondaries)[lp]->GetMomentum().getY()/CLHEP::MeV);
-    analysisManager->FillNtupleDColumn(12, (G4double)(*secondaries)[lp]->GetMomentum().getZ()/CLHEP::MeV);
-    // Momentum direction vectors
-    analysisManager->FillNtupleDColumn(13, (G4double)(*secondaries)[lp]->GetMomentumDirection().getX());
-    analysisManager->FillNtupleDColumn(14, (G4double)(*secondaries)[lp]->GetMomentumDirection().getY());
-    analysisManager->FillNtupleDColumn(15, (G4double)(*secondaries)[lp]->GetMomentumDirection().getZ());
-
-    analysisManager->AddNtupleRow();
+  DMSSecondaryBuffer& buffer = fEventAction->GetBuffer();
+  const G4bool eventLayout = fRunAction->GetEventLayout();
+  const G4int parentID = step->GetTrack()->GetTrackID();
+  for ( const G4Track* secondary : *secondaries ) {
+    if ( filter.Accept(secondary->GetDefinition(),
+                       secondary->GetKineticEnergy()) ) {
+      if ( eventLayout ) fEventAction->AddPendingTrack(secondary, buffer.Size());
+      buffer.Append(secondary, mother, volume, parentID);
+    }
   }
 }
 
@@ -0,0 +1,567 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSThermalSolver.cc
+/// \brief Implementation of the DMSThermalSolver class
+
+#include "DMSThermalSolver.hh"
+#include "DMSThermalSolverMessenger.hh"
+#include "DMSEnergyMesh.hh"
+
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4Threading.hh"
+#include "G4Timer.hh"
+#include "G4UnitsTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace {
+  const char* kFaceNames[6] = { "xmin", "xmax", "ymin", "ymax", "zmin", "zmax" };
+
+  // Used for materials missing from the property table
+  const G4double kDefaultConductivity = 1.;     // W/(m K)
+  const G4double kDefaultHeatCapacity = 1000.;  // J/(kg K)
+
+  // Reusable barrier for the solver threads
+  class Barrier
+  {
+    public:
+      explicit Barrier(G4int count)
+      : fCount(count), fWaiting(0), fGeneration(0) { }
+
+      void Wait()
+      {
+        std::unique_lock<std::mutex> lock(fMutex);
+        G4int generation = fGeneration;
+        if ( ++fWaiting == fCount ) {
+          fWaiting = 0;
+          ++fGeneration;
+          fCondition.notify_all();
+        }
+        else {
+          fCondition.wait(lock, [&]() { return generation != fGeneration; });
+        }
+      }
+
+    private:
+      std::mutex fMutex;
+      std::condition_variable fCondition;
+      G4int fCount;
+      G4int fWaiting;
+      G4int fGeneration;
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSThermalSolver::DMSThermalSolver()
+: fMessenger(0),
+  fActive(false),
+  fProperties(),
+  fCoolantTemperature(300.),
+  fHeatTransfer(0.),
+  fDuration(0.),
+  fTimeSteps(100),
+  fTolerance(1.e-4),
+  fMaxIterations(100000),
+  fThreads(0),
+  fOmega(1.)
+{
+  fMessenger = new DMSThermalSolverMessenger(this);
+
+  // Room temperature values of the dump materials
+  fProperties["G4_GRAPHITE"]     = { 120.,  710. };
+  fProperties["G4_Cu"]           = { 390.,  385. };
+  fProperties["G4_Fe"]           = {  80.,  449. };
+  fProperties["G4_CONCRETE"]     = {  1.4,  880. };
+  fProperties["G4_Al"]           = { 237.,  897. };
+  fProperties["BoratedConcrete"] = {  1.4,  880. };
+
+  // All faces but the beam entrance
+  SetCooledFaces("xmin xmax ymin ymax zmax");
+  for ( G4int axis = 0; axis < 3; ++axis ) {
+    fN[axis] = 0;
+    fStride[axis] = 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSThermalSolver::~DMSThermalSolver()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSThermalSolver::SetConductivity(const G4String& material, G4double value)
+{
+  auto it = fProperties.find(material);
+  if ( it == fProperties.end() ) {
+    it = fProperties.insert({ material, { kDefaultConductivity,
+                                          kDefaultHeatCapacity } }).first;
+  }
+  it->second.conductivity = value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSThermalSolver::SetHeatCapacity(const G4String& material, G4double value)
+{
+  auto it = fProperties.find(material);
+  if ( it == fProperties.end() ) {
+    it = fProperties.insert({ material, { kDefaultConductivity,
+                                          kDefaultHeatCapacity } }).first;
+  }
+  it->second.heatCapacity = value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSThermalSolver::SetCooledFaces(const G4String& faces)
+{
+  G4bool cooled[6] = { false, false, false, false, false, false };
+  std::istringstream is(faces);
+  G4String face;
+  while ( is >> face ) {
+    if ( face == "none" ) continue;
+    G4int index = 0;
+    while ( index < 6 && face != kFaceNames[index] ) ++index;
+    if ( index == 6 ) {
+      G4ExceptionDescription description;
+      description << "Unknown face \"" << face << "\", expected any of"
+                  << " xmin xmax ymin ymax zmin zmax or none.";
+      G4Exception("DMSThermalSolver::SetCooledFaces", "DMSThermal001",
+                  JustWarning, description);
+      return;
+    }
+    cooled[index] = true;
+  }
+  std::copy(cooled, cooled + 6, fCooled);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DMSThermalSolver::BuildGrid(const DMSEnergyMesh& mesh)
+{
+  if ( mesh.GetType() != DMSEnergyMesh::kCartesian ) {
+    G4Exception("DMSThermalSolver::BuildGrid", "DMSThermal002", JustWarning,
+                "The thermal solver needs a cartesian mesh (/dms/mesh/type).");
+    return false;
+  }
+
+  // Voxel size in m
+  G4int bins[3];
+  G4double width[3];
+  for ( G4int axis = 0; axis < 3; ++axis ) {
+    bins[axis] = mesh.GetBins(axis);
+    width[axis] = ( mesh.GetMax(axis) - mesh.GetMin(axis) ) / bins[axis];
+    fN[axis] = bins[axis] + 2;
+  }
+  fStride[0] = 1;
+  fStride[1] = fN[0];
+  fStride[2] = fN[0] * fN[1];
+  const size_t size = size_t(fStride[2]) * fN[2];
+  const G4double widthSI[3] = { width[0]/m, width[1]/m, width[2]/m };
+  const G4double voxelVolume = widthSI[0] * widthSI[1] * widthSI[2];
+
+  fT.assign(size, fCoolantTemperature);
+  fSource.assign(size, 0.);
+  fPower.assign(size, 0.);
+  fCapacity.assign(size, 0.);
+  fGBoundary.assign(size, 0.);
+  fInvDiag.assign(size, 0.);
+  fRelax.assign(size, 0.);
+  fLayer.assign(size, -1);
+  fLayers.clear();
+  for ( G4int axis = 0; axis < 3; ++axis ) fG[axis].assign(size, 0.);
+
+  // Material at each voxel centre, on a navigator of our own so that the
+  // tracking navigator of the master is left untouched
+  G4Navigator navigator;
+  navigator.SetWorldVolume(G4TransportationManager::GetTransportationManager()
+                           ->GetNavigatorForTracking()->GetWorldVolume());
+
+  const std::vector<G4double>& energy = mesh.GetEnergy();
+  const G4double toWatt = mesh.GetPowerFactor();
+  std::vector<G4double> conductivity(size, 0.);
+  std::set<G4String> unknown;
+  G4double lostPower = 0.;
+  size_t index = 0;
+  for ( G4int k = 0; k < bins[2]; ++k ) {
+    for ( G4int j = 0; j < bins[1]; ++j ) {
+      for ( G4int i = 0; i < bins[0]; ++i, ++index ) {
+        G4ThreeVector centre(mesh.GetMin(0) + ( i + 0.5 ) * width[0],
+                             mesh.GetMin(1) + ( j + 0.5 ) * width[1],
+                             mesh.GetMin(2) + ( k + 0.5 ) * width[2]);
+        G4VPhysicalVolume* physical =
+          navigator.LocateGlobalPointAndSetup(centre, 0, false, true);
+        const G4double power = energy[index] * toWatt;
+        const G4LogicalVolume* volume =
+          physical ? physical->GetLogicalVolume() : 0;
+        const G4Material* material = volume ? volume->GetMaterial() : 0;
+        if ( ! material || material->GetDensity() < 10.*mg/cm3 ) {
+          lostPower += power;
+          continue;
+        }
+
+        Properties properties = { kDefaultConductivity, kDefaultHeatCapacity };
+        auto it = fProperties.find(material->GetName());
+        if ( it != fProperties.end() ) properties = it->second;
+        else unknown.insert(material->GetName());
+
+        const size_t p = ( k + 1 ) * size_t(fStride[2])
+                       + ( j + 1 ) * size_t(fStride[1]) + ( i + 1 );
+        fPower[p] = power;
+        conductivity[p] = properties.conductivity;
+        fCapacity[p] = material->GetDensity() / (kg/m3)
+                     * properties.heatCapacity * voxelVolume;
+        auto layer = std::find(fLayers.begin(), fLayers.end(), volume);
+        fLayer[p] = layer - fLayers.begin();
+        if ( layer == fLayers.end() ) fLayers.push_back(volume);
+      }
+    }
+  }
+
+  for ( const auto& name : unknown ) {
+    G4ExceptionDescription description;
+    description << "No thermal properties for " << name << ", using "
+                << kDefaultConductivity << " W/(m K) and "
+                << kDefaultHeatCapacity << " J/(kg K)."
+                << " Set them with /dms/thermal/conductivity and heatCapacity.";
+    G4Exception("DMSThermalSolver::BuildGrid", "DMSThermal003",
+                JustWarning, description);
+  }
+  if ( lostPower > 0. ) {
+    G4cout << " Thermal solver: " << lostPower
+           << " W deposited outside of the solid are ignored" << G4endl;
+  }
+
+  // Conductance between neighbouring voxels, harmonic mean of the two half
+  // voxels; the ghost layer has zero conductivity
+  for ( G4int axis = 0; axis < 3; ++axis ) {
+    const G4double half = 0.5 * widthSI[axis];
+    const G4double area = voxelVolume / widthSI[axis];
+    const size_t stride = fStride[axis];
+    std::vector<G4double>& g = fG[axis];
+    for ( size_t p = 0; p + stride < size; ++p ) {
+      const G4double k1 = conductivity[p];
+      const G4double k2 = conductivity[p + stride];
+      if ( k1 > 0. && k2 > 0. ) g[p] = area / ( half / k1 + half / k2 );
+    }
+  }
+
+  // Conductance to the coolant of the voxels on the cooled faces
+  const G4double film = fHeatTransfer > 0. ? 1. / fHeatTransfer : 0.;
+  for ( G4int face = 0; face < 6; ++face ) {
+    if ( ! fCooled[face] ) continue;
+    const G4int axis = face / 2;
+    const G4int other[2] = { ( axis + 1 ) % 3, ( axis + 2 ) % 3 };
+    const G4int layer = face % 2 ? bins[axis] : 1;
+    const G4double half = 0.5 * widthSI[axis];
+    const G4double area = voxelVolume / widthSI[axis];
+    for ( G4int a = 1; a <= bins[other[0]]; ++a ) {
+      for ( G4int b = 1; b <= bins[other[1]]; ++b ) {
+        const size_t p = size_t(layer) * fStride[axis]
+                       + size_t(a) * fStride[other[0]]
+                       + size_t(b) * fStride[other[1]];
+        if ( conductivity[p] > 0. ) {
+          fGBoundary[p] += area / ( half / conductivity[p] + film );
+        }
+      }
+    }
+  }
+
+  // Optimal over-relaxation of the model problem
+  const G4int longest = std::max(bins[0], std::max(bins[1], bins[2]));
+  fOmega = 2. / ( 1. + std::sin(pi / longest) );
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSThermalSolver::SetTimeStep(G4double seconds)
+{
+  const size_t sy = fStride[1];
+  const size_t sz = fStride[2];
+  for ( size_t p = sz; p + sz < fT.size(); ++p ) {
+    G4double diag = fG[0][p - 1] + fG[0][p] + fG[1][p - sy] + fG[1][p]
+                  + fG[2][p - sz] + fG[2][p] + fGBoundary[p];
+    if ( seconds > 0. ) diag += fCapacity[p] / seconds;
+    const G4bool solid = fLayer[p] >= 0 && diag > 0.;
+    fInvDiag[p] = solid ? 1. / diag : 0.;
+    fRelax[p]   = solid ? fOmega : 0.;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DMSThermalSolver::Sweep(G4int color, G4int k0, G4int k1)
+{
+  const size_t sy = fStride[1];
+  const size_t sz = fStride[2];
+  const G4int nx = fN[0] - 1;
+  G4double* t = fT.data();
+  const G4double* source = fSource.data();
+  const G4double* gx = fG[0].data();
+  const G4double* gy = fG[1].data();
+  const G4double* gz = fG[2].data();
+  const G4double* invDiag = fInvDiag.data();
+  const G4double* relax = fRelax.data();
+
+  // Only the voxels of one color are updated and they only read the other
+  // color, so the slabs of different threads never conflict. Voxels
+  // outside of the solid have a zero relaxation instead of a branch.
+  G4double maxDelta = 0.;
+  for ( G4int k = k0; k < k1; ++k ) {
+    for ( G4int j = 1; j < fN[1] - 1; ++j ) {
+      const size_t row = k * sz + j * sy;
+      for ( G4int i = 1 + ( ( 1 + j + k + color ) & 1 ); i < nx; i += 2 ) {
+        const size_t p = row + i;
+        const G4double sum = source[p]
+          + gx[p - 1]  * t[p - 1]  + gx[p] * t[p + 1]
+          + gy[p - sy] * t[p - sy] + gy[p] * t[p + sy]
+          + gz[p - sz] * t[p - sz] + gz[p] * t[p + sz];
+        const G4double delta = relax[p] * ( sum * invDiag[p] - t[p] );
+        t[p] += delta;
+        maxDelta = std::max(maxDelta, std::abs(delta));
+      }
+    }
+  }
+  return maxDelta;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DMSThermalSolver::Relax()
+{
+  const G4int slabs = fN[2] - 2;
+  G4int nThreads = fThreads > 0 ? fThreads : G4Threading::G4GetNumberOfCores();
+  nThreads = std::max(1, std::min(nThreads, slabs));
+
+  std::vector<G4double> deltas(nThreads, 0.);
+  Barrier barrier(nThreads);
+  G4int iterations = 0;
+  auto work = [&](G4int id) {
+    const G4int k0 = 1 + slabs * id / nThreads;
+    const G4int k1 = 1 + slabs * ( id + 1 ) / nThreads;
+    for ( G4int iteration = 1; ; ++iteration ) {
+      G4double delta = Sweep(0, k0, k1);
+      barrier.Wait();
+      deltas[id] = std::max(delta, Sweep(1, k0, k1));
+      barrier.Wait();
+      // Every thread takes the same decision; deltas is written again only
+      // after the next barrier
+      G4double maxDelta = *std::max_element(deltas.begin(), deltas.end());
+      if ( maxDelta < fTolerance || iteration >= fMaxIterations ) {
+        if ( id == 0 ) iterations = iteration;
+        break;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for ( G4int id = 1; id < nThreads; ++id ) threads.emplace_back(work, id);
+  work(0);
+  for ( auto& thread : threads ) thread.join();
+
+  if ( iterations >= fMaxIterations ) {
+    G4ExceptionDescription description;
+    description << "No convergence after " << iterations << " iterations;"
+                << " a region without a path to a cooled face has no steady"
+                << " state.";
+    G4Exception("DMSThermalSolver::Relax", "DMSThermal004",
+                JustWarning, description);
+  }
+  return iterations;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSThermalSolver::LayerTemperatures(std::vector<G4double>& peak,
+                                         std::vector<G4double>& mean) const
+{
+  peak.assign(fLayers.size(), 0.);
+  mean.assign(fLayers.size(), 0.);
+  std::vector<size_t> count(fLayers.size(), 0);
+  for ( size_t p = 0; p < fT.size(); ++p ) {
+    const G4int layer = fLayer[p];
+    if ( layer < 0 ) continue;
+    peak[layer] = std::max(peak[layer], fT[p]);
+    mean[layer] += fT[p];
+    ++count[layer];
+  }
+  for ( size_t layer = 0; layer < fLayers.size(); ++layer ) {
+    mean[layer] /= count[layer];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<float> DMSThermalSolver::Unpad() const
+{
+  // Mesh order, 0 outside of the solid
+  std::vector<float> values;
+  values.reserve(size_t(fN[0] - 2) * ( fN[1] - 2 ) * ( fN[2] - 2 ));
+  for ( G4int k = 1; k < fN[2] - 1; ++k ) {
+    for ( G4int j = 1; j < fN[1] - 1; ++j ) {
+      for ( G4int i = 1; i < fN[0] - 1; ++i ) {
+        const size_t p = size_t(k) * fStride[2] + size_t(j) * fStride[1] + i;
+        values.push_back(fLayer[p] >= 0 ? fT[p] : 0.);
+      }
+    }
+  }
+  return values;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSThermalSolver::Solve(const DMSEnergyMesh& mesh)
+{
+  if ( ! fActive ) return;
+  if ( ! mesh.IsActive() || mesh.GetPowerFactor() <= 0. ) {
+    G4Exception("DMSThermalSolver::Solve", "DMSThermal005", JustWarning,
+                "The thermal solver needs the energy mesh (/dms/mesh/active).");
+    return;
+  }
+
+  const G4bool cooled = std::find(fCooled, fCooled + 6, true) != fCooled + 6;
+  const G4bool transient = fDuration > 0. && fTimeSteps > 0;
+  if ( ! cooled && ! transient ) {
+    G4Exception("DMSThermalSolver::Solve", "DMSThermal006", JustWarning,
+                "Without a cooled face only the transient can be solved"
+                " (/dms/thermal/duration).");
+    return;
+  }
+
+  G4Timer timer;
+  timer.Start();
+  if ( ! BuildGrid(mesh) ) return;
+  const G4String& fileName = mesh.GetFileName();
+  const size_t size = fT.size();
+
+  // Steady state
+  std::vector<G4double> steadyPeak, steadyMean;
+  std::vector<float> field;
+  G4int iterations = 0;
+  if ( cooled ) {
+    SetTimeStep(0.);
+    for ( size_t p = 0; p < size; ++p ) {
+      fSource[p] = fPower[p] + fGBoundary[p] * fCoolantTemperature;
+    }
+    iterations += Relax();
+    LayerTemperatures(steadyPeak, steadyMean);
+    field = Unpad();
+  }
+
+  // Transient from a uniform coolant temperature, beam on at t = 0
+  std::vector<G4double> transientPeak, transientMean;
+  if ( transient ) {
+    const G4double step = fDuration / s / fTimeSteps;
+    std::fill(fT.begin(), fT.end(), fCoolantTemperature);
+    SetTimeStep(step);
+
+    std::ofstream history(fileName + "_thermal_history.csv");
+    history << "time_s";
+    for ( const auto volume : fLayers ) history << ',' << volume->GetName();
+    history << '\n';
+    for ( G4int n = 1; n <= fTimeSteps; ++n ) {
+      for ( size_t p = 0; p < size; ++p ) {
+        fSource[p] = fPower[p] + fGBoundary[p] * fCoolantTemperature
+                   + fCapacity[p] / step * fT[p];
+      }
+      iterations += Relax();
+      LayerTemperatures(transientPeak, transientMean);
+      history << n * step;
+      for ( const auto value : transientPeak ) history << ',' << value;
+      history << '\n';
+    }
+    if ( ! cooled ) field = Unpad();
+  }
+  timer.Stop();
+
+  // Summary per layer
+  std::ofstream csv(fileName + "_thermal.csv");
+  csv << "volume,material,conductivity_W_per_mK,steady_peak_K,steady_mean_K,"
+      << "transient_peak_K,transient_mean_K\n";
+  G4cout << G4endl
+         << " Temperatures [K] for a coolant at " << fCoolantTemperature
+         << " K";
+  if ( transient ) G4cout << ", transient after " << G4BestUnit(fDuration, "Time");
+  G4cout << ":" << G4endl
+         << "      volume      material    steady peak    steady mean"
+         << " transient peak" << G4endl;
+  for ( size_t layer = 0; layer < fLayers.size(); ++layer ) {
+    const G4Material* material = fLayers[layer]->GetMaterial();
+    auto it = fProperties.find(material->GetName());
+    G4double conductivity =
+      it != fProperties.end() ? it->second.conductivity : kDefaultConductivity;
+    G4cout << "  " << std::setw(10) << fLayers[layer]->GetName()
+           << std::setw(14) << material->GetName();
+    csv << fLayers[layer]->GetName() << ',' << material->GetName() << ','
+        << conductivity << ',';
+    if ( cooled ) {
+      G4cout << std::setw(15) << steadyPeak[layer]
+             << std::setw(15) << steadyMean[layer];
+      csv << steadyPeak[layer] << ',' << steadyMean[layer] << ',';
+    }
+    else {
+      G4cout << std::setw(15) << "-" << std::setw(15) << "-";
+      csv << ",,";
+    }
+    if ( transient ) {
+      G4cout << std::setw(15) << transientPeak[layer];
+      csv << transientPeak[layer] << ',' << transientMean[layer];
+    }
+    else {
+      csv << ',';
+    }
+    G4cout << G4endl;
+    csv << '\n';
+  }
+
+  mesh.WriteField(fileName + "_temperature.dmsm", field);
+  G4cout << "  Solved in " << timer.GetRealElapsed() << " s ("
+         << iterations << " iterations)" << G4endl
+         << "  Temperature map written to " << fileName << "_temperature.dmsm"
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
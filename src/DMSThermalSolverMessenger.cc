@@ -0,0 +1,216 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DMSThermalSolverMessenger.cc
+/// \brief Implementation of the DMSThermalSolverMessenger class
+
+#include "DMSThermalSolverMessenger.hh"
+#include "DMSThermalSolver.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSThermalSolverMessenger::DMSThermalSolverMessenger(DMSThermalSolver* solver)
+: G4UImessenger(),
+  fSolver(solver),
+  fThermalDirectory(0),
+  fActiveCmd(0),
+  fConductivityCmd(0),
+  fHeatCapacityCmd(0),
+  fCooledFacesCmd(0),
+  fCoolantTemperatureCmd(0),
+  fHeatTransferCmd(0),
+  fDurationCmd(0),
+  fTimeStepsCmd(0),
+  fToleranceCmd(0),
+  fMaxIterationsCmd(0),
+  fThreadsCmd(0)
+{
+  fThermalDirectory = new G4UIdirectory("/dms/thermal/");
+  fThermalDirectory->SetGuidance("Heat conduction solved on the energy mesh after the run");
+
+  fActiveCmd = new G4UIcmdWithABool("/dms/thermal/active", this);
+  fActiveCmd->SetGuidance("Solve the temperatures at the end of the run (default false).");
+  fActiveCmd->SetGuidance("Needs the cartesian energy mesh (/dms/mesh/active).");
+  fActiveCmd->SetParameterName("active", true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fActiveCmd->SetToBeBroadcasted(false);
+
+  fConductivityCmd = new G4UIcommand("/dms/thermal/conductivity", this);
+  fConductivityCmd->SetGuidance("Thermal conductivity of a material in W/(m K).");
+  fConductivityCmd->SetGuidance("Defaults: G4_GRAPHITE 120, G4_Cu 390, G4_Fe 80, G4_CONCRETE 1.4,");
+  fConductivityCmd->SetGuidance("G4_Al 237, BoratedConcrete 1.4.");
+  fConductivityCmd->SetParameter(new G4UIparameter("material", 's', false));
+  auto conductivity = new G4UIparameter("value", 'd', false);
+  conductivity->SetParameterRange("value>0.");
+  fConductivityCmd->SetParameter(conductivity);
+  fConductivityCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fConductivityCmd->SetToBeBroadcasted(false);
+
+  fHeatCapacityCmd = new G4UIcommand("/dms/thermal/heatCapacity", this);
+  fHeatCapacityCmd->SetGuidance("Specific heat capacity of a material in J/(kg K).");
+  fHeatCapacityCmd->SetGuidance("Defaults: G4_GRAPHITE 710, G4_Cu 385, G4_Fe 449, G4_CONCRETE 880,");
+  fHeatCapacityCmd->SetGuidance("G4_Al 897, BoratedConcrete 880.");
+  fHeatCapacityCmd->SetParameter(new G4UIparameter("material", 's', false));
+  auto heatCapacity = new G4UIparameter("value", 'd', false);
+  heatCapacity->SetParameterRange("value>0.");
+  fHeatCapacityCmd->SetParameter(heatCapacity);
+  fHeatCapacityCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fHeatCapacityCmd->SetToBeBroadcasted(false);
+
+  fCooledFacesCmd = new G4UIcmdWithAString("/dms/thermal/cooledFaces", this);
+  fCooledFacesCmd->SetGuidance("Faces of the mesh held at the coolant temperature,");
+  fCooledFacesCmd->SetGuidance("any of xmin xmax ymin ymax zmin zmax, or none.");
+  fCooledFacesCmd->SetGuidance("The other faces are adiabatic. Default: all but zmin.");
+  fCooledFacesCmd->SetParameterName("faces", false);
+  fCooledFacesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fCooledFacesCmd->SetToBeBroadcasted(false);
+
+  fCoolantTemperatureCmd = new G4UIcmdWithADouble("/dms/thermal/coolantTemperature", this);
+  fCoolantTemperatureCmd->SetGuidance("Coolant (and initial) temperature in K (default 300).");
+  fCoolantTemperatureCmd->SetParameterName("kelvin", false);
+  fCoolantTemperatureCmd->SetRange("kelvin>0.");
+  fCoolantTemperatureCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fCoolantTemperatureCmd->SetToBeBroadcasted(false);
+
+  fHeatTransferCmd = new G4UIcmdWithADouble("/dms/thermal/heatTransfer", this);
+  fHeatTransferCmd->SetGuidance("Heat transfer coefficient of the cooled faces in W/(m2 K).");
+  fHeatTransferCmd->SetGuidance("0 (default) holds the faces at the coolant temperature.");
+  fHeatTransferCmd->SetParameterName("value", false);
+  fHeatTransferCmd->SetRange("value>=0.");
+  fHeatTransferCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fHeatTransferCmd->SetToBeBroadcasted(false);
+
+  fDurationCmd = new G4UIcmdWithADoubleAndUnit("/dms/thermal/duration", this);
+  fDurationCmd->SetGuidance("Beam-on time of the transient; 0 (default) solves only");
+  fDurationCmd->SetGuidance("the steady state.");
+  fDurationCmd->SetParameterName("duration", false);
+  fDurationCmd->SetRange("duration>=0.");
+  fDurationCmd->SetUnitCategory("Time");
+  fDurationCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fDurationCmd->SetToBeBroadcasted(false);
+
+  fTimeStepsCmd = new G4UIcmdWithAnInteger("/dms/thermal/timeSteps", this);
+  fTimeStepsCmd->SetGuidance("Number of implicit time steps of the transient (default 100).");
+  fTimeStepsCmd->SetParameterName("steps", false);
+  fTimeStepsCmd->SetRange("steps>0");
+  fTimeStepsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fTimeStepsCmd->SetToBeBroadcasted(false);
+
+  fToleranceCmd = new G4UIcmdWithADouble("/dms/thermal/tolerance", this);
+  fToleranceCmd->SetGuidance("Stop the relaxation when no temperature changes by more");
+  fToleranceCmd->SetGuidance("than this in one iteration, in K (default 1e-4).");
+  fToleranceCmd->SetParameterName("kelvin", false);
+  fToleranceCmd->SetRange("kelvin>0.");
+  fToleranceCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fToleranceCmd->SetToBeBroadcasted(false);
+
+  fMaxIterationsCmd = new G4UIcmdWithAnInteger("/dms/thermal/maxIterations", this);
+  fMaxIterationsCmd->SetGuidance("Maximum number of iterations per solve (default 100000).");
+  fMaxIterationsCmd->SetParameterName("iterations", false);
+  fMaxIterationsCmd->SetRange("iterations>0");
+  fMaxIterationsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fMaxIterationsCmd->SetToBeBroadcasted(false);
+
+  fThreadsCmd = new G4UIcmdWithAnInteger("/dms/thermal/threads", this);
+  fThreadsCmd->SetGuidance("Number of solver threads, 0 (default) uses all cores.");
+  fThreadsCmd->SetParameterName("threads", false);
+  fThreadsCmd->SetRange("threads>=0");
+  fThreadsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fThreadsCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DMSThermalSolverMessenger::~DMSThermalSolverMessenger()
+{
+  delete fActiveCmd;
+  delete fConductivityCmd;
+  delete fHeatCapacityCmd;
+  delete fCooledFacesCmd;
+  delete fCoolantTemperatureCmd;
+  delete fHeatTransferCmd;
+  delete fDurationCmd;
+  delete fTimeStepsCmd;
+  delete fToleranceCmd;
+  delete fMaxIterationsCmd;
+  delete fThreadsCmd;
+  delete fThermalDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DMSThermalSolverMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fActiveCmd ) {
+    fSolver->SetActive(fActiveCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fConductivityCmd || command == fHeatCapacityCmd ) {
+    G4String material;
+    G4double value;
+    std::istringstream is(newValue);
+    is >> material >> value;
+    if ( command == fConductivityCmd ) fSolver->SetConductivity(material, value);
+    else fSolver->SetHeatCapacity(material, value);
+  }
+  else if ( command == fCooledFacesCmd ) {
+    fSolver->SetCooledFaces(newValue);
+  }
+  else if ( command == fCoolantTemperatureCmd ) {
+    fSolver->SetCoolantTemperature(fCoolantTemperatureCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fHeatTransferCmd ) {
+    fSolver->SetHeatTransfer(fHeatTransferCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fDurationCmd ) {
+    fSolver->SetDuration(fDurationCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fTimeStepsCmd ) {
+    fSolver->SetTimeSteps(fTimeStepsCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fToleranceCmd ) {
+    fSolver->SetTolerance(fToleranceCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fMaxIterationsCmd ) {
+    fSolver->SetMaxIterations(fMaxIterationsCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fThreadsCmd ) {
+    fSolver->SetThreads(fThreadsCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......